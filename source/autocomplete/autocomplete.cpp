@@ -33,10 +33,11 @@ www.navitia.io
 namespace navitia { namespace autocomplete {
 
 static void compute_score_poi(type::PT_Data&, georef::GeoRef& georef) {
-    for (auto it = georef.fl_poi.word_quality_list.begin(); it != georef.fl_poi.word_quality_list.end(); ++it){
+    auto& fl_poi = georef::mutable_part(georef.fl_poi);
+    for (auto it = fl_poi.word_quality_list.begin(); it != fl_poi.word_quality_list.end(); ++it){
         for (navitia::georef::Admin* admin : georef.pois[it->first]->admin_list){
             if(admin->level == 8){
-                it->second.score = georef.fl_admin.word_quality_list.at(admin->idx).score;
+                it->second.score = georef.fl_admin->word_quality_list.at(admin->idx).score;
             }
         }
     }
@@ -45,10 +46,11 @@ static void compute_score_poi(type::PT_Data&, georef::GeoRef& georef) {
 
 static void compute_score_way(type::PT_Data&, georef::GeoRef& georef) {
     //The scocre of each admin(level 8) is attributed to all its ways
-    for (auto it = georef.fl_way.word_quality_list.begin(); it != georef.fl_way.word_quality_list.end(); ++it){
+    auto& fl_way = georef::mutable_part(georef.fl_way);
+    for (auto it = fl_way.word_quality_list.begin(); it != fl_way.word_quality_list.end(); ++it){
         for (navitia::georef::Admin* admin : georef.ways[it->first]->admin_list){
             if (admin->level == 8){
-                it->second.score = georef.fl_admin.word_quality_list.at(admin->idx).score;
+                it->second.score = georef.fl_admin->word_quality_list.at(admin->idx).score;
             }
         }
     }
@@ -60,7 +62,7 @@ static void compute_score_stop_point(type::PT_Data& pt_data, georef::GeoRef& geo
     for (auto it = pt_data.stop_point_autocomplete.word_quality_list.begin(); it != pt_data.stop_point_autocomplete.word_quality_list.end(); ++it){
         for(navitia::georef::Admin* admin : pt_data.stop_points[it->first]->admin_list){
             if (admin->level == 8){
-                it->second.score = georef.fl_admin.word_quality_list.at(admin->idx).score;
+                it->second.score = georef.fl_admin->word_quality_list.at(admin->idx).score;
             }
         }
     }
@@ -68,7 +70,7 @@ static void compute_score_stop_point(type::PT_Data& pt_data, georef::GeoRef& geo
 
 static size_t admin_score(const std::vector<navitia::georef::Admin*>& admins, const georef::GeoRef &georef) {
     for (const auto* admin: admins) {
-        if (admin->level == 8) return georef.fl_admin.word_quality_list.at(admin->idx).score;
+        if (admin->level == 8) return georef.fl_admin->word_quality_list.at(admin->idx).score;
     }
     return 0;
 }
@@ -103,30 +105,31 @@ static void compute_score_stop_area(type::PT_Data& pt_data, const georef::GeoRef
  Pampa      0                   7
 */
 static void compute_score_admin(type::PT_Data& pt_data, georef::GeoRef& georef) {
+    auto& fl_admin = georef::mutable_part(georef.fl_admin);
     //For each stop_point increase the score of it's admin(level 8) by 1.
     for (navitia::georef::Way* way: georef.ways) {
         for (navitia::georef::Admin * admin : way->admin_list){
             if (admin->level == 8){
-                georef.fl_admin.word_quality_list.at(admin->idx).score++;
+                fl_admin.word_quality_list.at(admin->idx).score++;
             }
         }
     }
     std::set<navitia::georef::Admin*> without_way_admins;
     for(auto admin : georef.admins) {
-        if (admin->level == 8 && georef.fl_admin.word_quality_list.at(admin->idx).score == 0) {
+        if (admin->level == 8 && fl_admin.word_quality_list.at(admin->idx).score == 0) {
             without_way_admins.insert(admin);
         }
     }
     for (navitia::type::StopPoint* sp : pt_data.stop_points){
         for (navitia::georef::Admin * admin : sp->admin_list){
             if (admin->level == 8 && without_way_admins.count(admin) > 0){
-                georef.fl_admin.word_quality_list.at(admin->idx).score++;
+                fl_admin.word_quality_list.at(admin->idx).score++;
             }
         }
     }
 
     //Ajust the score of each admin using natural logarithm as : log(n+2)*10
-    for (auto it = georef.fl_admin.word_quality_list.begin(); it != georef.fl_admin.word_quality_list.end(); ++it){
+    for (auto it = fl_admin.word_quality_list.begin(); it != fl_admin.word_quality_list.end(); ++it){
         it->second.score = log(it->second.score + 2) * 10;
     }
 }
@@ -153,6 +156,7 @@ void Autocomplete<T>::compute_score(type::PT_Data &pt_data, georef::GeoRef &geor
         default:
             break;
     }
+    compute_max_scores();
 }
 
 template<class T>
@@ -208,8 +212,13 @@ Autocomplete<T>::find_complete_way(const std::string& str,
                                    const std::set<std::string>& ghostwords,
                                    const navitia::georef::GeoRef& geo_ref) const{
     auto vec = tokenize(str, ghostwords);
-    //Vector des ObjetTC index trouvés
-    auto index_result = find(vec);
+    // compute_vec_quality adds at most one to the score by word of str
+    const int score_margin = std::count(str.begin(), str.end(), ' ') + 1;
+    //Vector des ObjetTC index trouvés, seulement les meilleurs quand il y en a trop
+    std::vector<T> index_result;
+    if (! find_best(vec, nbmax, keep_element, score_margin, index_result)) {
+        index_result = find(vec);
+    }
     // Créer un vector de réponse:
     auto vec_quality = compute_vec_quality(str, index_result, geo_ref, keep_element, words_length(vec));
     sort_and_truncate_by_score(vec_quality, nbmax);
@@ -36,12 +36,19 @@ www.navitia.io
 #include <boost/serialization/utility.hpp>
 #include <boost/serialization/map.hpp>
 #include <algorithm>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <thread>
 #include <boost/regex.hpp>
 #include <map>
 #include <unordered_map>
 #include <set>
 #include "type/type.h"
 #include "utils/functions.h"
+#include "posting_list.h"
+#include "word_trie.h"
+#include "ngram_index.h"
 
 namespace navitia { namespace autocomplete {
 
@@ -101,71 +108,168 @@ struct Autocomplete
     /// Type of object
     navitia::type::Type_e object_type;
 
-    /// Structure temporaire pour construire l'indexe
-    std::map<std::string, std::set<T> > temp_word_map;
+    /// Couple (mot ou pattern, élément) utilisé pour construire l'indexe
+    typedef std::pair<std::string, T> couple;
 
-    /// À chaque mot (par exemple "rue" ou "jaures") on associe un tableau de T qui contient la liste des éléments contenant ce mot
-    typedef std::pair<std::string, std::vector<T> > vec_elt;
+    /// Structure temporaire pour construire l'indexe, triée par build
+    std::vector<couple> temp_words;
 
-    /// Structure principale de notre indexe
-    std::vector<vec_elt> word_dictionnary;
+    /// À chaque chaîne on associe la liste compressée des éléments la contenant
+    typedef std::pair<std::string, PostingList<T> > vec_elt;
+
+    /// Structure principale de notre indexe : à chaque mot (par exemple "rue" ou "jaures")
+    /// la liste des éléments contenant ce mot, et le meilleur score sous chaque préfixe
+    WordTrie<T> word_dictionnary;
+
+    /// the prefixes of at most this length have their union precomputed
+    static constexpr size_t short_prefix_length = 2;
+
+    /// union of the lists of the words starting with each short prefix,
+    /// only for the prefixes of several words
+    std::vector<vec_elt> short_prefix_dictionnary;
 
     /// Structure temporaire pour garder les patterns et leurs indexs
-    std::map<std::string, std::set<T> > temp_pattern_map;
-    std::vector<vec_elt> pattern_dictionnary;
+    std::vector<couple> temp_patterns;
+    NGramIndex<T> pattern_dictionnary;
 
     /// Structure pour garder les informations comme nombre des mots, la distance des mots...dans chaque Autocomplete (Position)
     std::map<T, word_quality> word_quality_list;
 
     template<class Archive> void serialize(Archive & ar, const unsigned int) {
-        ar & word_dictionnary & word_quality_list &pattern_dictionnary &object_type;
+        ar & word_dictionnary & word_quality_list &pattern_dictionnary &object_type & short_prefix_dictionnary;
     }
 
     /// Efface les structures de données sérialisées
     void clear() {
-        temp_word_map.clear();
-        word_dictionnary.clear();
-        temp_pattern_map.clear();
-        pattern_dictionnary.clear();
+        temp_words.clear();
+        word_dictionnary = WordTrie<T>();
+        short_prefix_dictionnary.clear();
+        temp_patterns.clear();
+        pattern_dictionnary = NGramIndex<T>();
         word_quality_list.clear();
     }
 
     // Méthodes permettant de construire l'indexe
 
+    /// mots, patterns et qualités des chaînes découpées par un thread
+    struct tokenized_strings {
+        std::vector<couple> words;
+        std::vector<couple> patterns;
+        std::vector<std::pair<T, word_quality>> qualities;
+    };
+
     /** Étant donné une chaîne de caractères et la position de l'élément qui nous intéresse :
       * – on découpe en mots la chaîne (tokens)
       * — on rajoute la position à la liste de chaque mot
       */
     void add_string(std::string str, T position, const std::set<std::string>& ghostwords,
                     const autocomplete_map& synonyms){
+        tokenized_strings tokenized;
+        tokenize_string(str, position, ghostwords, synonyms, tokenized);
+        temp_words.insert(temp_words.end(), tokenized.words.begin(), tokenized.words.end());
+        temp_patterns.insert(temp_patterns.end(), tokenized.patterns.begin(), tokenized.patterns.end());
+        word_quality_list[position] = tokenized.qualities.front().second;
+    }
+
+    void tokenize_string(const std::string& str, T position, const std::set<std::string>& ghostwords,
+                         const autocomplete_map& synonyms, tokenized_strings& tokenized) const {
         word_quality wc;
         int distance = 0;
 
         //Appeler la méthode pour traiter les synonymes avant de les ajouter dans le dictionaire:
         auto vec_word = tokenize(str, ghostwords, synonyms);
-        //créer des patterns pour chaque mot et les ajouter dans temp_pattern_map:
-        add_vec_pattern(vec_word, position);
+        //créer des patterns pour chaque mot:
+        for (auto& pattern: make_vec_pattern(vec_word, 2)) {
+            tokenized.patterns.push_back(couple(std::move(pattern), position));
+        }
 
         int count = vec_word.size();
-        auto vec = vec_word.begin();
-        while(vec != vec_word.end()){
-            temp_word_map[*vec].insert(position);
-            distance += (*vec).size();
-            ++vec;
+        for (const auto& word: vec_word) {
+            tokenized.words.push_back(couple(word, position));
+            distance += word.size();
         }
         wc.word_count = count;
         wc.word_distance = distance;
         wc.score = 0;
-        word_quality_list[position] = wc;
+        tokenized.qualities.push_back({position, wc});
+    }
+
+    /** Ajoute les chaînes des éléments [0, nb_elements) en les découpant sur nb_threads threads
+      *
+      * get_string(i) donne la chaîne et la position de l'élément i, une chaîne vide n'est pas ajoutée.
+      * Each thread sorts the couples of its strings, the sorted runs are then merged.
+      */
+    template<class GetString>
+    void add_strings(size_t nb_elements, GetString get_string, const std::set<std::string>& ghostwords,
+                     const autocomplete_map& synonyms, size_t nb_threads) {
+        nb_threads = std::max<size_t>(std::min(nb_threads, nb_elements), 1);
+        std::vector<tokenized_strings> runs(nb_threads);
+        std::vector<std::exception_ptr> errors(nb_threads);
+        auto tokenize_part = [&](size_t part) {
+            try {
+                auto& run = runs[part];
+                for (size_t i = nb_elements * part / nb_threads; i < nb_elements * (part + 1) / nb_threads; ++i) {
+                    const std::pair<std::string, T> str_position = get_string(i);
+                    if (str_position.first.empty()) { continue; }
+                    tokenize_string(str_position.first, str_position.second, ghostwords, synonyms, run);
+                }
+                std::sort(run.words.begin(), run.words.end());
+                std::sort(run.patterns.begin(), run.patterns.end());
+            } catch (...) {
+                errors[part] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t part = 1; part < nb_threads; ++part) {
+            threads.emplace_back(tokenize_part, part);
+        }
+        tokenize_part(0);
+        for (auto& thread: threads) { thread.join(); }
+        for (const auto& error: errors) {
+            if (error) { std::rethrow_exception(error); }
+        }
+
+        std::vector<std::vector<couple>> word_runs, pattern_runs;
+        for (auto& run: runs) {
+            word_runs.push_back(std::move(run.words));
+            pattern_runs.push_back(std::move(run.patterns));
+            // the runs are in the order of the elements, the last string of an element wins as in add_string
+            for (const auto& quality: run.qualities) {
+                word_quality_list[quality.first] = quality.second;
+            }
+        }
+        append_sorted(temp_words, merge_runs(word_runs));
+        append_sorted(temp_patterns, merge_runs(pattern_runs));
+    }
+
+    /// merges the sorted runs two by two
+    static std::vector<couple> merge_runs(std::vector<std::vector<couple>>& runs) {
+        while (runs.size() > 1) {
+            std::vector<std::vector<couple>> merged;
+            for (size_t i = 0; i + 1 < runs.size(); i += 2) {
+                merged.emplace_back();
+                merged.back().reserve(runs[i].size() + runs[i + 1].size());
+                std::merge(std::make_move_iterator(runs[i].begin()), std::make_move_iterator(runs[i].end()),
+                           std::make_move_iterator(runs[i + 1].begin()), std::make_move_iterator(runs[i + 1].end()),
+                           std::back_inserter(merged.back()));
+                std::vector<couple>().swap(runs[i]);
+                std::vector<couple>().swap(runs[i + 1]);
+            }
+            if (runs.size() % 2 == 1) { merged.push_back(std::move(runs.back())); }
+            runs = std::move(merged);
+        }
+        return runs.empty() ? std::vector<couple>() : std::move(runs.front());
     }
 
-    void add_vec_pattern(const std::set<std::string> &vec_words, T position){
-        //Créer les patterns:
-        std::vector<std::string> vec_patt = make_vec_pattern(vec_words, 2);
-        auto v_patt = vec_patt.begin();
-        while(v_patt != vec_patt.end()){
-            temp_pattern_map[*v_patt].insert(position);
-            ++v_patt;
+    static void append_sorted(std::vector<couple>& couples, std::vector<couple>&& sorted) {
+        if (couples.empty()) {
+            couples = std::move(sorted);
+            return;
+        }
+        const auto middle = couples.size();
+        couples.insert(couples.end(), std::make_move_iterator(sorted.begin()), std::make_move_iterator(sorted.end()));
+        if (std::is_sorted(couples.begin(), couples.begin() + middle)) {
+            std::inplace_merge(couples.begin(), couples.begin() + middle, couples.end());
         }
     }
 
@@ -193,92 +297,133 @@ struct Autocomplete
 
     /** Construit la structure finale
       *
-      * Les map et les set sont bien pratiques, mais leurs performances sont mauvaises avec des petites données (comme des ints)
+      * Les couples sont triés s'ils ont été ajoutés un par un, puis libérés
       */
     void build(){
-        word_dictionnary.reserve(temp_word_map.size());
-        for(auto key_val: temp_word_map){
-            word_dictionnary.push_back(std::make_pair(key_val.first, std::vector<T>(key_val.second.begin(), key_val.second.end())));
+        if (! std::is_sorted(temp_words.begin(), temp_words.end())) {
+            std::sort(temp_words.begin(), temp_words.end());
         }
+        word_dictionnary = WordTrie<T>(temp_words);
+        std::vector<couple>().swap(temp_words);
+        build_short_prefixes();
+        compute_max_scores();
 
         //Dictionnaire des patterns:
-        pattern_dictionnary.reserve((temp_pattern_map.size()));
-        for(auto key_val:temp_pattern_map){
-            pattern_dictionnary.push_back(std::make_pair(key_val.first, std::vector<T>(key_val.second.begin(), key_val.second.end())));
+        if (! std::is_sorted(temp_patterns.begin(), temp_patterns.end())) {
+            std::sort(temp_patterns.begin(), temp_patterns.end());
         }
+        pattern_dictionnary = NGramIndex<T>(temp_patterns);
+        std::vector<couple>().swap(temp_patterns);
+    }
+
+    /// the words starting with a prefix are contiguous in word_dictionnary
+    void build_short_prefixes() {
+        short_prefix_dictionnary.clear();
+        for (size_t length = 1; length <= short_prefix_length; ++length) {
+            word_dictionnary.visit_prefixes(length, [&](const std::string& prefix, size_t first_word, size_t end_word) {
+                if (end_word - first_word <= 1) { return; }
+                std::vector<T> elements;
+                for (size_t word = first_word; word < end_word; ++word) {
+                    const auto list = word_dictionnary.list(word);
+                    elements.insert(elements.end(), list.begin(), list.end());
+                }
+                std::sort(elements.begin(), elements.end());
+                short_prefix_dictionnary.push_back(std::make_pair(prefix,
+                                                                  PostingList<T>(elements.begin(), elements.end())));
+            });
+        }
+        std::sort(short_prefix_dictionnary.begin(), short_prefix_dictionnary.end(),
+                  [](const vec_elt& a, const vec_elt& b) { return a.first < b.first; });
     }
 
     //Méthode pour calculer le score de chaque élément par son admin.
     void compute_score(type::PT_Data &pt_data, georef::GeoRef &georef,
                        const type::Type_e type);
-    // Méthodes premettant de retrouver nos éléments
-    /** Définit un fonctor permettant de parcourir notre structure un peu particulière */
-    struct comp{
-        /** Utilisé pour trouver la borne inf. Quand on cherche av, on veux que avenue soit également trouvé
-          * Il faut donc que "av" < "avenue" soit false
-          */
-        bool operator()(const std::string & a, const std::pair<std::string, std::vector<T> > & b){
-            if(b.first.find(a) == 0) return false;
-            return (a < b.first);
-        }
 
-        /** Utilisé pour la borne sup. Ici rien d'extraordinaire */
-        bool operator()(const std::pair<std::string, std::vector<T> > & b, const std::string & a){
-            return (b.first < a);
-        }
-    };
-
-    /** Retrouve toutes les positions des élements contenant le mot des mots qui commencent par token */
-    std::vector<T> match(const std::string &token, const std::vector<vec_elt> &vec_source) const {
-        // Les éléments dans vec_map sont triés par ordre alphabétiques, il suffit donc de trouver la borne inf et sup
-        auto lower = std::lower_bound(vec_source.begin(), vec_source.end(), token, comp());
-        auto upper = std::upper_bound(vec_source.begin(), vec_source.end(), token, comp());
+    /// to call when the scores of word_quality_list have changed, find_best relies on them
+    void compute_max_scores() {
+        word_dictionnary.compute_max_scores([&](T i) { return word_quality_list.at(i).score; });
+    }
 
-        std::vector<T> result;
+    // Méthodes premettant de retrouver nos éléments
 
-        // On concatène tous les indexes
-        // Pour les raisons de perfs mesurées expérimentalement, on accepte des doublons
-        for(; lower != upper; ++lower){
-            std::vector<T> other = lower->second;
-            result.insert(result.end(), other.begin(), other.end());
+    /** Retrouve les listes des élements contenant des mots qui commencent par token
+      *
+      * Rien n'est copié, un même élément peut être dans plusieurs listes. L'union des listes
+      * est précalculée pour les tokens courts qui correspondent à beaucoup de mots
+      */
+    std::vector<PostingListView<T>> match_word(const std::string &token) const {
+        if (token.size() <= short_prefix_length) {
+            const auto it = std::lower_bound(short_prefix_dictionnary.begin(), short_prefix_dictionnary.end(), token,
+                                             [](const vec_elt& a, const std::string& b) { return a.first < b; });
+            if (it != short_prefix_dictionnary.end() && it->first == token) {
+                return {it->second.view()};
+            }
         }
-        return result;
+        return word_dictionnary.match(token);
     }
 
-    /** On passe une chaîne de charactère contenant des mots et on trouve toutes les positions contenant tous ces mots*/
+    /** On passe une chaîne de charactère contenant des mots et on trouve toutes les positions contenant tous ces mots
+      *
+      * Les listes des mots sont fusionnées et intersectées pendant leur lecture, le résultat est trié et sans doublons
+      */
     std::vector<T> find(const std::set<std::string>& vecStr) const {
-        std::vector<T> result;
-        auto vec = vecStr.begin();
-        if(vec != vecStr.end()){
-            // Premier résultat. Il y aura au plus ces indexes
-            result = match(*vec, word_dictionnary);
-
-            //If there is only one word to search we have to sort and delete duplicate results
-            if (vecStr.size() == 1) {
-                std::sort(result.begin(), result.end());
-                result.erase(unique(result.begin(), result.end()), result.end());
-            }
-
-            for(++vec; vec != vecStr.end(); ++vec){
-                std::vector<T> new_result;
-                std::sort(result.begin(), result.end());
-                for(auto i : match(*vec, word_dictionnary)){
-                    // Binary search fait une recherche dichotomique pour savoir si l'élément i existe
-                    // S'il existe dans les deux cas, on le garde
-                    if(binary_search(result.begin(), result.end(), i)){
-                        new_result.push_back(i);
-                    }
-                }
-                //The function "unique" works only if the vector new_result is sorted.
-                std::sort(new_result.begin(), new_result.end());
+        std::vector<PostingListUnion<T>> unions;
+        for (const auto& str: vecStr) {
+            unions.emplace_back(match_word(str));
+        }
+        return intersect(unions);
+    }
 
-                // std::unique retrie les donnée et fout les doublons à la fin
-                // La fonction retourne un itérateur vers le premier doublon
-                // Expérimentalement le gain est très faible
-                result.assign(new_result.begin(), std::unique(new_result.begin(), new_result.end()));
+    /** Same as find, but only the best elements by score (and kept by keep_element) are searched
+      *
+      * The dictionary is walked by decreasing score for the broadest word, until nbmax elements
+      * are found and the next ones can't beat them by more than score_margin.
+      * Returns false, without searching, when all the elements fit in nbmax: find is then as cheap.
+      */
+    bool find_best(const std::set<std::string>& vecStr,
+                   size_t nbmax,
+                   const std::function<bool(T)>& keep_element,
+                   int score_margin,
+                   std::vector<T>& result) const {
+        if (vecStr.empty() || nbmax == 0) { return false; }
+        std::string broadest;
+        size_t broadest_size = 0;
+        size_t smallest_size = std::numeric_limits<size_t>::max();
+        for (const auto& str: vecStr) {
+            size_t size = 0;
+            for (const auto& list: match_word(str)) { size += list.size(); }
+            if (size >= broadest_size) {
+                broadest = str;
+                broadest_size = size;
             }
+            smallest_size = std::min(smallest_size, size);
         }
-        return result;
+        if (smallest_size <= nbmax) { return false; }
+
+        // the elements must also contain the other words
+        std::vector<PostingListUnion<T>> unions;
+        for (const auto& str: vecStr) {
+            if (str != broadest) { unions.emplace_back(match_word(str)); }
+        }
+        const bool filtered = ! unions.empty();
+        const auto others = intersect(unions);
+        if (filtered && others.size() <= nbmax) { return false; }
+
+        int last_score = 0;
+        word_dictionnary.visit_by_score(broadest, [&](T i) { return word_quality_list.at(i).score; },
+                                        [&](T i, int score) {
+            if (result.size() >= nbmax && (score_margin == 0 || score + score_margin < last_score)) {
+                return false;
+            }
+            if ((filtered && ! std::binary_search(others.begin(), others.end(), i)) || ! keep_element(i)) {
+                return true;
+            }
+            result.push_back(i);
+            if (result.size() == nbmax) { last_score = score; }
+            return true;
+        });
+        return true;
     }
 
     /** Définit un fonctor permettant de parcourir notqualityre structure un peu particulière : trier par la valeur "nb_found"*/
@@ -322,8 +467,10 @@ struct Autocomplete
         int wordLength = 0;
         fl_quality quality;
         std::vector<T> index_result;
-        //Vector des ObjetTC index trouvés
-        index_result = find(vec);
+        //Vector des ObjetTC index trouvés, seulement les meilleurs quand il y en a trop
+        if (! find_best(vec, nbmax, keep_element, 0, index_result)) {
+            index_result = find(vec);
+        }
         wordLength = words_length(vec);
 
         // Créer un vector de réponse:
@@ -363,12 +510,6 @@ struct Autocomplete
                                                       std::function<bool(T)> keep_element,
                                                       const std::set<std::string>& ghostwords)
                                                       const{
-        //Map temporaire pour garder les patterns trouvé:
-        std::unordered_map<T, fl_quality> fl_result;
-
-        //Vector temporaire des indexs
-        std::vector<T> index_result;
-
         //Créer un vector de réponse
         std::vector<fl_quality> vec_quality;
         fl_quality quality;
@@ -377,56 +518,38 @@ struct Autocomplete
         std::vector<std::string> vec_pattern = make_vec_pattern(vec_word, 2); //2-grams
         int wordLength = words_length(vec_word);
         int pattern_count = vec_pattern.size();
+        if (vec_pattern.empty()) {
+            return vec_quality;
+        }
 
-        //recherche pour le premier pattern:
-        auto vec = vec_pattern.begin();
-        if (vec != vec_pattern.end()){
-            //Premier résultat:
-            index_result = match(*vec, pattern_dictionnary);
-
-            //Incrémenter la propriété "nb_found" pour chaque index des mots autocomplete dans vec_map
-            add_word_quality(fl_result,index_result);
-
-            //Recherche des mots qui restent
-            for (++vec; vec != vec_pattern.end(); ++vec){
-                index_result = match(*vec, pattern_dictionnary);
-
-                //For each match of n-gram pattern word 1 is added to "nb_found"
-                add_word_quality(fl_result,index_result);
-            }
-
-            //Compute de highest score of objects found
-            int max_score = 0;
-            for (auto ir : index_result){
+        //Compute de highest score of objects found by the last pattern
+        int max_score = 0;
+        for (const auto& list : pattern_dictionnary.match(vec_pattern.back())){
+            for (auto ir : list){
                 if (keep_element(ir)){
                     max_score = word_quality_list.at(ir).score > max_score ? word_quality_list.at(ir).score : max_score;
                 }
             }
+        }
 
-            //Here we keep object with match of patternized words >= 75%
-            for(auto pair : fl_result){
-                if (keep_element(pair.first) && (((pattern_count - pair.second.nb_found) * 100) / pattern_count <= 25)){
-                    quality.idx = pair.first;
-                    quality.nb_found = pair.second.nb_found;
-                    quality.word_len = wordLength;
-                    quality.score = word_quality_list.at(quality.idx).score;
-                    quality.quality = calc_quality_pattern(quality, word_weight, max_score, pattern_count);
-                    vec_quality.push_back(quality);
-                }
+        //Here we keep object with match of patternized words >= 75%
+        int min_found = 0;
+        while (((pattern_count - min_found) * 100) / pattern_count > 25) {
+            ++min_found;
+        }
+        for (const auto& found : pattern_dictionnary.find(vec_pattern, min_found)){
+            if (keep_element(found.first)){
+                quality.idx = found.first;
+                quality.nb_found = found.second;
+                quality.word_len = wordLength;
+                quality.score = word_quality_list.at(quality.idx).score;
+                quality.quality = calc_quality_pattern(quality, word_weight, max_score, pattern_count);
+                vec_quality.push_back(quality);
             }
         }
         return sort_and_truncate_by_quality(vec_quality, nbmax);
     }
 
-
-    /** pour chaque mot trouvé dans la liste des mots il faut incrémenter la propriété : nb_found*/
-    /** Utilisé que pour une recherche partielle */
-    void add_word_quality(std::unordered_map<T, fl_quality> & fl_result, const std::vector<T> &found) const{
-        for(auto i : found){
-            fl_result[i].nb_found++;
-        }
-    }
-
     int calc_quality_pattern(const fl_quality & ql,  int wordweight, int max_score, int patt_count) const {
         int result = 100;
 
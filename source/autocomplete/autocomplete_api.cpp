@@ -204,7 +204,7 @@ void autocomplete(navitia::PbCreator& pb_creator, const std::string &q,
     std::vector<const georef::Admin*> admin_ptr = admin_uris_to_admin_ptr(admins, d);
 
     //Compute number of words in the query:
-    std::set<std::string> query_word_vec = d.geo_ref->fl_admin.tokenize(q, d.geo_ref->ghostwords);
+    std::set<std::string> query_word_vec = d.geo_ref->fl_admin->tokenize(q, d.geo_ref->ghostwords);
 
     ///Find max(100, count) éléments for each pt_object
     for(nt::Type_e type : filter) {
@@ -232,10 +232,10 @@ void autocomplete(navitia::PbCreator& pb_creator, const std::string &q,
             break;
         case nt::Type_e::Admin:
             if (search_type==0) {
-                result = d.geo_ref->fl_admin.find_complete(q,
+                result = d.geo_ref->fl_admin->find_complete(q,
                         nbmax, valid_admin_ptr(d.geo_ref->admins, admin_ptr), d.geo_ref->ghostwords);
             } else {
-                result = d.geo_ref->fl_admin.find_partial_with_pattern(q,
+                result = d.geo_ref->fl_admin->find_partial_with_pattern(q,
                         d.geo_ref->word_weight,
                         nbmax, valid_admin_ptr(d.geo_ref->admins, admin_ptr), d.geo_ref->ghostwords);
             }
@@ -246,10 +246,10 @@ void autocomplete(navitia::PbCreator& pb_creator, const std::string &q,
             break;
         case nt::Type_e::POI:
             if (search_type==0) {
-                result = d.geo_ref->fl_poi.find_complete(q,
+                result = d.geo_ref->fl_poi->find_complete(q,
                         nbmax, valid_admin_ptr(d.geo_ref->pois, admin_ptr), d.geo_ref->ghostwords);
             } else {
-                result = d.geo_ref->fl_poi.find_partial_with_pattern(q,
+                result = d.geo_ref->fl_poi->find_partial_with_pattern(q,
                         d.geo_ref->word_weight, nbmax,
                         valid_admin_ptr(d.geo_ref->pois, admin_ptr), d.geo_ref->ghostwords);
             }
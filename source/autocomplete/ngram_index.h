@@ -0,0 +1,166 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+#include "word_trie.h"
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace navitia { namespace autocomplete {
+
+/** Inverted index of the n-grams of the names, for the searches with typos
+ *
+ * An element is found when it has enough of the n-grams of the query. The
+ * lists are read from the smallest one and only the first ones can make new
+ * candidates: an element absent from them can't have enough n-grams in the
+ * remaining lists. The elements having too few distinct n-grams (too short
+ * names) are skipped too. The counts are kept in an array by element, reused
+ * by the queries of a thread.
+ */
+template<class T>
+class NGramIndex {
+    /// lists of the elements of each n-gram
+    WordTrie<T> ngrams;
+    /// number of distinct n-grams of each element
+    std::vector<uint16_t> nb_ngrams;
+
+    /// counts of the current query of the thread, all zero between the queries
+    struct Counters {
+        std::vector<uint32_t> counts;
+        std::vector<T> candidates;
+    };
+
+public:
+    NGramIndex() {}
+
+    /// the (n-gram, index) couples must be sorted, they can be repeated
+    explicit NGramIndex(const std::vector<std::pair<std::string, T>>& couples): ngrams(couples) {
+        for (size_t word = 0; word < ngrams.nb_words(); ++word) {
+            for (auto idx: ngrams.list(word)) {
+                if (size_t(idx) >= nb_ngrams.size()) { nb_ngrams.resize(size_t(idx) + 1, 0); }
+                if (nb_ngrams[idx] < std::numeric_limits<uint16_t>::max()) { ++nb_ngrams[idx]; }
+            }
+        }
+        nb_ngrams.shrink_to_fit();
+    }
+
+    /// lists of the n-grams starting with ngram
+    std::vector<PostingListView<T>> match(const std::string& ngram) const {
+        return ngrams.match(ngram);
+    }
+
+    /** Elements having at least min_found n-grams of the query, with the number found
+     *
+     * An n-gram repeated in the query is counted as many times, and one
+     * shorter than n once for each n-gram it starts, the same as adding the
+     * matches of the n-grams of the query one by one.
+     */
+    std::vector<std::pair<T, uint32_t>> find(const std::vector<std::string>& query, uint32_t min_found) const {
+        std::vector<std::pair<T, uint32_t>> result;
+        min_found = std::max<uint32_t>(min_found, 1);
+
+        // weight of each n-gram of the index: the number of n-grams of the query it matches
+        std::unordered_map<uint32_t, uint32_t> weights;
+        for (const auto& ngram: query) {
+            const auto range = ngrams.words(ngram);
+            for (uint32_t word = range.first; word < range.second; ++word) {
+                ++weights[word];
+            }
+        }
+        struct WeightedList {
+            PostingListView<T> list;
+            uint32_t weight;
+        };
+        std::vector<WeightedList> lists;
+        std::vector<uint32_t> sorted_weights;
+        for (const auto& word_weight: weights) {
+            lists.push_back({ngrams.list(word_weight.first), word_weight.second});
+            sorted_weights.push_back(word_weight.second);
+        }
+
+        // an element with k distinct n-grams is found at most the k greatest weights times
+        std::sort(sorted_weights.begin(), sorted_weights.end(), std::greater<uint32_t>());
+        size_t min_nb_ngrams = 0;
+        for (uint32_t sum = 0; sum < min_found; ++min_nb_ngrams) {
+            if (min_nb_ngrams == sorted_weights.size()) { return result; }
+            sum += sorted_weights[min_nb_ngrams];
+        }
+
+        // only the smallest lists, until the others weigh less than min_found, make candidates
+        std::sort(lists.begin(), lists.end(), [](const WeightedList& a, const WeightedList& b) {
+            return a.list.size() < b.list.size();
+        });
+        size_t nb_candidate_lists = lists.size();
+        for (uint32_t remaining = 0; nb_candidate_lists > 0; --nb_candidate_lists) {
+            remaining += lists[nb_candidate_lists - 1].weight;
+            if (remaining >= min_found) { break; }
+        }
+
+        static thread_local Counters counters;
+        auto& counts = counters.counts;
+        auto& candidates = counters.candidates;
+        if (counts.size() < nb_ngrams.size()) { counts.resize(nb_ngrams.size(), 0); }
+        for (size_t i = 0; i < nb_candidate_lists; ++i) {
+            for (auto idx: lists[i].list) {
+                if (counts[idx] == 0) {
+                    if (nb_ngrams[idx] < min_nb_ngrams) { continue; }
+                    candidates.push_back(idx);
+                }
+                counts[idx] += lists[i].weight;
+            }
+        }
+        if (! candidates.empty()) {
+            for (size_t i = nb_candidate_lists; i < lists.size(); ++i) {
+                for (auto idx: lists[i].list) {
+                    if (counts[idx] != 0) { counts[idx] += lists[i].weight; }
+                }
+            }
+        }
+        for (auto idx: candidates) {
+            if (counts[idx] >= min_found) { result.push_back({idx, counts[idx]}); }
+            counts[idx] = 0;
+        }
+        candidates.clear();
+        return result;
+    }
+
+    template<class Archive> void serialize(Archive & ar, const unsigned int) {
+        ar & ngrams & nb_ngrams;
+    }
+};
+
+}}
@@ -0,0 +1,271 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <queue>
+#include <vector>
+
+namespace navitia { namespace autocomplete {
+
+/** Forward iterator on the varints of the differences between consecutive indexes */
+template<class T>
+class PostingListIterator: public std::iterator<std::forward_iterator_tag, T, std::ptrdiff_t, const T*, T> {
+    const uint8_t* next = nullptr;
+    const uint8_t* end = nullptr;
+    T value = T();
+    bool at_end = true;
+
+    void decode() {
+        if (next == end) {
+            at_end = true;
+            return;
+        }
+        uint64_t delta = 0;
+        for (int shift = 0; ; shift += 7) {
+            const uint8_t byte = *next++;
+            delta |= uint64_t(byte & 0x7f) << shift;
+            if (! (byte & 0x80)) { break; }
+        }
+        value = T(uint64_t(value) + delta);
+        at_end = false;
+    }
+
+public:
+    PostingListIterator() {}
+    PostingListIterator(const uint8_t* begin, const uint8_t* end): next(begin), end(end) {
+        decode();
+    }
+
+    T operator*() const { return value; }
+    PostingListIterator& operator++() {
+        decode();
+        return *this;
+    }
+    PostingListIterator operator++(int) {
+        auto it = *this;
+        decode();
+        return it;
+    }
+    bool operator==(const PostingListIterator& other) const {
+        return at_end == other.at_end && (at_end || next == other.next);
+    }
+    bool operator!=(const PostingListIterator& other) const { return ! (*this == other); }
+};
+
+/** Appends the sorted indexes to bytes, the duplicates being skipped
+ *
+ * Returns the number of indexes written.
+ */
+template<class InputIterator>
+uint32_t encode_postings(InputIterator begin, InputIterator end, std::vector<uint8_t>& bytes) {
+    uint32_t nb_elements = 0;
+    uint64_t last = 0;
+    for (; begin != end; ++begin) {
+        const uint64_t value = *begin;
+        if (nb_elements > 0 && value == last) { continue; }
+        // the first delta is the index itself
+        uint64_t delta = value - last;
+        while (delta >= 0x80) {
+            bytes.push_back(uint8_t(delta) | 0x80);
+            delta >>= 7;
+        }
+        bytes.push_back(uint8_t(delta));
+        last = value;
+        ++nb_elements;
+    }
+    return nb_elements;
+}
+
+/// Read only list of indexes, the bytes being owned by a PostingList or a shared buffer
+template<class T>
+class PostingListView {
+    const uint8_t* first = nullptr;
+    const uint8_t* last = nullptr;
+    uint32_t nb_elements = 0;
+
+public:
+    typedef PostingListIterator<T> const_iterator;
+
+    PostingListView() {}
+    PostingListView(const uint8_t* first, const uint8_t* last, uint32_t nb_elements):
+        first(first), last(last), nb_elements(nb_elements) {}
+
+    size_t size() const { return nb_elements; }
+    bool empty() const { return nb_elements == 0; }
+
+    const_iterator begin() const { return const_iterator(first, last); }
+    const_iterator end() const { return const_iterator(); }
+};
+
+/** Sorted list of indexes without duplicates
+ *
+ * The indexes are stored as the varints of the differences between
+ * consecutive indexes: a list of close indexes takes about a byte by index.
+ * The list can only be read forward.
+ */
+template<class T>
+class PostingList {
+    std::vector<uint8_t> bytes;
+    uint32_t nb_elements = 0;
+
+public:
+    typedef PostingListIterator<T> const_iterator;
+
+    PostingList() {}
+
+    /// the indexes must be sorted, the duplicates are skipped
+    template<class InputIterator>
+    PostingList(InputIterator begin, InputIterator end) {
+        nb_elements = encode_postings(begin, end, bytes);
+        bytes.shrink_to_fit();
+    }
+
+    size_t size() const { return nb_elements; }
+    bool empty() const { return nb_elements == 0; }
+    size_t nb_bytes() const { return bytes.size(); }
+
+    const_iterator begin() const { return const_iterator(bytes.data(), bytes.data() + bytes.size()); }
+    const_iterator end() const { return const_iterator(); }
+
+    PostingListView<T> view() const {
+        return PostingListView<T>(bytes.data(), bytes.data() + bytes.size(), nb_elements);
+    }
+
+    template<class Archive> void serialize(Archive & ar, const unsigned int) {
+        ar & bytes & nb_elements;
+    }
+};
+
+/** Sorted indexes of the union of several lists, without duplicates
+ *
+ * The lists are merged while reading (k-way merge), nothing is copied.
+ */
+template<class T>
+class PostingListUnion {
+    typedef PostingListIterator<T> iterator;
+    struct Cursor {
+        iterator current;
+        iterator end;
+    };
+    std::vector<Cursor> cursors;
+    /// (index, cursor) of the cursors not at their end
+    typedef std::pair<T, size_t> HeapItem;
+    std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> heap;
+    size_t estimated_size = 0;
+
+    void push(size_t i) {
+        if (cursors[i].current != cursors[i].end) {
+            heap.push({*cursors[i].current, i});
+        }
+    }
+
+public:
+    explicit PostingListUnion(const std::vector<PostingListView<T>>& lists) {
+        cursors.reserve(lists.size());
+        for (const auto& list: lists) {
+            cursors.push_back({list.begin(), list.end()});
+            push(cursors.size() - 1);
+            estimated_size += list.size();
+        }
+    }
+
+    /// sum of the sizes of the lists, the size of the union being at most this
+    size_t max_size() const { return estimated_size; }
+
+    /// next index of the union not lower than min_value, false if there is none
+    bool next(T& value, T min_value = T()) {
+        while (! heap.empty()) {
+            const auto top = heap.top();
+            heap.pop();
+            auto& cursor = cursors[top.second];
+            // the other occurrences of this index, and the indexes lower than min_value, are skipped
+            do {
+                ++cursor.current;
+            } while (cursor.current != cursor.end && (*cursor.current == top.first || *cursor.current < min_value));
+            push(top.second);
+            if (top.first < min_value) { continue; }
+            while (! heap.empty() && heap.top().first == top.first) {
+                const auto i = heap.top().second;
+                heap.pop();
+                do {
+                    ++cursors[i].current;
+                } while (cursors[i].current != cursors[i].end && *cursors[i].current == top.first);
+                push(i);
+            }
+            value = top.first;
+            return true;
+        }
+        return false;
+    }
+};
+
+/** Sorted indexes present in all the unions
+ *
+ * Leapfrog intersection: each union in turn skips to the candidate index,
+ * the smallest union giving the first candidate.
+ */
+template<class T>
+std::vector<T> intersect(std::vector<PostingListUnion<T>>& unions) {
+    std::vector<T> result;
+    if (unions.empty()) { return result; }
+    std::sort(unions.begin(), unions.end(), [](const PostingListUnion<T>& a, const PostingListUnion<T>& b) {
+        return a.max_size() < b.max_size();
+    });
+    T candidate;
+    if (! unions.front().next(candidate)) { return result; }
+    size_t nb_agreeing = 1;
+    size_t i = 0;
+    while (true) {
+        i = (i + 1) % unions.size();
+        if (nb_agreeing == unions.size()) {
+            // all the unions are past the candidate
+            result.push_back(candidate);
+            if (! unions[i].next(candidate)) { return result; }
+            nb_agreeing = 1;
+            continue;
+        }
+        T value;
+        if (! unions[i].next(value, candidate)) { return result; }
+        if (value == candidate) {
+            ++nb_agreeing;
+        } else {
+            candidate = value;
+            nb_agreeing = 1;
+        }
+    }
+}
+
+}}
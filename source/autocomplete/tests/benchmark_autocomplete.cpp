@@ -0,0 +1,133 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "autocomplete/autocomplete_api.h"
+#include "type/data.h"
+#include "type/pt_data.h"
+#include "georef/georef.h"
+#include "utils/timer.h"
+#include "utils/init.h"
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <random>
+#include <iostream>
+
+/*
+ * Benchmark of /places: latency of the autocomplete on the stop areas,
+ * the admins, the addresses and the pois of a data.nav.lz4, by length of
+ * the query. The queries are the beginnings of random names, so the short
+ * queries match a lot of words.
+ */
+
+using namespace navitia;
+namespace po = boost::program_options;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double elapsed_us(const Clock::time_point& begin) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count() / 1000.;
+}
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) { return 0; }
+    const size_t rank = std::min(values.size() - 1, size_t(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+}
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("Options of the autocomplete benchmark");
+    std::string file;
+    int nb_queries, max_length, search_type;
+    desc.add_options()
+            ("help", "Show this message")
+            ("nb_queries,n", po::value<int>(&nb_queries)->default_value(200),
+                     "Number of queries by length")
+            ("max_length,l", po::value<int>(&max_length)->default_value(10),
+                     "Longest query")
+            ("search_type,s", po::value<int>(&search_type)->default_value(0),
+                     "0 for the complete search, 1 for the search with typos")
+            ("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"),
+                     "Path to data.nav.lz4");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 1;
+    }
+
+    type::Data data;
+    {
+        Timer t("Chargement des données : " + file);
+        data.load(file);
+    }
+
+    std::vector<std::string> names;
+    for (const auto* sa: data.pt_data->stop_areas) { names.push_back(sa->name); }
+    for (const auto* admin: data.geo_ref->admins) { names.push_back(admin->name); }
+    for (const auto* way: data.geo_ref->ways) { names.push_back(way->name); }
+    for (const auto* poi: data.geo_ref->pois) { names.push_back(poi->name); }
+    if (names.empty()) {
+        std::cout << "nothing to autocomplete" << std::endl;
+        return 1;
+    }
+    std::cout << names.size() << " names" << std::endl;
+
+    const std::vector<type::Type_e> filter = {type::Type_e::StopArea, type::Type_e::Admin,
+                                              type::Type_e::Address, type::Type_e::POI};
+    std::mt19937 rng(31442);
+    std::uniform_int_distribution<size_t> name_gen(0, names.size() - 1);
+    for (int length = 1; length <= max_length; ++length) {
+        std::vector<double> latencies;
+        size_t nb_places = 0;
+        for (int i = 0; i < nb_queries; ++i) {
+            const auto& name = names[name_gen(rng)];
+            if (name.size() < size_t(length)) { continue; }
+            const auto query = name.substr(0, length);
+
+            PbCreator pb_creator(&data, boost::gregorian::not_a_date_time, null_time_period);
+            const auto begin = Clock::now();
+            autocomplete::autocomplete(pb_creator, query, filter, 1, 10, {}, search_type, data);
+            latencies.push_back(elapsed_us(begin));
+            nb_places += pb_creator.get_response().places_size();
+        }
+        if (latencies.empty()) { continue; }
+        std::cout << "length " << length << ": " << latencies.size() << " queries, "
+                  << double(nb_places) / latencies.size() << " places by query, p50 "
+                  << percentile(latencies, 0.5) / 1000 << " ms, p99 "
+                  << percentile(latencies, 0.99) / 1000 << " ms" << std::endl;
+    }
+    return 0;
+}
@@ -357,6 +357,158 @@ BOOST_AUTO_TEST_CASE(parse_find_with_name_in_vector_test){
     BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), expected.begin(), expected.end());    
 }
 
+BOOST_AUTO_TEST_CASE(posting_list_test){
+    const std::vector<unsigned int> indexes = {0, 0, 1, 2, 127, 128, 128, 16383, 16384, 4000000000u};
+    PostingList<unsigned int> list(indexes.begin(), indexes.end());
+    const std::vector<unsigned int> expected = {0, 1, 2, 127, 128, 16383, 16384, 4000000000u};
+    BOOST_CHECK_EQUAL(list.size(), expected.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(list.begin(), list.end(), expected.begin(), expected.end());
+
+    PostingList<unsigned int> empty;
+    BOOST_CHECK(empty.begin() == empty.end());
+
+    // the union skips the duplicates, the intersection leapfrogs between the unions
+    const std::vector<unsigned int> a = {1, 3, 5, 7, 9}, b = {2, 3, 4, 5, 6}, c = {3, 5, 9, 10};
+    const PostingList<unsigned int> list_a(a.begin(), a.end()), list_b(b.begin(), b.end()), list_c(c.begin(), c.end());
+    std::vector<PostingListUnion<unsigned int>> unions;
+    unions.emplace_back(std::vector<PostingListView<unsigned int>>{list_a.view(), list_b.view()});
+    unions.emplace_back(std::vector<PostingListView<unsigned int>>{list_c.view()});
+    auto res = intersect(unions);
+    std::vector<unsigned int> expected_res = {3, 5, 9};
+    BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), expected_res.begin(), expected_res.end());
+}
+
+/*
+ * the short prefixes use their precomputed union, they must find the same
+ * elements as the longer prefixes (through the lists of all the words)
+ */
+BOOST_AUTO_TEST_CASE(find_with_short_prefix_test){
+    autocomplete_map synonyms;
+    std::set<std::string> ghostwords;
+    Autocomplete<unsigned int> ac;
+    ac.add_string("rue jean jaures", 0, ghostwords, synonyms);
+    ac.add_string("place jean jaures", 1, ghostwords, synonyms);
+    ac.add_string("rue jeanne d'arc", 2, ghostwords, synonyms);
+    ac.add_string("avenue jean jaures", 3, ghostwords, synonyms);
+    ac.add_string("boulevard poniatowski", 4, ghostwords, synonyms);
+    ac.add_string("rond point", 5, ghostwords, synonyms);
+    ac.add_string("j", 6, ghostwords, synonyms);
+    ac.build();
+
+    auto check = [&](const std::set<std::string>& words, const std::vector<unsigned int>& expected) {
+        const auto res = ac.find(words);
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), expected.begin(), expected.end());
+    };
+    check({"r"}, {0, 2, 5});
+    check({"ro"}, {5});
+    check({"j"}, {0, 1, 2, 3, 6});
+    check({"ja"}, {0, 1, 3});
+    check({"j", "r"}, {0, 2});
+    check({"ru", "j"}, {0, 2});
+    check({"p", "ja"}, {1});
+    check({"x"}, {});
+    check({"j", "x"}, {});
+}
+
+/*
+ * when more elements than nbmax match, only the best ones by score are
+ * searched in the dictionary, they must be the best ones of the full search
+ */
+BOOST_AUTO_TEST_CASE(find_complete_best_scores_test){
+    autocomplete_map synonyms;
+    std::set<std::string> ghostwords;
+    Autocomplete<unsigned int> ac;
+    const std::vector<std::string> names = {"jean jaures", "jeanne d'arc", "jules verne", "victor hugo", "jaures"};
+    for (unsigned int i = 0; i < 20; ++i) {
+        ac.add_string("rue " + names[i % names.size()], i, ghostwords, synonyms);
+    }
+    ac.build();
+    BOOST_CHECK_EQUAL(ac.word_dictionnary.nb_words(), 10);
+    // all the scores are different
+    for (unsigned int i = 0; i < 20; ++i) {
+        ac.word_quality_list.at(i).score = (i * 7) % 20;
+    }
+    ac.compute_max_scores();
+
+    auto check = [&](const std::string& str, size_t nbmax, std::function<bool(unsigned int)> keep_element,
+                     const std::vector<unsigned int>& expected) {
+        const auto res = ac.find_complete(str, nbmax, keep_element, ghostwords);
+        std::vector<unsigned int> idx;
+        for (const auto& quality: res) { idx.push_back(quality.idx); }
+        BOOST_CHECK_EQUAL_COLLECTIONS(idx.begin(), idx.end(), expected.begin(), expected.end());
+    };
+    check("rue", 5, [](unsigned int){return true;}, {17, 14, 11, 8, 5});
+    check("r", 2, [](unsigned int){return true;}, {17, 14});
+    check("rue ja", 3, [](unsigned int i){return i % 2 == 0;}, {14, 10, 4});
+    check("jaur", 3, [](unsigned int){return true;}, {14, 5, 19});
+    check("rue xavier", 3, [](unsigned int){return true;}, {});
+}
+
+/*
+ * the n-grams of the query are counted as the lists were read one by one:
+ * a repeated n-gram counts twice, a shorter one counts for all the n-grams it starts
+ */
+BOOST_AUTO_TEST_CASE(ngram_index_test){
+    autocomplete_map synonyms;
+    std::set<std::string> ghostwords;
+    Autocomplete<unsigned int> ac;
+    ac.add_string("bateau", 0, ghostwords, synonyms);
+    ac.add_string("gateau", 1, ghostwords, synonyms);
+    ac.add_string("taureau", 2, ghostwords, synonyms);
+    ac.add_string("x", 3, ghostwords, synonyms);
+    ac.build();
+
+    auto check = [&](const std::vector<std::string>& ngrams, uint32_t min_found,
+                     std::vector<std::pair<unsigned int, uint32_t>> expected) {
+        auto res = ac.pattern_dictionnary.find(ngrams, min_found);
+        std::sort(res.begin(), res.end());
+        BOOST_CHECK_EQUAL(res.size(), expected.size());
+        for (size_t i = 0; i < std::min(res.size(), expected.size()); ++i) {
+            BOOST_CHECK_EQUAL(res[i].first, expected[i].first);
+            BOOST_CHECK_EQUAL(res[i].second, expected[i].second);
+        }
+    };
+    check({"ba", "at", "ta", "au"}, 3, {{0, 3}});
+    check({"ba", "at", "ta", "au"}, 2, {{0, 3}, {1, 2}, {2, 2}});
+    check({"au", "au"}, 2, {{0, 2}, {1, 2}, {2, 2}});
+    check({"a"}, 2, {{0, 2}, {1, 2}});
+    check({"x"}, 1, {{3, 1}});
+    check({"zz", "ba"}, 2, {});
+}
+
+/*
+ * the strings tokenized on several threads give the same index as the ones added one by one
+ */
+BOOST_AUTO_TEST_CASE(add_strings_on_several_threads_test){
+    autocomplete_map synonyms;
+    synonyms["st"] = "saint";
+    std::set<std::string> ghostwords = {"de"};
+    const std::vector<std::string> names = {"rue jean jaures", "place jean jaures", "", "rue jeanne d'arc",
+                                            "avenue jean jaures", "gare de st malo", "boulevard poniatowski",
+                                            "rond point", "rue de la gare"};
+    Autocomplete<unsigned int> ac;
+    for (unsigned int i = 0; i < names.size(); ++i) {
+        if (! names[i].empty()) { ac.add_string(names[i], i, ghostwords, synonyms); }
+    }
+    ac.build();
+    Autocomplete<unsigned int> parallel_ac;
+    parallel_ac.add_strings(names.size(), [&](size_t i) { return std::make_pair(names[i], (unsigned int)i); },
+                            ghostwords, synonyms, 4);
+    parallel_ac.build();
+
+    BOOST_CHECK_EQUAL(parallel_ac.word_quality_list.size(), ac.word_quality_list.size());
+    BOOST_CHECK_EQUAL(parallel_ac.word_dictionnary.nb_words(), ac.word_dictionnary.nb_words());
+    for (const std::set<std::string>& words: std::vector<std::set<std::string>>{{"r"}, {"jean"}, {"saint"}, {"gare"},
+                                                                               {"ja", "rue"}, {"de"}}) {
+        const auto res = parallel_ac.find(words);
+        const auto expected = ac.find(words);
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), expected.begin(), expected.end());
+    }
+    const auto res = parallel_ac.find_partial_with_pattern("jen jaures", 5, 10, [](unsigned int){return true;}, ghostwords);
+    const auto expected = ac.find_partial_with_pattern("jen jaures", 5, 10, [](unsigned int){return true;}, ghostwords);
+    BOOST_CHECK_EQUAL(res.size(), expected.size());
+}
+
 /*
     > Le fonctionnement partiel :> On prends tous les autocomplete s'il y au moins un match
       et trie la liste des Autocomplete par la qualité.
@@ -1099,7 +1251,7 @@ BOOST_AUTO_TEST_CASE(autocomplete_functional_test_SA_temp_test) {
     b.data->geo_ref->admins.push_back(ad);
     b.manage_admin();
     b.build_autocomplete();
-    b.data->geo_ref->fl_admin.word_quality_list.at(0).score = 50;
+    navitia::georef::mutable_part(b.data->geo_ref->fl_admin).word_quality_list.at(0).score = 50;
     b.data->pt_data->stop_area_autocomplete.word_quality_list.at(0).score = 10;
     b.data->pt_data->stop_area_autocomplete.word_quality_list.at(1).score = 7;
     b.data->pt_data->stop_area_autocomplete.word_quality_list.at(2).score = 35;
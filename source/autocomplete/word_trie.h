@@ -0,0 +1,304 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+#include "posting_list.h"
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace navitia { namespace autocomplete {
+
+/** Dictionary of words associated with lists of indexes, as a path compressed trie
+ *
+ * The words are numbered in alphabetical order, the words starting with a
+ * prefix being a contiguous range of words below a node. The labels of the
+ * nodes share a buffer, as do the lists of the words.
+ *
+ * Each node knows the best score of the indexes of the words below it, so
+ * the best indexes for a prefix are found without reading all its lists.
+ */
+template<class T>
+class WordTrie {
+public:
+    struct Node {
+        uint32_t label_begin = 0;
+        uint16_t label_length = 0;
+        uint16_t nb_children = 0;
+        /// the children are contiguous and sorted by label
+        uint32_t first_child = 0;
+        /// words below the node, its own word first if it ends a word
+        uint32_t first_word = 0;
+        uint32_t end_word = 0;
+        int max_score = 0;
+
+        template<class Archive> void serialize(Archive & ar, const unsigned int) {
+            ar & label_begin & label_length & nb_children & first_child & first_word & end_word & max_score;
+        }
+    };
+
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+private:
+    std::string labels;
+    /// the root is the first node
+    std::vector<Node> nodes;
+    std::vector<uint8_t> postings;
+    /// the list of the word i is in postings[offsets[i], offsets[i + 1])
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> sizes;
+
+    /// the word i is couples[starts[i]].first, its indexes are in couples[starts[i], starts[i + 1])
+    struct SortedWords {
+        const std::vector<std::pair<std::string, T>>& couples;
+        std::vector<uint32_t> starts;
+
+        const std::string& word(uint32_t i) const { return couples[starts[i]].first; }
+    };
+
+    /// words [begin, end) share their first depth characters
+    void build_node(uint32_t n, const SortedWords& words, uint32_t begin, uint32_t end, size_t depth,
+                    std::vector<T>& buffer) {
+        const std::string& first = words.word(begin);
+        const std::string& last = words.word(end - 1);
+        size_t common = depth;
+        while (common < first.size() && common < last.size() && first[common] == last[common]) { ++common; }
+
+        nodes[n].label_begin = labels.size();
+        nodes[n].label_length = common - depth;
+        nodes[n].first_word = begin;
+        nodes[n].end_word = end;
+        labels.append(first, depth, common - depth);
+        if (first.size() == common) {
+            // the sorted words begin with the word of the node
+            buffer.clear();
+            for (uint32_t i = words.starts[begin]; i < words.starts[begin + 1]; ++i) {
+                buffer.push_back(words.couples[i].second);
+            }
+            sizes.push_back(encode_postings(buffer.begin(), buffer.end(), postings));
+            offsets.push_back(postings.size());
+            ++begin;
+        }
+
+        std::vector<std::pair<uint32_t, uint32_t>> groups;
+        while (begin != end) {
+            uint32_t group_end = begin + 1;
+            while (group_end != end && words.word(group_end)[common] == words.word(begin)[common]) { ++group_end; }
+            groups.push_back({begin, group_end});
+            begin = group_end;
+        }
+        nodes[n].first_child = nodes.size();
+        nodes[n].nb_children = groups.size();
+        nodes.resize(nodes.size() + groups.size());
+        for (size_t i = 0; i < groups.size(); ++i) {
+            build_node(nodes[n].first_child + i, words, groups[i].first, groups[i].second, common, buffer);
+        }
+    }
+
+    bool is_word(const Node& node) const {
+        return node.first_word != node.end_word
+            && (node.nb_children == 0 || nodes[node.first_child].first_word != node.first_word);
+    }
+
+    template<class Function>
+    void visit_prefixes(uint32_t n, size_t length, std::string& current, Function& f) const {
+        const Node& node = nodes[n];
+        const size_t before = current.size();
+        if (before + node.label_length >= length) {
+            current.append(labels, node.label_begin, length - before);
+            f(current, node.first_word, node.end_word);
+        } else {
+            current.append(labels, node.label_begin, node.label_length);
+            for (uint32_t child = node.first_child; child < node.first_child + node.nb_children; ++child) {
+                visit_prefixes(child, length, current, f);
+            }
+        }
+        current.resize(before);
+    }
+
+public:
+    WordTrie() {}
+
+    /** The (word, index) couples must be sorted, they can be repeated
+     *
+     * The words must be shorter than 64kB.
+     */
+    explicit WordTrie(const std::vector<std::pair<std::string, T>>& couples) {
+        SortedWords words{couples, {}};
+        for (uint32_t i = 0; i < couples.size(); ++i) {
+            if (! couples[i].first.empty() && (words.starts.empty() || couples[i].first != words.word(words.starts.size() - 1))) {
+                words.starts.push_back(i);
+            }
+        }
+        const uint32_t nb_words = words.starts.size();
+        words.starts.push_back(couples.size());
+        nodes.resize(1);
+        offsets.push_back(0);
+        if (nb_words > 0) {
+            std::vector<T> buffer;
+            build_node(0, words, 0, nb_words, 0, buffer);
+        }
+        labels.shrink_to_fit();
+        nodes.shrink_to_fit();
+        postings.shrink_to_fit();
+    }
+
+    size_t nb_words() const { return sizes.size(); }
+
+    PostingListView<T> list(size_t word) const {
+        return PostingListView<T>(postings.data() + offsets[word], postings.data() + offsets[word + 1], sizes[word]);
+    }
+
+    /// node of the words starting with prefix, npos if there is none
+    uint32_t find(const std::string& prefix) const {
+        if (nodes.empty() || nodes.front().first_word == nodes.front().end_word) { return npos; }
+        uint32_t n = 0;
+        size_t matched = 0;
+        while (true) {
+            const Node& node = nodes[n];
+            const size_t length = std::min<size_t>(node.label_length, prefix.size() - matched);
+            if (labels.compare(node.label_begin, length, prefix, matched, length) != 0) { return npos; }
+            matched += length;
+            if (matched == prefix.size()) { return n; }
+            const auto children_begin = nodes.begin() + node.first_child;
+            const auto children_end = children_begin + node.nb_children;
+            // the words are sorted as std::string does, by unsigned char
+            const auto c = static_cast<unsigned char>(prefix[matched]);
+            const auto child = std::lower_bound(children_begin, children_end, c, [&](const Node& a, unsigned char b) {
+                return static_cast<unsigned char>(labels[a.label_begin]) < b;
+            });
+            if (child == children_end || static_cast<unsigned char>(labels[child->label_begin]) != c) { return npos; }
+            n = child - nodes.begin();
+        }
+    }
+
+    /// range [first, end) of the words starting with prefix
+    std::pair<uint32_t, uint32_t> words(const std::string& prefix) const {
+        const auto n = find(prefix);
+        if (n == npos) { return {0, 0}; }
+        return {nodes[n].first_word, nodes[n].end_word};
+    }
+
+    /// lists of the words starting with prefix
+    std::vector<PostingListView<T>> match(const std::string& prefix) const {
+        std::vector<PostingListView<T>> result;
+        const auto range = words(prefix);
+        for (uint32_t word = range.first; word < range.second; ++word) {
+            result.push_back(list(word));
+        }
+        return result;
+    }
+
+    /// calls f(prefix, first_word, end_word) for each prefix of this length of the words
+    template<class Function>
+    void visit_prefixes(size_t length, Function f) const {
+        std::string current;
+        if (! nodes.empty() && nodes.front().first_word != nodes.front().end_word) {
+            visit_prefixes(0, length, current, f);
+        }
+    }
+
+    /// score(index) must then be at most the max_score of the nodes above the index
+    template<class Score>
+    void compute_max_scores(Score score) {
+        // the children are after their parent
+        for (size_t n = nodes.size(); n-- > 0;) {
+            Node& node = nodes[n];
+            node.max_score = std::numeric_limits<int>::min();
+            if (is_word(node)) {
+                for (auto index: list(node.first_word)) {
+                    node.max_score = std::max(node.max_score, score(index));
+                }
+            }
+            for (uint32_t child = node.first_child; child < node.first_child + node.nb_children; ++child) {
+                node.max_score = std::max(node.max_score, nodes[child].max_score);
+            }
+        }
+    }
+
+    /** Calls visit(index, score) for the indexes of the words starting with prefix,
+     * by decreasing score, until visit returns false
+     *
+     * Only the nodes whose max_score can beat the visited indexes are read.
+     * The order of the indexes of the same score is not specified.
+     */
+    template<class Score, class Visit>
+    void visit_by_score(const std::string& prefix, Score score, Visit visit) const {
+        const auto root = find(prefix);
+        if (root == npos) { return; }
+        struct Item {
+            int score;
+            bool is_index;
+            uint32_t node;
+            T index;
+        };
+        // at equal score, the indexes are visited before the nodes are read
+        auto lower_priority = [](const Item& a, const Item& b) {
+            return a.score < b.score || (a.score == b.score && a.is_index < b.is_index);
+        };
+        std::priority_queue<Item, std::vector<Item>, decltype(lower_priority)> queue(lower_priority);
+        queue.push({nodes[root].max_score, false, root, T()});
+        std::unordered_set<T> visited;
+        while (! queue.empty()) {
+            const Item item = queue.top();
+            queue.pop();
+            if (item.is_index) {
+                // an index can be in several words
+                if (visited.insert(item.index).second && ! visit(item.index, item.score)) { return; }
+                continue;
+            }
+            const Node& node = nodes[item.node];
+            if (is_word(node)) {
+                for (auto index: list(node.first_word)) {
+                    queue.push({score(index), true, 0, index});
+                }
+            }
+            for (uint32_t child = node.first_child; child < node.first_child + node.nb_children; ++child) {
+                queue.push({nodes[child].max_score, false, child, T()});
+            }
+        }
+    }
+
+    template<class Archive> void serialize(Archive & ar, const unsigned int) {
+        ar & labels & nodes & postings & offsets & sizes;
+    }
+};
+
+template<class T>
+constexpr uint32_t WordTrie<T>::npos;
+
+}}
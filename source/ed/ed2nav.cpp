@@ -163,6 +163,7 @@ int main(int argc, char * argv[])
     auto logger = log4cplus::Logger::getInstance("log");
     std::string output, connection_string, region_name, cities_connection_string;
     double min_non_connected_graph_ratio;
+    size_t nb_autocomplete_threads;
     po::options_description desc("Allowed options");
     desc.add_options()
         ("help,h", "Show this message")
@@ -175,9 +176,13 @@ int main(int argc, char * argv[])
         ("min_non_connected_ratio,m",
          po::value<double>(&min_non_connected_graph_ratio)->default_value(0.1),
          "min ratio for the size of non connected graph")
+        ("nb_autocomplete_threads,t", po::value<size_t>(&nb_autocomplete_threads)->default_value(1),
+         "number of threads building the autocomplete indexes")
         ("full_street_network_geometries", "If true export street network geometries allowing kraken to return accurate"
          "geojson for street network sections. Also improve projections accuracy. "
          "WARNING : memory intensive. The lz4 can more than double in size and kraken will consume significantly more memory.")
+        ("contraction_hierarchies", "If true build the contraction hierarchies of the bike and car street networks, "
+         "allowing kraken to compute long direct paths much faster. The extraction is longer and the lz4 bigger.")
         ("connection-string", po::value<std::string>(&connection_string)->required(),
          "database connection parameters: host=localhost user=navitia dbname=navitia password=navitia")
         ("cities-connection-string", po::value<std::string>(&cities_connection_string)->default_value(""),
@@ -186,6 +191,7 @@ int main(int argc, char * argv[])
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
     bool export_georef_edges_geometries(vm.count("full_street_network_geometries"));
+    bool build_contraction_hierarchies(vm.count("contraction_hierarchies"));
 
     if(vm.count("version")){
         std::cout << argv[0] << " " << navitia::config::project_version << " "
@@ -213,7 +219,7 @@ int main(int argc, char * argv[])
     po::notify(vm);
 
     pt::ptime start, now;
-    int read, save;
+    int read, save, contraction = 0;
 
     navitia::type::Data data;
 
@@ -236,9 +242,20 @@ int main(int argc, char * argv[])
     }
 
     read = (pt::microsec_clock::local_time() - start).total_milliseconds();
-    data.complete();
+    data.complete(nb_autocomplete_threads);
     data.meta->publication_date = pt::microsec_clock::local_time();
 
+    if (build_contraction_hierarchies) {
+        LOG4CPLUS_INFO(logger, "Building the contraction hierarchies ...");
+        start = pt::microsec_clock::local_time();
+        data.geo_ref->build_contraction_hierarchies({navitia::type::Mode_e::Bike, navitia::type::Mode_e::Car});
+        contraction = (pt::microsec_clock::local_time() - start).total_milliseconds();
+        for (const auto mode: {navitia::type::Mode_e::Bike, navitia::type::Mode_e::Car}) {
+            LOG4CPLUS_INFO(logger, "contraction hierarchy arcs for mode " << int(mode) << ": "
+                           << (*data.geo_ref->contraction_hierarchies)[mode].nb_arcs());
+        }
+    }
+
     LOG4CPLUS_INFO(logger, "line: " << data.pt_data->lines.size());
     LOG4CPLUS_INFO(logger, "line_groups: " << data.pt_data->line_groups.size());
     LOG4CPLUS_INFO(logger, "route: " << data.pt_data->routes.size());
@@ -270,6 +287,9 @@ int main(int argc, char * argv[])
     LOG4CPLUS_INFO(logger, "Computing times");
     LOG4CPLUS_INFO(logger, "\t File reading: " << read << "ms");
     LOG4CPLUS_INFO(logger, "\t Data writing: " << save << "ms");
+    if (build_contraction_hierarchies) {
+        LOG4CPLUS_INFO(logger, "\t Contraction hierarchies: " << contraction << "ms");
+    }
 
     return 0;
 }
@@ -1440,6 +1440,7 @@ void EdReader::fill_vector_to_ignore(pqxx::work& work, const double min_non_conn
 void EdReader::fill_vertex(navitia::type::Data& data, pqxx::work& work) {
     std::string request = "select id, ST_X(coord::geometry) as lon, ST_Y(coord::geometry) as lat from georef.node;";
     pqxx::result result = work.exec(request);
+    auto& graph = navitia::georef::mutable_part(data.geo_ref->graph);
     uint64_t idx = 0;
     for(auto const_it = result.begin(); const_it != result.end(); ++const_it){
         auto id = const_it["id"].as<uint64_t>();
@@ -1452,7 +1453,7 @@ void EdReader::fill_vertex(navitia::type::Data& data, pqxx::work& work) {
         navitia::georef::Vertex v;
         v.coord.set_lon(const_it["lon"].as<double>());
         v.coord.set_lat(const_it["lat"].as<double>());
-        boost::add_vertex(v, data.geo_ref->graph);
+        boost::add_vertex(v, graph);
         this->node_map[id] = idx;
         idx++;
     }
@@ -1482,6 +1483,7 @@ void EdReader::fill_graph(navitia::type::Data& data, pqxx::work& work, bool expo
     }
     request += " from georef.edge e;";
     pqxx::result result = work.exec(request);
+    auto& graph = navitia::georef::mutable_part(data.geo_ref->graph);
     size_t nb_edges_no_way = 0, nb_useless_edges = 0;
     size_t nb_walking_edges(0), nb_biking_edges(0), nb_driving_edges(0);
 
@@ -1535,7 +1537,7 @@ void EdReader::fill_graph(navitia::type::Data& data, pqxx::work& work, bool expo
         if (walkable) {
             if (auto dur = get_duration(nt::Mode_e::Walking, len, source, target)) {
                 e.duration = navitia::seconds(*dur);
-                boost::add_edge(source, target, e, data.geo_ref->graph);
+                boost::add_edge(source, target, e, graph);
                 way->edges.push_back(std::make_pair(source, target));
                 nb_walking_edges++;
             }
@@ -1545,7 +1547,7 @@ void EdReader::fill_graph(navitia::type::Data& data, pqxx::work& work, bool expo
                 e.duration = navitia::seconds(*dur);
                 auto bike_source = data.geo_ref->offsets[nt::Mode_e::Bike] + source;
                 auto bike_target = data.geo_ref->offsets[nt::Mode_e::Bike] + target;
-                boost::add_edge(bike_source, bike_target, e, data.geo_ref->graph);
+                boost::add_edge(bike_source, bike_target, e, graph);
                 way->edges.push_back(std::make_pair(bike_source, bike_target));
                 nb_biking_edges++;
             }
@@ -1555,7 +1557,7 @@ void EdReader::fill_graph(navitia::type::Data& data, pqxx::work& work, bool expo
                 e.duration = navitia::seconds(*dur);
                 auto car_source = data.geo_ref->offsets[nt::Mode_e::Car] + source;
                 auto car_target = data.geo_ref->offsets[nt::Mode_e::Car] + target;
-                boost::add_edge(car_source, car_target, e, data.geo_ref->graph);
+                boost::add_edge(car_source, car_target, e, graph);
                 way->edges.push_back(std::make_pair(car_source, car_target));
                 nb_driving_edges++;
             }
@@ -1569,7 +1571,7 @@ void EdReader::fill_graph(navitia::type::Data& data, pqxx::work& work, bool expo
         LOG4CPLUS_WARN(log, nb_useless_edges << " edges are not usable by any modes");
     }
 
-    LOG4CPLUS_INFO(log, boost::num_edges(data.geo_ref->graph) << " edges added ");
+    LOG4CPLUS_INFO(log, boost::num_edges(*data.geo_ref->graph) << " edges added ");
     LOG4CPLUS_INFO(log, nb_walking_edges << " walking edges");
     LOG4CPLUS_INFO(log, nb_biking_edges << " biking edges");
     LOG4CPLUS_INFO(log, nb_driving_edges << " driving edges");
@@ -0,0 +1,377 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#include "contraction_hierarchy.h"
+#include "utils/exception.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace navitia { namespace georef {
+
+const uint32_t ContractionHierarchy::invalid_vertex;
+const ContractionHierarchy::Weight ContractionHierarchy::inf;
+
+namespace {
+
+typedef ContractionHierarchy::Weight Weight;
+typedef ContractionHierarchy::Arc Arc;
+typedef std::pair<Weight, uint32_t> QueueItem;
+typedef std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> Queue;
+
+/// saturated sum, the weights never overflow
+Weight add(Weight a, Weight b) {
+    return a >= ContractionHierarchy::inf - b ? ContractionHierarchy::inf : a + b;
+}
+
+/// graph being contracted: only the arcs between the vertices not contracted yet are kept
+struct ContractionBuilder {
+    const size_t max_settled_witness;
+    std::vector<std::vector<Arc>> out_arcs;
+    std::vector<std::vector<Arc>> in_arcs;
+    std::vector<bool> contracted;
+    std::vector<uint32_t> nb_contracted_neighbors;
+
+    // witness search, only the touched vertices are reset between two searches
+    std::vector<Weight> witness_distances;
+    std::vector<uint32_t> touched;
+
+    ContractionBuilder(size_t nb_vertices, size_t max_settled_witness) :
+        max_settled_witness(max_settled_witness), out_arcs(nb_vertices), in_arcs(nb_vertices),
+        contracted(nb_vertices, false), nb_contracted_neighbors(nb_vertices, 0),
+        witness_distances(nb_vertices, ContractionHierarchy::inf) {}
+
+    static void add_to(std::vector<Arc>& arcs, uint32_t vertex, Weight weight, uint32_t middle) {
+        for (auto& arc: arcs) {
+            if (arc.vertex != vertex) { continue; }
+            if (weight < arc.weight) {
+                arc.weight = weight;
+                arc.middle = middle;
+            }
+            return;
+        }
+        Arc arc;
+        arc.vertex = vertex;
+        arc.weight = weight;
+        arc.middle = middle;
+        arcs.push_back(arc);
+    }
+
+    /// only the lightest arc between two vertices is kept
+    void add_arc(uint32_t source, uint32_t target, Weight weight, uint32_t middle) {
+        add_to(out_arcs[source], target, weight, middle);
+        add_to(in_arcs[target], source, weight, middle);
+    }
+
+    /// distances from source without going through excluded, up to max_weight
+    void witness_search(uint32_t source, uint32_t excluded, Weight max_weight) {
+        for (const auto v: touched) { witness_distances[v] = ContractionHierarchy::inf; }
+        touched.clear();
+        Queue queue;
+        witness_distances[source] = 0;
+        touched.push_back(source);
+        queue.push({0, source});
+        size_t nb_settled = 0;
+        while (! queue.empty() && nb_settled < max_settled_witness) {
+            const auto item = queue.top();
+            queue.pop();
+            const auto u = item.second;
+            if (item.first > witness_distances[u]) { continue; }
+            if (item.first > max_weight) { break; }
+            ++nb_settled;
+            for (const auto& arc: out_arcs[u]) {
+                if (arc.vertex == excluded) { continue; }
+                const auto dist = add(item.first, arc.weight);
+                if (dist < witness_distances[arc.vertex]) {
+                    if (witness_distances[arc.vertex] == ContractionHierarchy::inf) {
+                        touched.push_back(arc.vertex);
+                    }
+                    witness_distances[arc.vertex] = dist;
+                    queue.push({dist, arc.vertex});
+                }
+            }
+        }
+    }
+
+    /// shortcuts needed to contract v
+    std::vector<std::pair<uint32_t, Arc>> needed_shortcuts(uint32_t v) {
+        std::vector<std::pair<uint32_t, Arc>> shortcuts;
+        for (const auto& in: in_arcs[v]) {
+            Weight max_weight = 0;
+            bool has_out_arc = false;
+            for (const auto& out: out_arcs[v]) {
+                if (out.vertex == in.vertex) { continue; }
+                max_weight = std::max(max_weight, add(in.weight, out.weight));
+                has_out_arc = true;
+            }
+            if (! has_out_arc) { continue; }
+            witness_search(in.vertex, v, max_weight);
+            for (const auto& out: out_arcs[v]) {
+                if (out.vertex == in.vertex) { continue; }
+                const auto weight = add(in.weight, out.weight);
+                if (witness_distances[out.vertex] <= weight) { continue; }
+                Arc shortcut;
+                shortcut.vertex = out.vertex;
+                shortcut.weight = weight;
+                shortcut.middle = v;
+                shortcuts.push_back({in.vertex, shortcut});
+            }
+        }
+        return shortcuts;
+    }
+
+    /// edge difference, plus the contracted neighbors to contract uniformly the graph
+    int priority(uint32_t v) {
+        const int nb_shortcuts = needed_shortcuts(v).size();
+        return nb_shortcuts - int(in_arcs[v].size() + out_arcs[v].size())
+                + int(nb_contracted_neighbors[v]);
+    }
+
+    void contract(uint32_t v) {
+        for (const auto& shortcut: needed_shortcuts(v)) {
+            add_arc(shortcut.first, shortcut.second.vertex, shortcut.second.weight, v);
+        }
+        const auto remove_v = [v](std::vector<Arc>& arcs) {
+            arcs.erase(std::remove_if(arcs.begin(), arcs.end(),
+                                      [v](const Arc& arc) { return arc.vertex == v; }),
+                       arcs.end());
+        };
+        for (const auto& arc: out_arcs[v]) {
+            remove_v(in_arcs[arc.vertex]);
+            ++nb_contracted_neighbors[arc.vertex];
+        }
+        for (const auto& arc: in_arcs[v]) {
+            remove_v(out_arcs[arc.vertex]);
+            ++nb_contracted_neighbors[arc.vertex];
+        }
+        contracted[v] = true;
+    }
+};
+
+/// flatten the arcs of each vertex in offsets/arcs
+void flatten(std::vector<std::vector<Arc>>& arcs_by_vertex,
+             std::vector<uint32_t>& offsets, std::vector<Arc>& arcs) {
+    offsets.clear();
+    arcs.clear();
+    for (auto& vertex_arcs: arcs_by_vertex) {
+        offsets.push_back(arcs.size());
+        arcs.insert(arcs.end(), vertex_arcs.begin(), vertex_arcs.end());
+        std::vector<Arc>().swap(vertex_arcs);
+    }
+    offsets.push_back(arcs.size());
+}
+
+struct Label {
+    Weight weight;
+    /// previous vertex of the search
+    uint32_t parent;
+    /// middle of the arc between parent and the vertex
+    uint32_t middle;
+};
+
+typedef std::unordered_map<uint32_t, Label> Labels;
+
+/// upward dijkstra on offsets/arcs, returns the settled vertices with their labels
+Labels upward_search(const std::vector<uint32_t>& offsets, const std::vector<Arc>& arcs,
+                     const std::vector<ContractionHierarchy::Source>& sources,
+                     Weight max_weight,
+                     const std::function<Weight(uint32_t, Weight)>& on_settle) {
+    Labels labels, settled;
+    Queue queue;
+    for (const auto& source: sources) {
+        auto it = labels.find(source.vertex);
+        if (it != labels.end() && it->second.weight <= source.weight) { continue; }
+        labels[source.vertex] = {source.weight, ContractionHierarchy::invalid_vertex,
+                                 ContractionHierarchy::invalid_vertex};
+        queue.push({source.weight, source.vertex});
+    }
+    while (! queue.empty()) {
+        const auto item = queue.top();
+        queue.pop();
+        if (item.first > max_weight) { break; }
+        const auto u = item.second;
+        const auto& label = labels[u];
+        if (item.first > label.weight || settled.count(u)) { continue; }
+        settled[u] = label;
+        // on_settle can lower the bound, when a path has already been found
+        max_weight = std::min(max_weight, on_settle(u, item.first));
+        for (auto i = offsets[u]; i < offsets[u + 1]; ++i) {
+            const auto& arc = arcs[i];
+            const auto dist = add(item.first, arc.weight);
+            auto it = labels.find(arc.vertex);
+            if (it != labels.end() && it->second.weight <= dist) { continue; }
+            labels[arc.vertex] = {dist, u, arc.middle};
+            queue.push({dist, arc.vertex});
+        }
+    }
+    return settled;
+}
+
+}
+
+ContractionHierarchy::ContractionHierarchy(size_t nb_vertices, const std::vector<InputArc>& arcs,
+                                           size_t max_settled_witness) {
+    ContractionBuilder builder(nb_vertices, max_settled_witness);
+    for (const auto& arc: arcs) {
+        if (arc.source == arc.target) { continue; }
+        builder.add_arc(arc.source, arc.target, arc.weight, invalid_vertex);
+    }
+
+    typedef std::pair<int, uint32_t> PriorityItem;
+    std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+    for (uint32_t v = 0; v < nb_vertices; ++v) {
+        queue.push({builder.priority(v), v});
+    }
+
+    ranks.assign(nb_vertices, 0);
+    std::vector<std::vector<Arc>> forward(nb_vertices), backward(nb_vertices);
+    uint32_t rank = 0;
+    while (! queue.empty()) {
+        const auto v = queue.top().second;
+        queue.pop();
+        // lazy update: the priority may have changed since its insertion
+        const auto priority = builder.priority(v);
+        if (! queue.empty() && priority > queue.top().first) {
+            queue.push({priority, v});
+            continue;
+        }
+        // the remaining neighbors will all be contracted later, so they are higher
+        forward[v] = builder.out_arcs[v];
+        backward[v] = builder.in_arcs[v];
+        builder.contract(v);
+        ranks[v] = rank++;
+    }
+
+    flatten(forward, forward_offsets, forward_arcs);
+    flatten(backward, backward_offsets, backward_arcs);
+}
+
+void ContractionHierarchy::unpack(uint32_t from, uint32_t to, uint32_t middle,
+                                  std::vector<uint32_t>& path) const {
+    if (middle == invalid_vertex) {
+        path.push_back(to);
+        return;
+    }
+    // the shortcut has been built from the arcs from -> middle and middle -> to,
+    // kept by middle since from and to are higher
+    const auto find_arc = [&](const std::vector<uint32_t>& offsets, const std::vector<Arc>& arcs,
+                              uint32_t vertex) {
+        for (auto i = offsets[middle]; i < offsets[middle + 1]; ++i) {
+            if (arcs[i].vertex == vertex) { return arcs[i].middle; }
+        }
+        throw navitia::exception("contraction hierarchy: unable to unpack a shortcut");
+    };
+    unpack(from, middle, find_arc(backward_offsets, backward_arcs, from), path);
+    unpack(middle, to, find_arc(forward_offsets, forward_arcs, to), path);
+}
+
+std::vector<std::vector<uint32_t>>
+ContractionHierarchy::one_to_many(const std::vector<Source>& sources,
+                                  const std::vector<uint32_t>& targets,
+                                  Weight max_weight) const {
+    std::vector<std::vector<uint32_t>> paths(targets.size());
+    const auto forward_labels = upward_search(forward_offsets, forward_arcs, sources, max_weight,
+                                              [&](uint32_t, Weight) { return max_weight; });
+
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (targets[i] >= nb_vertices()) { continue; }
+        Weight best = inf;
+        uint32_t meeting = invalid_vertex;
+        const auto on_settle = [&](uint32_t v, Weight weight) {
+            const auto it = forward_labels.find(v);
+            if (it != forward_labels.end() && add(it->second.weight, weight) < best) {
+                best = add(it->second.weight, weight);
+                meeting = v;
+            }
+            return best;
+        };
+        const auto backward_labels = upward_search(backward_offsets, backward_arcs,
+                                                   {{targets[i], 0}}, max_weight, on_settle);
+        if (meeting == invalid_vertex || best > max_weight) { continue; }
+
+        // from the source to the meeting vertex
+        std::vector<const Labels::value_type*> upward;
+        for (auto v = meeting; v != invalid_vertex;) {
+            const auto& label = *forward_labels.find(v);
+            upward.push_back(&label);
+            v = label.second.parent;
+        }
+        auto& path = paths[i];
+        path.push_back(upward.back()->first);
+        for (auto it = upward.rbegin() + 1; it != upward.rend(); ++it) {
+            const auto& label = (*it)->second;
+            unpack(label.parent, (*it)->first, label.middle, path);
+        }
+        // then down to the target, the backward parents lead to the target
+        for (auto v = meeting; v != targets[i];) {
+            const auto& label = backward_labels.find(v)->second;
+            unpack(v, label.parent, label.middle, path);
+            v = label.parent;
+        }
+    }
+    return paths;
+}
+
+ContractionHierarchy::Buckets
+ContractionHierarchy::build_buckets(const std::vector<uint32_t>& targets, Weight max_weight) const {
+    Buckets buckets;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (targets[i] >= nb_vertices()) { continue; }
+        upward_search(backward_offsets, backward_arcs, {{targets[i], 0}}, max_weight,
+                      [&](uint32_t v, Weight weight) {
+            buckets[v].push_back({uint32_t(i), weight});
+            return max_weight;
+        });
+    }
+    return buckets;
+}
+
+std::vector<ContractionHierarchy::Weight>
+ContractionHierarchy::bucket_weights(const Buckets& buckets,
+                                     size_t nb_targets,
+                                     const std::vector<Source>& sources,
+                                     Weight max_weight) const {
+    std::vector<Weight> weights(nb_targets, inf);
+    upward_search(forward_offsets, forward_arcs, sources, max_weight,
+                  [&](uint32_t v, Weight weight) {
+        const auto it = buckets.find(v);
+        if (it == buckets.end()) { return max_weight; }
+        for (const auto& target: it->second) {
+            const auto total = add(weight, target.second);
+            if (total <= max_weight && total < weights[target.first]) {
+                weights[target.first] = total;
+            }
+        }
+        return max_weight;
+    });
+    return weights;
+}
+
+}}
@@ -0,0 +1,143 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#pragma once
+#include "utils/serialization_vector.h"
+#include <boost/serialization/serialization.hpp>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace navitia { namespace georef {
+
+/** Contraction hierarchy over the graph of a transportation mode
+ *
+ * The vertices are contracted one after another (the order is their rank),
+ * adding shortcuts between their neighbors when no witness path exists.
+ * A shortest path is then found by an upward search from the source and an
+ * upward search on the reversed graph from the target, both only using the
+ * arcs to higher ranked vertices: they meet on the highest vertex of the path.
+ *
+ * The weights are the durations (in ticks) of the edges at the default speed
+ * of the graph, the speed factor being applied by the caller.
+ */
+struct ContractionHierarchy {
+    typedef uint32_t Weight;
+    static const uint32_t invalid_vertex = std::numeric_limits<uint32_t>::max();
+    static const Weight inf = std::numeric_limits<Weight>::max();
+
+    /// edge of the graph to contract
+    struct InputArc {
+        uint32_t source;
+        uint32_t target;
+        Weight weight;
+    };
+
+    struct Arc {
+        /// target of a forward arc, source of a backward arc
+        uint32_t vertex = invalid_vertex;
+        Weight weight = inf;
+        /// vertex contracted to create this shortcut, invalid_vertex for an edge of the graph
+        uint32_t middle = invalid_vertex;
+
+        template<class Archive> void serialize(Archive & ar, const unsigned int) {
+            ar & vertex & weight & middle;
+        }
+    };
+
+    /// starting point of a query with its initial weight
+    struct Source {
+        uint32_t vertex;
+        Weight weight;
+    };
+
+    /// rank of each vertex in the contraction order
+    std::vector<uint32_t> ranks;
+
+    /// arcs leaving v toward higher ranked vertices are
+    /// forward_arcs[forward_offsets[v]] to forward_arcs[forward_offsets[v + 1]]
+    std::vector<uint32_t> forward_offsets;
+    std::vector<Arc> forward_arcs;
+
+    /// arcs entering v from higher ranked vertices, stored the same way
+    std::vector<uint32_t> backward_offsets;
+    std::vector<Arc> backward_arcs;
+
+    ContractionHierarchy() {}
+
+    /** Contract the graph made of the arcs
+     *
+     * max_settled_witness bounds the local searches looking for witness paths,
+     * a lower bound is faster to build but adds useless shortcuts
+     */
+    ContractionHierarchy(size_t nb_vertices, const std::vector<InputArc>& arcs,
+                         size_t max_settled_witness = 500);
+
+    size_t nb_vertices() const { return ranks.size(); }
+    size_t nb_arcs() const { return forward_arcs.size() + backward_arcs.size(); }
+
+    /** Shortest paths from the closest source to each target
+     *
+     * Only the paths lighter than max_weight are found. For each target,
+     * returns the unpacked vertices of its path, from the source to the
+     * target, or an empty vector if it has not been reached.
+     * The forward search is shared by all the targets.
+     */
+    std::vector<std::vector<uint32_t>> one_to_many(const std::vector<Source>& sources,
+                                                   const std::vector<uint32_t>& targets,
+                                                   Weight max_weight = inf) const;
+
+    /// for each vertex reached by the backward searches of a many to many,
+    /// the index of the targets reached with their weight
+    typedef std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, Weight>>> Buckets;
+
+    /** Backward searches from the targets of a many to many, done once for all the sources */
+    Buckets build_buckets(const std::vector<uint32_t>& targets, Weight max_weight = inf) const;
+
+    /** Weight from the closest source to each target of the buckets
+     *
+     * A forward search from the sources scans the buckets of the vertices it settles.
+     * The targets not reached within max_weight are at inf.
+     */
+    std::vector<Weight> bucket_weights(const Buckets& buckets,
+                                       size_t nb_targets,
+                                       const std::vector<Source>& sources,
+                                       Weight max_weight = inf) const;
+
+    template<class Archive> void serialize(Archive & ar, const unsigned int) {
+        ar & ranks & forward_offsets & forward_arcs & backward_offsets & backward_arcs;
+    }
+
+private:
+    /// append to path the vertices of the arc from -> to, without from
+    void unpack(uint32_t from, uint32_t to, uint32_t middle, std::vector<uint32_t>& path) const;
+};
+
+}}
@@ -29,6 +29,7 @@ www.navitia.io
 */
 
 #include "georef.h"
+#include "segment_distance.h"
 
 #include "utils/logger.h"
 #include "utils/functions.h"
@@ -40,7 +41,12 @@ www.navitia.io
 #include <boost/range/algorithm/sort.hpp>
 #include <boost/range/algorithm/lexicographical_compare.hpp>
 #include <boost/math/constants/constants.hpp>
+#include <boost/optional.hpp>
 #include <array>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <thread>
 #include <unordered_map>
 
 using navitia::type::idx_t;
@@ -242,8 +248,8 @@ type::Mode_e GeoRef::get_mode(vertex_t vertex) const {
 }
 
 PathItem::TransportCaracteristic GeoRef::get_caracteristic(edge_t edge) const {
-    auto source_mode = get_mode(boost::source(edge, graph));
-    auto target_mode = get_mode(boost::target(edge, graph));
+    auto source_mode = get_mode(boost::source(edge, *graph));
+    auto target_mode = get_mode(boost::target(edge, *graph));
 
     if (source_mode == target_mode) {
         switch (source_mode) {
@@ -299,9 +305,7 @@ ProjectionData::ProjectionData(const type::GeographicalCoord & coord, const GeoR
     try {
         edge = sn.nearest_edge(coord, prox);
     } catch(proximitylist::NotFound) {
-        found = false;
-        vertices[Direction::Source] = std::numeric_limits<vertex_t>::max();
-        vertices[Direction::Target] = std::numeric_limits<vertex_t>::max();
+        init_not_found();
     }
 
     if(found) {
@@ -315,9 +319,7 @@ ProjectionData::ProjectionData(const type::GeographicalCoord & coord, const GeoR
     try {
         edge = sn.nearest_edge(coord, prox, offset, horizon);
     } catch(proximitylist::NotFound) {
-        found = false;
-        vertices[Direction::Source] = std::numeric_limits<vertex_t>::max();
-        vertices[Direction::Target] = std::numeric_limits<vertex_t>::max();
+        init_not_found();
     }
 
     if(found) {
@@ -325,15 +327,22 @@ ProjectionData::ProjectionData(const type::GeographicalCoord & coord, const GeoR
     }
 }
 
+void ProjectionData::init_not_found() {
+    found = false;
+    vertices[Direction::Source] = std::numeric_limits<vertex_t>::max();
+    vertices[Direction::Target] = std::numeric_limits<vertex_t>::max();
+}
+
 void ProjectionData::init(const type::GeographicalCoord & coord, const GeoRef & sn, edge_t nearest_edge) {
     // We retrieve both vertices of nearest_edge from the graph to get their coordinates
-    vertices[Direction::Source] = boost::source(nearest_edge, sn.graph);
-    vertices[Direction::Target] = boost::target(nearest_edge, sn.graph);
-    const type::GeographicalCoord& vertex1_coord = sn.graph[vertices[Direction::Source]].coord;
-    const type::GeographicalCoord& vertex2_coord = sn.graph[vertices[Direction::Target]].coord;
+    const auto& graph = *sn.graph;
+    vertices[Direction::Source] = boost::source(nearest_edge, graph);
+    vertices[Direction::Target] = boost::target(nearest_edge, graph);
+    const type::GeographicalCoord& vertex1_coord = graph[vertices[Direction::Source]].coord;
+    const type::GeographicalCoord& vertex2_coord = graph[vertices[Direction::Target]].coord;
     // We project the point on nearest_edge geometry if it exists, on a straight line between vertices otherwise.
     // We store distance from the projected point to each vertex since the pt routing is done from them and not the exact coord.
-    edge = sn.graph[nearest_edge];
+    edge = graph[nearest_edge];
     if(edge.geom_idx != nt::invalid_idx) {
         auto& geom = sn.ways[edge.way_idx]->geoms[edge.geom_idx];
         this->projected = type::project(geom, coord);
@@ -362,34 +371,210 @@ void GeoRef::init() {
     offsets[nt::Mode_e::Walking] = 0;
     offsets[nt::Mode_e::Bss] = 0;
 
+    auto& g = mutable_part(graph);
     //each graph has the same number of vertex
-    nb_vertex_by_mode = boost::num_vertices(graph);
+    nb_vertex_by_mode = boost::num_vertices(g);
 
     //we dupplicate the graph for the bike and the car
     for (nt::Mode_e mode : {nt::Mode_e::Bike, nt::Mode_e::Car}) {
-        offsets[mode] = boost::num_vertices(graph);
+        offsets[mode] = boost::num_vertices(g);
         for (vertex_t v = 0; v < nb_vertex_by_mode; ++v){
-            boost::add_vertex(graph[v], graph);
+            boost::add_vertex(g[v], g);
+        }
+    }
+}
+
+void GeoRef::build_mode_graphs() {
+    const auto& g = *graph;
+    const auto nb_vertices = boost::num_vertices(g);
+    auto new_mode_graphs = boost::make_shared<flat_enum_map<nt::Mode_e, ModeGraph>>();
+    for (const auto mode: {nt::Mode_e::Walking, nt::Mode_e::Bike, nt::Mode_e::Car, nt::Mode_e::Bss}) {
+        const auto& acceptable_modes = allowed_transportation_mode[mode];
+        const auto is_acceptable = [&](vertex_t v) {
+            return acceptable_modes[nt::Mode_e(v / nb_vertex_by_mode)];
+        };
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        std::vector<ModeGraphEdge> edge_properties;
+        // the out edges are kept in the same order as in the graph, so
+        // the dijkstra explores them as on the graph
+        for (vertex_t u = 0; nb_vertex_by_mode != 0 && u < nb_vertices; ++u) {
+            if (! is_acceptable(u)) { continue; }
+            BOOST_FOREACH(edge_t e, boost::out_edges(u, g)) {
+                const auto v = boost::target(e, g);
+                if (! is_acceptable(v)) { continue; }
+                edges.emplace_back(u, v);
+                edge_properties.push_back({g[e].duration});
+            }
+        }
+        (*new_mode_graphs)[mode] = ModeGraph(boost::edges_are_sorted, edges.begin(), edges.end(),
+                                             edge_properties.begin(), nb_vertices);
+    }
+    mode_graphs = std::move(new_mode_graphs);
+}
+
+static std::vector<ContractionHierarchy::InputArc> mode_graph_arcs(const ModeGraph& mode_graph) {
+    std::vector<ContractionHierarchy::InputArc> arcs;
+    arcs.reserve(boost::num_edges(mode_graph));
+    BOOST_FOREACH(const auto& e, boost::edges(mode_graph)) {
+        arcs.push_back({uint32_t(boost::source(e, mode_graph)),
+                        uint32_t(boost::target(e, mode_graph)),
+                        uint32_t(mode_graph[e].duration.ticks())});
+    }
+    return arcs;
+}
+
+void GeoRef::build_contraction_hierarchies(const std::vector<nt::Mode_e>& modes) {
+    build_mode_graphs();
+    auto& hierarchies = mutable_part(contraction_hierarchies);
+    for (const auto mode: modes) {
+        const auto& mode_graph = (*mode_graphs)[mode];
+        hierarchies[mode] = ContractionHierarchy(boost::num_vertices(mode_graph),
+                                                 mode_graph_arcs(mode_graph));
+    }
+}
+
+void GeoRef::build_goal_directed_search(const DirectPathParams& params) {
+    if (boost::num_vertices((*mode_graphs)[nt::Mode_e::Walking]) != boost::num_vertices(*graph)) {
+        build_mode_graphs();
+    }
+    direct_path_algorithms = params.algorithms;
+    auto& bounds = mutable_part(goal_directed_bounds);
+    auto& reverse_graphs = mutable_part(reverse_mode_graphs);
+    for (const auto mode: {nt::Mode_e::Walking, nt::Mode_e::Bike, nt::Mode_e::Car, nt::Mode_e::Bss}) {
+        bounds[mode] = GoalDirectedBounds();
+        reverse_graphs[mode] = ModeGraph();
+        if (params.algorithms[mode] == DirectPathAlgorithm::Dijkstra) { continue; }
+
+        const auto& mode_graph = (*mode_graphs)[mode];
+        const auto arcs = mode_graph_arcs(mode_graph);
+        // the fastest arc gives the crow fly bound, with a margin for the rounding of the distances
+        double max_speed = 0;
+        for (const auto& arc: arcs) {
+            const auto distance = (*graph)[arc.source].coord.distance_to((*graph)[arc.target].coord);
+            if (arc.weight == 0) {
+                if (distance > 0) { max_speed = std::numeric_limits<double>::infinity(); }
+            } else {
+                max_speed = std::max(max_speed, distance / arc.weight);
+            }
+        }
+        bounds[mode] = GoalDirectedBounds(boost::num_vertices(mode_graph), arcs,
+                                          max_speed * 1.001, params.nb_landmarks);
+
+        if (params.algorithms[mode] == DirectPathAlgorithm::BidirectionalAStar) {
+            // the edges are reversed in the order of their targets, keeping the order of the out edges
+            std::vector<ModeGraphEdge> properties;
+            BOOST_FOREACH(const auto& e, boost::edges(mode_graph)) {
+                properties.push_back(mode_graph[e]);
+            }
+            std::vector<std::pair<uint32_t, uint32_t>> edges;
+            std::vector<ModeGraphEdge> edge_properties;
+            std::vector<size_t> order(arcs.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                return arcs[a].target < arcs[b].target;
+            });
+            for (const auto i: order) {
+                edges.emplace_back(arcs[i].target, arcs[i].source);
+                edge_properties.push_back(properties[i]);
+            }
+            reverse_graphs[mode] = ModeGraph(boost::edges_are_sorted, edges.begin(), edges.end(),
+                                             edge_properties.begin(), boost::num_vertices(mode_graph));
+        }
+        LOG4CPLUS_INFO(log4cplus::Logger::getInstance("log"), "goal directed search of mode " << int(mode)
+                       << ": " << bounds[mode].landmarks.size() << " landmarks, max speed "
+                       << max_speed << " m/tick");
+    }
+}
+
+const ContractionHierarchy* GeoRef::get_contraction_hierarchy(nt::Mode_e mode) const {
+    const auto& ch = (*contraction_hierarchies)[mode];
+    if (ch.nb_vertices() == 0 || ch.nb_vertices() != boost::num_vertices(*graph)) {
+        return nullptr;
+    }
+    return &ch;
+}
+
+FlatGraph::FlatGraph(const Graph& graph) {
+    const auto nb_vertices = boost::num_vertices(graph);
+    const auto nb_edges = boost::num_edges(graph);
+    lons.reserve(nb_vertices);
+    lats.reserve(nb_vertices);
+    out_edges_offsets.reserve(nb_vertices + 1);
+    targets.reserve(nb_edges);
+    way_idxs.reserve(nb_edges);
+    geom_idxs.reserve(nb_edges);
+    durations.reserve(nb_edges);
+    for (vertex_t v = 0; v < nb_vertices; ++v) {
+        lons.push_back(graph[v].coord.lon());
+        lats.push_back(graph[v].coord.lat());
+        out_edges_offsets.push_back(targets.size());
+        BOOST_FOREACH(edge_t e, boost::out_edges(v, graph)) {
+            const auto& edge = graph[e];
+            targets.push_back(boost::target(e, graph));
+            way_idxs.push_back(edge.way_idx);
+            geom_idxs.push_back(edge.geom_idx);
+            durations.push_back(edge.duration.ticks());
+        }
+    }
+    out_edges_offsets.push_back(targets.size());
+}
+
+void FlatGraph::fill_graph(Graph& graph) const {
+    assert(boost::num_vertices(graph) == 0);
+    for (size_t v = 0; v < lons.size(); ++v) {
+        boost::add_vertex(Vertex(nt::GeographicalCoord(lons[v], lats[v])), graph);
+    }
+    for (vertex_t v = 0; v + 1 < out_edges_offsets.size(); ++v) {
+        for (auto i = out_edges_offsets[v]; i < out_edges_offsets[v + 1]; ++i) {
+            Edge edge;
+            edge.way_idx = way_idxs[i];
+            edge.geom_idx = geom_idxs[i];
+            // the duration is rebuilt from its ticks (tenths of second)
+            edge.duration = navitia::time_duration(0, 0, 0, durations[i]);
+            boost::add_edge(v, targets[i], edge, graph);
         }
     }
 }
 
+void GeoRef::copy_unlinked_from(const GeoRef& other) {
+    way_map = other.way_map;
+    graph = other.graph;
+    offsets = other.offsets;
+    fl_admin = other.fl_admin;
+    fl_way = other.fl_way;
+    pl = other.pl;
+    projected_stop_points = other.projected_stop_points;
+    admin_map = other.admin_map;
+    fl_poi = other.fl_poi;
+    synonyms = other.synonyms;
+    ghostwords = other.ghostwords;
+    poi_proximity_list = other.poi_proximity_list;
+    nb_vertex_by_mode = other.nb_vertex_by_mode;
+    mode_graphs = other.mode_graphs;
+    contraction_hierarchies = other.contraction_hierarchies;
+    direct_path_algorithms = other.direct_path_algorithms;
+    goal_directed_bounds = other.goal_directed_bounds;
+    reverse_mode_graphs = other.reverse_mode_graphs;
+}
+
 void GeoRef::build_proximity_list(){
-    pl.clear();
+    auto vertex_list = boost::make_shared<proximitylist::ProximityList<vertex_t>>();
 
     //do not build the proximitylist with the edge of other transportation mode than walking (and walking HAS to be the first graph)
     for(vertex_t v = 0; v < nb_vertex_by_mode; ++v){
-        pl.add(graph[v].coord, v);
+        vertex_list->add((*graph)[v].coord, v);
     }
 
-    pl.build();
+    vertex_list->build();
+    pl = std::move(vertex_list);
 
-    poi_proximity_list.clear();
+    auto poi_list = boost::make_shared<proximitylist::ProximityList<type::idx_t>>();
 
     for(const POI *poi : pois) {
-        poi_proximity_list.add(poi->coord, poi->idx);
+        poi_list->add(poi->coord, poi->idx);
     }
-    poi_proximity_list.build();
+    poi_list->build();
+    poi_proximity_list = std::move(poi_list);
 }
 
 static const Admin* find_city_admin(const std::vector<Admin*>& admins) {
@@ -400,12 +585,14 @@ static const Admin* find_city_admin(const std::vector<Admin*>& admins) {
     return nullptr;
 }
 
-void GeoRef::build_autocomplete_list(){
-    int pos = -1;
-    fl_way.clear();
-    for (Way* way: ways) {
-        ++pos;
-        if (way->name.empty()) { continue; }
+void GeoRef::build_autocomplete_list(size_t nb_threads){
+    typedef std::pair<std::string, nt::idx_t> str_position;
+    typedef autocomplete::Autocomplete<unsigned int> autocomplete_t;
+
+    auto way_list = boost::make_shared<autocomplete_t>(nt::Type_e::Way);
+    way_list->add_strings(ways.size(), [&](size_t pos) -> str_position {
+        const Way* way = ways[pos];
+        if (way->name.empty()) { return {"", pos}; }
         if (auto admin = find_city_admin(way->admin_list)) {
             // @TODO:
             // For each object admin we have one element in the dictionnary of admins.
@@ -414,30 +601,33 @@ void GeoRef::build_autocomplete_list(){
             // Same way for all address in the admin.
             // After this modification the result found with postal code in search string
             // should contain only this postal code but not others of the admin found.
-            std::string key = way->way_type + " " + way->name + " " + admin->name + " " + admin->postal_codes_to_string();
-            fl_way.add_string(key, pos, this->ghostwords, this->synonyms);
-
+            return {way->way_type + " " + way->name + " " + admin->name + " " + admin->postal_codes_to_string(), pos};
         }
-    }
-    fl_way.build();
+        return {"", pos};
+    }, this->ghostwords, this->synonyms, nb_threads);
+    way_list->build();
+    fl_way = std::move(way_list);
 
-    fl_poi.clear();
     //Autocomplete poi list
-    for(const POI* poi : pois){
-        if (poi->name.empty() || !poi->visible) { continue; }
+    auto poi_list = boost::make_shared<autocomplete_t>(nt::Type_e::POI);
+    poi_list->add_strings(pois.size(), [&](size_t i) -> str_position {
+        const POI* poi = pois[i];
+        if (poi->name.empty() || !poi->visible) { return {"", poi->idx}; }
         std::string key = poi->name;
         if (auto admin = find_city_admin(poi->admin_list)) {
             key += " " + admin->name;
         }
-        fl_poi.add_string(key, poi->idx , this->ghostwords, this->synonyms);
-    }
-    fl_poi.build();
-
-    fl_admin.clear();
-    for(Admin* admin : admins){
-        fl_admin.add_string(admin->name + " " + admin->postal_codes_to_string(), admin->idx , this->ghostwords, this->synonyms);
-    }
-    fl_admin.build();
+        return {key, poi->idx};
+    }, this->ghostwords, this->synonyms, nb_threads);
+    poi_list->build();
+    fl_poi = std::move(poi_list);
+
+    auto admin_list = boost::make_shared<autocomplete_t>(nt::Type_e::Admin);
+    admin_list->add_strings(admins.size(), [&](size_t i) -> str_position {
+        return {admins[i]->name + " " + admins[i]->postal_codes_to_string(), admins[i]->idx};
+    }, this->ghostwords, this->synonyms, nb_threads);
+    admin_list->build();
+    fl_admin = std::move(admin_list);
 }
 
 
@@ -501,21 +691,29 @@ std::vector<nf::Autocomplete<nt::idx_t>::fl_quality> GeoRef::find_ways(const std
         search_str = str;
     }
     if (search_type == 0){
-        to_return = fl_way.find_complete_way(search_str, nbmax, keep_element, ghostwords, *this);
+        to_return = fl_way->find_complete_way(search_str, nbmax, keep_element, ghostwords, *this);
     }else{
-        to_return = fl_way.find_partial_with_pattern(search_str, word_weight, nbmax, keep_element, ghostwords);
+        to_return = fl_way->find_partial_with_pattern(search_str, word_weight, nbmax, keep_element, ghostwords);
     }
 
     /// récupération des coordonnées du numéro recherché pour chaque rue
     for(auto &result_item  : to_return){
        Way * way = this->ways[result_item.idx];
-       result_item.coord = way->nearest_coord(search_number, this->graph);
+       result_item.coord = way->nearest_coord(search_number, *this->graph);
        result_item.house_number = search_number;
     }
 
     return to_return;
 }
 
+// for a given mode, in which layer the stop are projected
+static const flat_enum_map<nt::Mode_e, nt::Mode_e> mode_to_layer {{{
+    nt::Mode_e::Walking, // Walking -> Walking
+    nt::Mode_e::Bike, // Bike -> Bike
+    nt::Mode_e::Walking, // Car -> Walking
+    nt::Mode_e::Walking // Bss -> Walking
+}}};
+
 void GeoRef::project_stop_points(const std::vector<type::StopPoint*> &stop_points) {
    enum class error {
        matched = 0,
@@ -529,13 +727,32 @@ void GeoRef::project_stop_points(const std::vector<type::StopPoint*> &stop_point
    };
    navitia::flat_enum_map<error, int> messages {{{}}};
 
-   this->projected_stop_points.clear();
-   this->projected_stop_points.reserve(stop_points.size());
+   auto projections = boost::make_shared<std::vector<ProjectionByMode>>();
+   projections->reserve(stop_points.size());
 
+   // the stop points are projected once per layer, all together
+   std::vector<type::GeographicalCoord> coords;
+   coords.reserve(stop_points.size());
    for(const type::StopPoint* stop_point : stop_points) {
-       std::pair<GeoRef::ProjectionByMode, bool> pair = project_stop_point(stop_point);
+       coords.push_back(stop_point->coord);
+   }
+   const size_t nb_threads = std::max(std::thread::hardware_concurrency(), 1u);
+   flat_enum_map<nt::Mode_e, std::vector<ProjectionData>> projections_by_layer;
+   for (const auto layer: {nt::Mode_e::Walking, nt::Mode_e::Bike}) {
+       projections_by_layer[layer] = project_coords(coords, offsets[layer], nb_threads);
+   }
 
-       this->projected_stop_points.push_back(pair.first);
+   for(size_t i = 0; i < stop_points.size(); ++i) {
+       const type::StopPoint* stop_point = stop_points[i];
+       std::pair<GeoRef::ProjectionByMode, bool> pair;
+       pair.second = false;
+       for (auto const &mode_layer: mode_to_layer) {
+           const auto& proj = projections_by_layer[mode_layer.second][i];
+           pair.first[mode_layer.first] = proj;
+           pair.second = pair.second || proj.found;
+       }
+
+       projections->push_back(pair.first);
        if (pair.second) {
            messages[error::matched] += 1;
        } else {
@@ -558,6 +775,7 @@ void GeoRef::project_stop_points(const std::vector<type::StopPoint*> &stop_point
            messages[error::matched_car] += 1;
        }
    }
+   projected_stop_points = std::move(projections);
 
    auto log = log4cplus::Logger::getInstance("kraken::type::Data::project_stop_point");
    LOG4CPLUS_DEBUG(log, "Number of stop point projected on the georef network : "
@@ -598,19 +816,11 @@ std::pair<GeoRef::ProjectionByMode, bool> GeoRef::project_stop_point(const type:
     bool one_proj_found = false;
     ProjectionByMode projections;
 
-    // for a given mode, in which layer the stop are projected
-    const flat_enum_map<nt::Mode_e, nt::Mode_e> mode_to_layer {{{
-        nt::Mode_e::Walking, // Walking -> Walking
-        nt::Mode_e::Bike, // Bike -> Bike
-        nt::Mode_e::Walking, // Car -> Walking
-        nt::Mode_e::Walking // Bss -> Walking
-    }}};
-
     for (auto const &mode_layer: mode_to_layer) {
         nt::Mode_e mode = mode_layer.first;
         nt::idx_t offset = offsets[mode_layer.second];
 
-        ProjectionData proj(stop_point->coord, *this, offset, this->pl);
+        ProjectionData proj(stop_point->coord, *this, offset, *this->pl);
         projections[mode] = proj;
         if(proj.found)
             one_proj_found = true;
@@ -624,7 +834,7 @@ vertex_t GeoRef::nearest_vertex(const type::GeographicalCoord & coordinates, con
 }
 
 edge_t GeoRef::nearest_edge(const type::GeographicalCoord & coordinates) const {
-    return this->nearest_edge(coordinates, this->pl);
+    return this->nearest_edge(coordinates, *this->pl);
 }
 
 static bool is_sn_edge(const GeoRef& georef, const edge_t& e) {
@@ -638,38 +848,122 @@ static bool is_sn_edge(const GeoRef& georef, const edge_t& e) {
     }
 }
 
-/// Get the nearest_edge with at least one vertex in the graph corresponding to the offset (walking, bike, ...)
-edge_t GeoRef::nearest_edge(const type::GeographicalCoord & coordinates, const proximitylist::ProximityList<vertex_t>& prox, type::idx_t offset, double horizon) const {
-    boost::optional<edge_t> res;
-    float min_dist = 0., cur_dist = 0.;
-    double coslat = ::cos(coordinates.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
-    for (const auto pair_coord : prox.find_within(coordinates, horizon)) {
-        //we increment the index to get the vertex in the other graph
-        const auto u = pair_coord.first + offset;
-
-        BOOST_FOREACH (edge_t e, boost::out_edges(u, graph)) {
-            const auto v = target(e, graph);
-            if (! is_sn_edge(*this, e)) { continue; }
-            const auto edge = graph[e];
-            // If there is a geometry for this edge get the projected point to get the distance
-            if(edge.geom_idx != nt::invalid_idx) {
-                auto projected = type::project(ways[edge.way_idx]->geoms[edge.geom_idx], coordinates);
-                cur_dist = coordinates.approx_sqr_distance(projected,  coslat);
+namespace {
+/** Search of the nearest street network edge, keeping its buffers between the searches
+ *
+ * The candidates are the out edges of the vertices within the horizon, in
+ * the order of the distances of the vertices. The distances to the edges
+ * without geometry are computed all together by approx_segment_distances.
+ */
+struct NearestEdgeFinder {
+    const GeoRef& geo_ref;
+    std::vector<edge_t> edges;
+    std::vector<float> distances;
+    // for each edge, the index of its segment if it has no geometry
+    std::vector<size_t> segment_indexes;
+    Segments segments;
+    std::vector<float> segment_distances;
+
+    static constexpr size_t no_segment = std::numeric_limits<size_t>::max();
+
+    explicit NearestEdgeFinder(const GeoRef& geo_ref): geo_ref(geo_ref) {}
+
+    boost::optional<edge_t> operator()(const type::GeographicalCoord& coordinates,
+                                       const proximitylist::ProximityList<vertex_t>& prox,
+                                       type::idx_t offset,
+                                       double horizon) {
+        const auto& graph = *geo_ref.graph;
+        edges.clear();
+        distances.clear();
+        segment_indexes.clear();
+        segments.clear();
+        double coslat = ::cos(coordinates.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
+        for (const auto pair_coord : prox.find_within(coordinates, horizon)) {
+            //we increment the index to get the vertex in the other graph
+            const auto u = pair_coord.first + offset;
+
+            BOOST_FOREACH (edge_t e, boost::out_edges(u, graph)) {
+                if (! is_sn_edge(geo_ref, e)) { continue; }
+                const auto& edge = graph[e];
+                edges.push_back(e);
+                // If there is a geometry for this edge get the projected point to get the distance
+                if (edge.geom_idx != nt::invalid_idx) {
+                    auto projected = type::project(geo_ref.ways[edge.way_idx]->geoms[edge.geom_idx], coordinates);
+                    distances.push_back(coordinates.approx_sqr_distance(projected, coslat));
+                    segment_indexes.push_back(no_segment);
+                } else {
+                    distances.push_back(0.);
+                    segment_indexes.push_back(segments.size());
+                    segments.push_back(graph[u].coord, graph[target(e, graph)].coord);
+                }
             }
-            else {
-                cur_dist = coordinates.approx_project(graph[u].coord, graph[v].coord, coslat).second;
+        }
+        if (edges.empty()) { return boost::none; }
+
+        segment_distances.resize(segments.size());
+        approx_segment_distances(coordinates, coslat, segments, segment_distances.data());
+        size_t best = 0;
+        for (size_t i = 0; i < edges.size(); ++i) {
+            if (segment_indexes[i] != no_segment) {
+                distances[i] = segment_distances[segment_indexes[i]];
             }
-            if (!res || cur_dist < min_dist) {
-                min_dist = cur_dist;
-                res = e;
+            // strictly less: the first of the nearest edges is kept
+            if (distances[i] < distances[best]) {
+                best = i;
             }
         }
+        return edges[best];
     }
+};
+constexpr size_t NearestEdgeFinder::no_segment;
+} // anonymous namespace
+
+/// Get the nearest_edge with at least one vertex in the graph corresponding to the offset (walking, bike, ...)
+edge_t GeoRef::nearest_edge(const type::GeographicalCoord & coordinates, const proximitylist::ProximityList<vertex_t>& prox, type::idx_t offset, double horizon) const {
+    NearestEdgeFinder find_nearest_edge(*this);
+    const auto res = find_nearest_edge(coordinates, prox, offset, horizon);
     if (res) { return *res; }
     throw proximitylist::NotFound();
 
 }
 
+std::vector<ProjectionData> GeoRef::project_coords(const std::vector<type::GeographicalCoord>& coords,
+                                                   type::idx_t offset,
+                                                   size_t nb_threads,
+                                                   double horizon) const {
+    ThreadPool pool(nb_threads);
+    return project_coords(coords, offset, pool, nb_threads, horizon);
+}
+
+std::vector<ProjectionData> GeoRef::project_coords(const std::vector<type::GeographicalCoord>& coords,
+                                                   type::idx_t offset,
+                                                   ThreadPool& pool,
+                                                   size_t nb_threads,
+                                                   double horizon) const {
+    std::vector<ProjectionData> projections(coords.size());
+    // the coordinates are given to the threads by chunks, not to share the counter too often
+    const size_t chunk_size = 64;
+    std::atomic<size_t> next_chunk{0};
+    const auto project_chunks = [&]() {
+        NearestEdgeFinder find_nearest_edge(*this);
+        for (size_t begin = next_chunk++ * chunk_size; begin < coords.size(); begin = next_chunk++ * chunk_size) {
+            for (size_t i = begin; i < std::min(begin + chunk_size, coords.size()); ++i) {
+                const auto edge = find_nearest_edge(coords[i], *pl, offset, horizon);
+                if (edge) {
+                    projections[i].found = true;
+                    projections[i].init(coords[i], *this, *edge);
+                } else {
+                    projections[i].init_not_found();
+                }
+            }
+        }
+    };
+    const size_t nb_chunks = (coords.size() + chunk_size - 1) / chunk_size;
+    const size_t nb_jobs = std::min({nb_threads, pool.nb_threads(), nb_chunks});
+    pool.run(std::max(nb_jobs, size_t(1)), [&](size_t) { project_chunks(); });
+    return projections;
+}
+
 std::pair<int, const Way*> GeoRef::nearest_addr(const type::GeographicalCoord& coord) const {
     const auto& filter = [](const Way& w){return w.name.empty();};
     return nearest_addr(coord, filter);
@@ -680,12 +974,13 @@ std::pair<int, const Way*> GeoRef::nearest_addr(const type::GeographicalCoord& c
     const std::function<bool(const Way&)>& filter) const {
     // first, we collect each ways with its distance to the coord
     std::map<const Way*, double> way_dist;
-    for (const auto& pair_coord: pl.find_within(coord)) {
-        BOOST_FOREACH (edge_t e, boost::out_edges(pair_coord.first, graph)) {
-            const Way* w = ways[graph[e].way_idx];
+    const auto& g = *graph;
+    for (const auto& pair_coord: pl->find_within(coord)) {
+        BOOST_FOREACH (edge_t e, boost::out_edges(pair_coord.first, g)) {
+            const Way* w = ways[g[e].way_idx];
             if (filter(*w)) { continue; }
             if (way_dist.count(w) == 0) {
-                way_dist[w] = coord.distance_to(w->projected_centroid(graph));
+                way_dist[w] = coord.distance_to(w->projected_centroid(g));
             }
         }
     }
@@ -719,17 +1014,18 @@ std::pair<int, const Way*> GeoRef::nearest_addr(const type::GeographicalCoord& c
 //get the minimum distance and the vertex to start from between 2 edges
 static std::tuple<float, vertex_t, vertex_t>
 get_min_distance(const GeoRef& geo_ref, const type::GeographicalCoord &coord, edge_t walking_e, edge_t biking_e) {
-    vertex_t source_a_idx = source(walking_e, geo_ref.graph);
-    Vertex source_a = geo_ref.graph[source_a_idx];
+    const Graph& graph = *geo_ref.graph;
+    vertex_t source_a_idx = source(walking_e, graph);
+    Vertex source_a = graph[source_a_idx];
 
-    vertex_t target_a_idx = target(walking_e, geo_ref.graph);
-    Vertex target_a = geo_ref.graph[target_a_idx];
+    vertex_t target_a_idx = target(walking_e, graph);
+    Vertex target_a = graph[target_a_idx];
 
-    vertex_t source_b_idx = source(biking_e, geo_ref.graph);
-    Vertex source_b = geo_ref.graph[source_b_idx];
+    vertex_t source_b_idx = source(biking_e, graph);
+    Vertex source_b = graph[source_b_idx];
 
-    vertex_t target_b_idx = target(biking_e, geo_ref.graph);
-    Vertex target_b = geo_ref.graph[target_b_idx];
+    vertex_t target_b_idx = target(biking_e, graph);
+    Vertex target_b = graph[target_b_idx];
 
     const vertex_t min_a_idx =
         coord.distance_to(source_a.coord) < coord.distance_to(target_a.coord) ? source_a_idx : target_a_idx;
@@ -737,7 +1033,7 @@ get_min_distance(const GeoRef& geo_ref, const type::GeographicalCoord &coord, ed
         coord.distance_to(source_b.coord) < coord.distance_to(target_b.coord) ? source_b_idx : target_b_idx;
 
     return std::make_tuple(
-        geo_ref.graph[min_a_idx].coord.distance_to(geo_ref.graph[min_b_idx].coord),
+        graph[min_a_idx].coord.distance_to(graph[min_b_idx].coord),
         min_a_idx,
         min_b_idx);
 }
@@ -760,16 +1056,17 @@ bool GeoRef::add_bss_edges(const type::GeographicalCoord& coord) {
     vertex_t biking_v = std::get<2>(min_dist);
     time_duration dur_between_edges = seconds(std::get<0>(min_dist) / default_speed[Mode_e::Walking]);
 
+    auto& g = mutable_part(graph);
     navitia::georef::Edge edge;
-    edge.way_idx = graph[nearest_walking_edge].way_idx; //arbitrarily we assume the way is the walking way
+    edge.way_idx = g[nearest_walking_edge].way_idx; //arbitrarily we assume the way is the walking way
 
     // time needed to take the bike + time to walk between the edges
     edge.duration = dur_between_edges + default_time_bss_pickup;
-    add_edge(walking_v, biking_v, edge, graph);
+    add_edge(walking_v, biking_v, edge, g);
 
     // time needed to hang the bike back + time to walk between the edges
     edge.duration = dur_between_edges + default_time_bss_putback;
-    add_edge(biking_v, walking_v, edge, graph);
+    add_edge(biking_v, walking_v, edge, g);
 
     return true;
 }
@@ -793,18 +1090,19 @@ bool GeoRef::add_parking_edges(const type::GeographicalCoord& coord) {
     vertex_t car_v = std::get<2>(min_dist);
     time_duration dur_between_edges = seconds(std::get<0>(min_dist) / default_speed[Mode_e::Walking]);
 
+    auto& g = mutable_part(graph);
     Edge edge;
 
     //arbitrarily we assume the way is the walking way
-    edge.way_idx = graph[nearest_walking_edge].way_idx;
+    edge.way_idx = g[nearest_walking_edge].way_idx;
 
     // time to walk between the edges + time needed to leave the parking
     edge.duration = dur_between_edges + default_time_parking_leave;
-    add_edge(walking_v, car_v, edge, graph);
+    add_edge(walking_v, car_v, edge, g);
 
     // time needed to park the car + time to walk between the edges
     edge.duration = dur_between_edges + default_time_parking_park;
-    add_edge(car_v, walking_v, edge, graph);
+    add_edge(car_v, walking_v, edge, g);
 
     return true;
 }
@@ -32,14 +32,20 @@ www.navitia.io
 #include "autocomplete/autocomplete.h"
 #include "proximity_list/proximity_list.h"
 #include "adminref.h"
+#include "contraction_hierarchy.h"
+#include "goal_directed_search.h"
 #include "utils/exception.h"
 #include "utils/flat_enum_map.h"
+#include "type/thread_pool.h"
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/adj_list_serialize.hpp>
+#include <boost/graph/compressed_sparse_row_graph.hpp>
 #include <boost/serialization/serialization.hpp>
 #include "utils/serialization_vector.h"
 #include <boost/serialization/utility.hpp>
 #include <boost/serialization/set.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
 #include <map>
 #include <set>
 #include <functional>
@@ -112,6 +118,75 @@ typedef boost::graph_traits<Graph>::edge_descriptor edge_t;
 typedef boost::graph_traits<Graph>::edge_iterator edge_iterator;
 
 
+/** Flat representation of the graph, used for its serialization.
+  *
+  * Serializing the boost graph vertex by vertex and edge by edge, with
+  * a duration object per edge, is slow to read.  The graph is thus
+  * stored as arrays of numbers, the out edges of the vertices being
+  * contiguous (compressed sparse row): the out edges of the vertex v
+  * are the ones in [out_edges_offsets[v], out_edges_offsets[v + 1]).
+  */
+struct FlatGraph {
+    std::vector<double> lons;
+    std::vector<double> lats;
+    std::vector<uint32_t> out_edges_offsets;
+    std::vector<uint32_t> targets;
+    std::vector<nt::idx_t> way_idxs;
+    std::vector<nt::idx_t> geom_idxs;
+    std::vector<int32_t> durations; // in ticks of navitia::time_duration
+
+    FlatGraph() {}
+    explicit FlatGraph(const Graph&);
+
+    /// fill the given graph (that must be empty)
+    void fill_graph(Graph&) const;
+
+    template<class Archive> void serialize(Archive & ar, const unsigned int) {
+        ar & lons & lats & out_edges_offsets & targets & way_idxs & geom_idxs & durations;
+    }
+};
+
+template <typename T>
+using map_by_mode = flat_enum_map<type::Mode_e, T>;
+/**
+ * create a map of map of boolean from a map of map of allowed mode
+ * (because it's simpler to define with only the allowed mode, but  more efficient with the boolean masks)
+ */
+inline map_by_mode<map_by_mode<bool>> create_from_allowedlist(map_by_mode<std::vector<nt::Mode_e>> allowed_modes) {
+    map_by_mode<map_by_mode<bool>> res;
+    for (auto modes_pair : allowed_modes) {
+        res[modes_pair.first] = {{{}}}; //force false initialization of all members
+        for (auto mode : modes_pair.second) {
+            res[modes_pair.first][mode] = true;
+        }
+    }
+    return res;
+}
+
+const auto allowed_transportation_mode = create_from_allowedlist({{{
+                                                                {type::Mode_e::Walking}, //for walking, only walking is allowed
+                                                                {type::Mode_e::Bike}, //for biking, only bike
+                                                                {type::Mode_e::Car, type::Mode_e::Walking}, //for car, only car and walking is allowed
+                                                                {type::Mode_e::Walking, type::Mode_e::Bike} //for vls, walking and bike is allowed
+                                                          }}});
+
+
+/// Edge of a ModeGraph, only what the dijkstra reads
+struct ModeGraphEdge {
+    navitia::time_duration duration;
+};
+
+/** Read-only compressed sparse row copy of the graph, restricted to the
+  * vertices a transportation mode can use (see allowed_transportation_mode).
+  *
+  * The vertices keep their index in the Graph, 32 bits indexes and
+  * durations make the out edges of a vertex contiguous and compact.
+  * Built at load time for the dijkstra, the Graph is kept for the
+  * serialization and the geometries of the paths.
+  */
+typedef boost::compressed_sparse_row_graph<boost::directedS, boost::no_property, ModeGraphEdge,
+                                           boost::no_property, uint32_t, uint32_t> ModeGraph;
+
 /** le numéro de la maison :
     il représente un point dans la rue, voie */
 struct HouseNumber{
@@ -204,11 +279,83 @@ struct Path {
     std::deque<PathItem> path_items = {}; //< Liste des voies parcourues
 };
 
-struct ProjectionData;
+struct GeoRef;
+
+/** When given a coordinate, we have to associate it with the street network.
+  *
+  * This structure handle this.
+  *
+  * It contains
+  *   - 2 possible nodes (each end of the edge where the coordinate has been projected)
+  *   - the coordinate of the projection
+  *   - the 2 distances between the projected point and the ends (NOTE, this is not the distance between the coordinate and the ends)
+  *
+  */
+struct ProjectionData {
+
+    /// enum used to acces the nodes and the distances
+    enum class Direction {
+        Source = 0,
+        Target,
+        size
+    };
+    /// 2 possible nodes (each end of the edge where the coordinate has been projected)
+    flat_enum_map<Direction, vertex_t> vertices;
+
+    // The edge we projected on. Needed since we can't be sure to get the right edge with only the source and the target because
+    // of parallel edges.
+    Edge edge;
+
+    /// has the projection been successful?
+    bool found = false;
+
+    /// The coordinate projected on the edge
+    type::GeographicalCoord projected;
+
+    //the original coordinate before projection
+    type::GeographicalCoord real_coord;
+
+    /// Distance between the projected point and the ends
+    flat_enum_map<Direction, double> distances {{{-1, -1}}};
+
+    ProjectionData() {}
+    /// Project the coordinate on the graph
+    ProjectionData(const type::GeographicalCoord & coord, const GeoRef &sn, const proximitylist::ProximityList<vertex_t> &prox);
+    /// Project the coordinate on the graph corresponding to the transportation mode of the offset
+    ProjectionData(const type::GeographicalCoord & coord, const GeoRef &sn, type::idx_t offset, const proximitylist::ProximityList<vertex_t> &prox, double horizon = 500);
+
+    template<class Archive> void serialize(Archive & ar, const unsigned int) {
+        ar & vertices & projected & distances & found & real_coord & edge;
+    }
+
+    void init(const type::GeographicalCoord & coord, const GeoRef & sn, edge_t nearest_edge);
+    /// Mark the projection as not found
+    void init_not_found();
+
+    /// syntaxic sugar
+    vertex_t operator[] (Direction d) const { return vertices[d]; }
+};
 
 struct POI;
 struct POIType;
 
+/** Access to a part of the GeoRef to modify it
+  *
+  * The parts of the GeoRef that the realtime does not modify (the graph and
+  * the indexes) are held by shared_ptr<const> and shared between a GeoRef and
+  * its clones. They are only modified while they are built (by ed2nav, the
+  * load or the tests), and a part is copied first if it is shared, thus a
+  * GeoRef never modifies the parts of another one.
+  */
+template<typename T>
+T& mutable_part(boost::shared_ptr<const T>& part) {
+    if (! part.unique()) {
+        part = boost::make_shared<T>(*part);
+    }
+    // the parts are always created by make_shared<T>, never const
+    return const_cast<T&>(*part);
+}
+
 /** All you need about the street network */
 struct GeoRef {
 
@@ -222,29 +369,38 @@ struct GeoRef {
     std::map<std::string, POIType*> poitype_map;
     std::vector<POI*> pois;
     std::map<std::string, POI*> poi_map;
-    proximitylist::ProximityList<type::idx_t> poi_proximity_list;
+    boost::shared_ptr<const proximitylist::ProximityList<type::idx_t>> poi_proximity_list =
+        boost::make_shared<proximitylist::ProximityList<type::idx_t>>();
     std::vector<Way*> ways;
     std::map<std::string, nt::idx_t> way_map;
     std::map<std::string, nt::idx_t> admin_map;
     std::vector<Admin*> admins;
 
+    // The graph and the indexes below are shared between a GeoRef and its
+    // clones, mutable_part gives access to them to build them
+
     /// Indexe sur les noms de voirie
-    autocomplete::Autocomplete<unsigned int> fl_admin = autocomplete::Autocomplete<unsigned int>(navitia::type::Type_e::Admin);
+    boost::shared_ptr<const autocomplete::Autocomplete<unsigned int>> fl_admin =
+        boost::make_shared<autocomplete::Autocomplete<unsigned int>>(navitia::type::Type_e::Admin);
     /// Indexe sur les noms de voirie
-    autocomplete::Autocomplete<unsigned int> fl_way = autocomplete::Autocomplete<unsigned int>(navitia::type::Type_e::Way);
+    boost::shared_ptr<const autocomplete::Autocomplete<unsigned int>> fl_way =
+        boost::make_shared<autocomplete::Autocomplete<unsigned int>>(navitia::type::Type_e::Way);
 
     /// Indexe sur les pois
-    autocomplete::Autocomplete<unsigned int> fl_poi = autocomplete::Autocomplete<unsigned int>(navitia::type::Type_e::POI);
+    boost::shared_ptr<const autocomplete::Autocomplete<unsigned int>> fl_poi =
+        boost::make_shared<autocomplete::Autocomplete<unsigned int>>(navitia::type::Type_e::POI);
 
     /// Indexe tous les nœuds
-    proximitylist::ProximityList<vertex_t> pl;
+    boost::shared_ptr<const proximitylist::ProximityList<vertex_t>> pl =
+        boost::make_shared<proximitylist::ProximityList<vertex_t>>();
 
     /// for all stop_point, we store it's projection on each graph
     typedef flat_enum_map<nt::Mode_e, ProjectionData> ProjectionByMode;
-    std::vector<ProjectionByMode> projected_stop_points = {};
+    boost::shared_ptr<const std::vector<ProjectionByMode>> projected_stop_points =
+        boost::make_shared<std::vector<ProjectionByMode>>();
 
     /// Graphe pour effectuer le calcul d'itinéraire
-    Graph graph;
+    boost::shared_ptr<const Graph> graph = boost::make_shared<Graph>();
 
     /*
      * We have 3 graphs :
@@ -258,6 +414,33 @@ struct GeoRef {
 
     /// number of vertex by transportation mode
     nt::idx_t nb_vertex_by_mode = 0;
+
+    /// graph of each transportation mode, for the dijkstra, not serialized
+    /// but built at load by build_mode_graphs
+    boost::shared_ptr<const flat_enum_map<nt::Mode_e, ModeGraph>> mode_graphs =
+        boost::make_shared<flat_enum_map<nt::Mode_e, ModeGraph>>();
+
+    /// contraction hierarchy of each transportation mode, only built (by ed2nav)
+    /// for the modes asked, the others are empty
+    boost::shared_ptr<const flat_enum_map<nt::Mode_e, ContractionHierarchy>> contraction_hierarchies =
+        boost::make_shared<flat_enum_map<nt::Mode_e, ContractionHierarchy>>();
+
+    /// algorithm of the direct paths of each mode without contraction hierarchy,
+    /// not serialized, set at load by build_goal_directed_search
+    flat_enum_map<nt::Mode_e, DirectPathAlgorithm> direct_path_algorithms {{{
+        DirectPathAlgorithm::Dijkstra,
+        DirectPathAlgorithm::Dijkstra,
+        DirectPathAlgorithm::Dijkstra,
+        DirectPathAlgorithm::Dijkstra
+    }}};
+
+    /// lower bounds of the A* of the direct paths, only built for the modes using it
+    boost::shared_ptr<const flat_enum_map<nt::Mode_e, GoalDirectedBounds>> goal_directed_bounds =
+        boost::make_shared<flat_enum_map<nt::Mode_e, GoalDirectedBounds>>();
+
+    /// mode graphs with the edges reversed, only built for the modes using the bidirectional A*
+    boost::shared_ptr<const flat_enum_map<nt::Mode_e, ModeGraph>> reverse_mode_graphs =
+        boost::make_shared<flat_enum_map<nt::Mode_e, ModeGraph>>();
     navitia::autocomplete::autocomplete_map synonyms;
     std::set<std::string> ghostwords;
 
@@ -266,27 +449,59 @@ struct GeoRef {
 
     void init();
 
+    /// Build the mode_graphs from the graph, must be called again if the graph is modified
+    void build_mode_graphs();
+
+    /// Contract the mode graphs of the given modes in contraction_hierarchies
+    void build_contraction_hierarchies(const std::vector<nt::Mode_e>& modes);
+
+    /// Build what the direct path algorithms of the params need (bounds, reverse mode graphs)
+    void build_goal_directed_search(const DirectPathParams& params);
+
+    /// contraction hierarchy of the mode, nullptr if it has not been built for this graph
+    const ContractionHierarchy* get_contraction_hierarchy(nt::Mode_e mode) const;
+
     template<class Archive> void save(Archive & ar, const unsigned int) const {
-        ar & ways & way_map & graph & offsets & fl_admin & fl_way & pl & projected_stop_points
-                & admins & admin_map &  pois & fl_poi & poitypes & poitype_map & poi_map & synonyms
-                & ghostwords & poi_proximity_list & nb_vertex_by_mode;
+        const FlatGraph flat_graph(*graph);
+        ar & ways & way_map & flat_graph & offsets & *fl_admin & *fl_way & *pl & *projected_stop_points
+                & admins & admin_map &  pois & *fl_poi & poitypes & poitype_map & poi_map & synonyms
+                & ghostwords & *poi_proximity_list & nb_vertex_by_mode & *contraction_hierarchies;
     }
 
     template<class Archive> void load(Archive & ar, const unsigned int) {
         // La désérialisation d'une boost adjacency list ne vide pas le graphe
         // On avait donc une fuite de mémoire
-        graph.clear();
-        ar & ways & way_map & graph & offsets & fl_admin & fl_way & pl & projected_stop_points
-                & admins & admin_map & pois & fl_poi & poitypes & poitype_map & poi_map & synonyms
-                & ghostwords & poi_proximity_list & nb_vertex_by_mode;
+        auto new_graph = boost::make_shared<Graph>();
+        FlatGraph flat_graph;
+        ar & ways & way_map & flat_graph & offsets & mutable_part(fl_admin) & mutable_part(fl_way)
+                & mutable_part(pl) & mutable_part(projected_stop_points)
+                & admins & admin_map & pois & mutable_part(fl_poi) & poitypes & poitype_map & poi_map & synonyms
+                & ghostwords & mutable_part(poi_proximity_list) & nb_vertex_by_mode
+                & mutable_part(contraction_hierarchies);
+        flat_graph.fill_graph(*new_graph);
+        graph = std::move(new_graph);
+        build_mode_graphs();
     }
     BOOST_SERIALIZATION_SPLIT_MEMBER()
 
+    /** Serialize only the objects that hold pointers to or from the public transport objects.
+      *
+      * Used to clone a Data: those objects have to go through the same
+      * archive as the PT_Data to keep the pointers consistent, the rest
+      * is shared or copied with copy_unlinked_from.
+      */
+    template<class Archive> void serialize_linked(Archive & ar) {
+        ar & ways & admins & pois & poitypes & poitype_map & poi_map;
+    }
+
+    /// Share the graph and the indexes of other, and copy the other objects not handled by serialize_linked
+    void copy_unlinked_from(const GeoRef& other);
+
     /** Construit l'indexe spatial */
     void build_proximity_list();
 
-    ///  Construit l'indexe autocomplete à partir des rues
-    void build_autocomplete_list();
+    ///  Construit l'indexe autocomplete à partir des rues, les chaînes étant découpées sur nb_threads threads
+    void build_autocomplete_list(size_t nb_threads = 1);
 
     /// Normalisation des codes externes
     void normalize_extcode_way();
@@ -326,8 +541,26 @@ struct GeoRef {
     edge_t nearest_edge(const type::GeographicalCoord &coordinates, const proximitylist::ProximityList<vertex_t>& prox, type::idx_t offset = 0, double horizon = 500) const;
 
     edge_t nearest_edge(const type::GeographicalCoord & coordinates, type::Mode_e mode) const {
-        return nearest_edge(coordinates, pl, offsets[mode]);
+        return nearest_edge(coordinates, *pl, offsets[mode]);
     }
+
+    /** Project all the coordinates on the graph corresponding to the offset
+      *
+      * Same projections as the ProjectionData constructor, computed by
+      * nb_threads threads sharing the coordinates.
+      */
+    std::vector<ProjectionData> project_coords(const std::vector<type::GeographicalCoord>& coords,
+                                               type::idx_t offset,
+                                               size_t nb_threads = 1,
+                                               double horizon = 500) const;
+
+    /// same, on at most nb_threads threads of the given pool
+    std::vector<ProjectionData> project_coords(const std::vector<type::GeographicalCoord>& coords,
+                                               type::idx_t offset,
+                                               ThreadPool& pool,
+                                               size_t nb_threads,
+                                               double horizon = 500) const;
+
     std::pair<int, const Way*> nearest_addr(const type::GeographicalCoord&) const;
     std::pair<int, const Way*> nearest_addr(const type::GeographicalCoord& coord,
                                             const std::function<bool(const Way&)>& filter) const;
@@ -346,59 +579,6 @@ struct GeoRef {
     GeoRef(const GeoRef& other) = default;
 };
 
-/** When given a coordinate, we have to associate it with the street network.
-  *
-  * This structure handle this.
-  *
-  * It contains
-  *   - 2 possible nodes (each end of the edge where the coordinate has been projected)
-  *   - the coordinate of the projection
-  *   - the 2 distances between the projected point and the ends (NOTE, this is not the distance between the coordinate and the ends)
-  *
-  */
-struct ProjectionData {
-
-    /// enum used to acces the nodes and the distances
-    enum class Direction {
-        Source = 0,
-        Target,
-        size
-    };
-    /// 2 possible nodes (each end of the edge where the coordinate has been projected)
-    flat_enum_map<Direction, vertex_t> vertices;
-
-    // The edge we projected on. Needed since we can't be sure to get the right edge with only the source and the target because
-    // of parallel edges.
-    Edge edge;
-
-    /// has the projection been successful?
-    bool found = false;
-
-    /// The coordinate projected on the edge
-    type::GeographicalCoord projected;
-
-    //the original coordinate before projection
-    type::GeographicalCoord real_coord;
-
-    /// Distance between the projected point and the ends
-    flat_enum_map<Direction, double> distances {{{-1, -1}}};
-
-    ProjectionData() {}
-    /// Project the coordinate on the graph
-    ProjectionData(const type::GeographicalCoord & coord, const GeoRef &sn, const proximitylist::ProximityList<vertex_t> &prox);
-    /// Project the coordinate on the graph corresponding to the transportation mode of the offset
-    ProjectionData(const type::GeographicalCoord & coord, const GeoRef &sn, type::idx_t offset, const proximitylist::ProximityList<vertex_t> &prox, double horizon = 500);
-
-    template<class Archive> void serialize(Archive & ar, const unsigned int) {
-        ar & vertices & projected & distances & found & real_coord & edge;
-    }
-
-    void init(const type::GeographicalCoord & coord, const GeoRef & sn, edge_t nearest_edge);
-
-    /// syntaxic sugar
-    vertex_t operator[] (Direction d) const { return vertices[d]; }
-};
-
 /** Nommage d'un POI (point of interest). **/
 struct POIType : public nt::Nameable, nt::Header{
     const static type::Type_e type = type::Type_e::POIType;
@@ -0,0 +1,362 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "goal_directed_search.h"
+#include "georef.h"
+#include <boost/foreach.hpp>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+
+namespace navitia { namespace georef {
+
+namespace {
+
+typedef GoalDirectedBounds::Weight Weight;
+const Weight inf = ContractionHierarchy::inf;
+const uint32_t invalid_vertex = ContractionHierarchy::invalid_vertex;
+
+/// saturated sum, the weights never overflow
+Weight add(Weight a, Weight b) {
+    return a >= inf - b ? inf : a + b;
+}
+
+/// out arcs of each vertex (in arcs if reversed), to compute the weights of the landmarks
+struct Adjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<std::pair<uint32_t, Weight>> arcs;
+
+    Adjacency(size_t nb_vertices, const std::vector<ContractionHierarchy::InputArc>& input_arcs, bool reversed) :
+            offsets(nb_vertices + 1, 0), arcs(input_arcs.size()) {
+        for (const auto& arc: input_arcs) {
+            ++offsets[(reversed ? arc.target : arc.source) + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        auto next = offsets;
+        for (const auto& arc: input_arcs) {
+            const auto from = reversed ? arc.target : arc.source;
+            const auto to = reversed ? arc.source : arc.target;
+            arcs[next[from]++] = {to, arc.weight};
+        }
+    }
+
+    /// weights from the source to all the vertices
+    std::vector<Weight> weights_from(uint32_t source) const {
+        typedef std::pair<Weight, uint32_t> QueueItem;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        std::vector<Weight> weights(offsets.size() - 1, inf);
+        weights[source] = 0;
+        queue.push({0, source});
+        while (! queue.empty()) {
+            const auto item = queue.top();
+            queue.pop();
+            const auto u = item.second;
+            if (item.first > weights[u]) { continue; }
+            for (auto i = offsets[u]; i < offsets[u + 1]; ++i) {
+                const auto weight = add(item.first, arcs[i].second);
+                if (weight < weights[arcs[i].first]) {
+                    weights[arcs[i].first] = weight;
+                    queue.push({weight, arcs[i].first});
+                }
+            }
+        }
+        return weights;
+    }
+};
+
+/// vertex to settle, key being its weight plus its potential
+struct QueueItem {
+    int64_t key;
+    Weight weight;
+    uint32_t vertex;
+    bool operator>(const QueueItem& other) const { return key > other.key; }
+};
+typedef std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> Queue;
+
+} // anonymous namespace
+
+DirectPathAlgorithm direct_path_algorithm_from_string(const std::string& name) {
+    if (name == "dijkstra") { return DirectPathAlgorithm::Dijkstra; }
+    if (name == "astar") { return DirectPathAlgorithm::AStar; }
+    if (name == "bidirectional_astar") { return DirectPathAlgorithm::BidirectionalAStar; }
+    throw std::invalid_argument("unknown direct path algorithm: " + name);
+}
+
+GoalDirectedBounds::GoalDirectedBounds(size_t nb_vertices,
+                                       const std::vector<ContractionHierarchy::InputArc>& arcs,
+                                       double max_speed,
+                                       size_t nb_landmarks) :
+        nb_vertices(nb_vertices), max_speed(max_speed) {
+    if (nb_landmarks == 0 || arcs.empty()) { return; }
+    const Adjacency out_arcs(nb_vertices, arcs, false);
+    const Adjacency in_arcs(nb_vertices, arcs, true);
+
+    // weight from the closest landmark (or from the first vertex) to each vertex
+    auto min_weights = out_arcs.weights_from(arcs.front().source);
+    while (landmarks.size() < nb_landmarks) {
+        uint32_t farthest = invalid_vertex;
+        Weight farthest_weight = 0;
+        for (uint32_t v = 0; v < nb_vertices; ++v) {
+            if (min_weights[v] != inf && min_weights[v] > farthest_weight) {
+                farthest = v;
+                farthest_weight = min_weights[v];
+            }
+        }
+        // all the reachable vertices are already landmarks
+        if (farthest == invalid_vertex) { break; }
+
+        landmarks.push_back(farthest);
+        const auto from = out_arcs.weights_from(farthest);
+        const auto to = in_arcs.weights_from(farthest);
+        from_landmarks.insert(from_landmarks.end(), from.begin(), from.end());
+        to_landmarks.insert(to_landmarks.end(), to.begin(), to.end());
+        for (uint32_t v = 0; v < nb_vertices; ++v) {
+            min_weights[v] = std::min(min_weights[v], from[v]);
+        }
+    }
+}
+
+GoalDirectedBounds::Weight GoalDirectedBounds::lower_bound(uint32_t u, uint32_t v, double distance) const {
+    Weight bound = 0;
+    if (max_speed > 0) {
+        bound = Weight(std::min(distance / max_speed, double(inf - 1)));
+    }
+    for (size_t i = 0; i < landmarks.size(); ++i) {
+        const auto* from = &from_landmarks[i * nb_vertices];
+        if (from[u] != inf && from[v] != inf && from[v] > from[u]) {
+            bound = std::max(bound, from[v] - from[u]);
+        }
+        const auto* to = &to_landmarks[i * nb_vertices];
+        if (to[u] != inf && to[v] != inf && to[u] > to[v]) {
+            bound = std::max(bound, to[u] - to[v]);
+        }
+    }
+    return bound;
+}
+
+void GoalDirectedSearch::Labels::reset(size_t nb_vertices) {
+    if (weights.size() != nb_vertices) {
+        weights.assign(nb_vertices, inf);
+        parents.assign(nb_vertices, invalid_vertex);
+    } else {
+        for (const auto v: touched) { weights[v] = inf; }
+    }
+    touched.clear();
+}
+
+void GoalDirectedSearch::Labels::set(uint32_t v, Weight weight, uint32_t parent) {
+    if (weights[v] == inf) { touched.push_back(v); }
+    weights[v] = weight;
+    parents[v] = parent;
+}
+
+std::vector<uint32_t> GoalDirectedSearch::shortest_path(type::Mode_e mode,
+                                                        const std::vector<Extremity>& sources,
+                                                        const std::vector<Extremity>& targets,
+                                                        Weight max_weight,
+                                                        bool bidirectional) {
+    nb_settled_vertices = 0;
+    if (sources.empty() || targets.empty()) { return {}; }
+    const auto& reverse_graph = (*geo_ref.reverse_mode_graphs)[mode];
+    if (bidirectional && boost::num_vertices(reverse_graph) == boost::num_vertices((*geo_ref.mode_graphs)[mode])) {
+        return bidirectional_astar(mode, sources, targets, max_weight);
+    }
+    return astar(mode, sources, targets, max_weight);
+}
+
+std::vector<uint32_t> GoalDirectedSearch::astar(type::Mode_e mode,
+                                                const std::vector<Extremity>& sources,
+                                                const std::vector<Extremity>& targets,
+                                                Weight max_weight) {
+    const auto& graph = (*geo_ref.mode_graphs)[mode];
+    const auto& bounds = (*geo_ref.goal_directed_bounds)[mode];
+    // lower bound of the weight to the lightest target
+    const auto potential = [&](uint32_t v) {
+        Weight best = inf;
+        for (const auto& target: targets) {
+            const auto distance = (*geo_ref.graph)[v].coord.distance_to((*geo_ref.graph)[target.vertex].coord);
+            best = std::min(best, add(bounds.lower_bound(v, target.vertex, distance), target.weight));
+        }
+        return best;
+    };
+
+    forward.reset(boost::num_vertices(graph));
+    Queue queue;
+    for (const auto& source: sources) {
+        if (source.weight >= forward.weights[source.vertex]) { continue; }
+        forward.set(source.vertex, source.weight, source.vertex);
+        queue.push({int64_t(source.weight) + potential(source.vertex), source.weight, source.vertex});
+    }
+
+    Weight best = inf;
+    uint32_t best_target = invalid_vertex;
+    while (! queue.empty()) {
+        const auto item = queue.top();
+        // the bounds are consistent: the keys only grow, no lighter path can be found
+        if (item.key >= int64_t(best) || item.key > int64_t(max_weight)) { break; }
+        queue.pop();
+        const auto u = item.vertex;
+        if (item.weight > forward.weights[u]) { continue; }
+        ++nb_settled_vertices;
+        for (const auto& target: targets) {
+            if (target.vertex == u && add(item.weight, target.weight) < best) {
+                best = add(item.weight, target.weight);
+                best_target = u;
+            }
+        }
+        BOOST_FOREACH(const auto& e, boost::out_edges(u, graph)) {
+            const uint32_t v = boost::target(e, graph);
+            const auto weight = add(item.weight, graph[e].duration.ticks());
+            if (weight >= forward.weights[v] || weight > max_weight) { continue; }
+            forward.set(v, weight, u);
+            const auto h = potential(v);
+            if (h != inf) {
+                queue.push({int64_t(weight) + h, weight, v});
+            }
+        }
+    }
+    if (best_target == invalid_vertex) { return {}; }
+
+    std::vector<uint32_t> path = {best_target};
+    while (forward.parents[path.back()] != path.back()) {
+        path.push_back(forward.parents[path.back()]);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+std::vector<uint32_t> GoalDirectedSearch::bidirectional_astar(type::Mode_e mode,
+                                                              const std::vector<Extremity>& sources,
+                                                              const std::vector<Extremity>& targets,
+                                                              Weight max_weight) {
+    const auto& graph = (*geo_ref.mode_graphs)[mode];
+    const auto& reverse_graph = (*geo_ref.reverse_mode_graphs)[mode];
+    const auto& bounds = (*geo_ref.goal_directed_bounds)[mode];
+    // lower bounds of the weight to the lightest target and from the lightest source
+    const auto to_targets = [&](uint32_t v) {
+        Weight best = inf;
+        for (const auto& target: targets) {
+            const auto distance = (*geo_ref.graph)[v].coord.distance_to((*geo_ref.graph)[target.vertex].coord);
+            best = std::min(best, add(bounds.lower_bound(v, target.vertex, distance), target.weight));
+        }
+        return best;
+    };
+    const auto from_sources = [&](uint32_t v) {
+        Weight best = inf;
+        for (const auto& source: sources) {
+            const auto distance = (*geo_ref.graph)[source.vertex].coord.distance_to((*geo_ref.graph)[v].coord);
+            best = std::min(best, add(bounds.lower_bound(source.vertex, v, distance), source.weight));
+        }
+        return best;
+    };
+
+    // the keys are doubled to keep the average potential (to_targets - from_sources) / 2 integral
+    forward.reset(boost::num_vertices(graph));
+    backward.reset(boost::num_vertices(graph));
+    Queue forward_queue, backward_queue;
+    int64_t best = std::numeric_limits<int64_t>::max();
+    uint32_t meeting = invalid_vertex;
+    const auto meet = [&](uint32_t v) {
+        if (forward.weights[v] == inf || backward.weights[v] == inf) { return; }
+        const auto weight = int64_t(forward.weights[v]) + backward.weights[v];
+        if (weight < best) {
+            best = weight;
+            meeting = v;
+        }
+    };
+    // push v in the queue of labels with the doubled key, if it can be on a path lighter than max_weight
+    const auto push = [&](Queue& queue, const Labels& labels, uint32_t v, bool is_forward) {
+        const auto h_forward = to_targets(v);
+        const auto h_backward = from_sources(v);
+        if (h_forward == inf || h_backward == inf) { return; }
+        const auto weight = labels.weights[v];
+        if (int64_t(weight) + (is_forward ? h_forward : h_backward) > int64_t(max_weight)) { return; }
+        const int64_t potential = is_forward ? int64_t(h_forward) - h_backward : int64_t(h_backward) - h_forward;
+        queue.push({2 * int64_t(weight) + potential, weight, v});
+    };
+    for (const auto& source: sources) {
+        if (source.weight >= forward.weights[source.vertex]) { continue; }
+        forward.set(source.vertex, source.weight, source.vertex);
+        push(forward_queue, forward, source.vertex, true);
+    }
+    for (const auto& target: targets) {
+        if (target.weight >= backward.weights[target.vertex]) { continue; }
+        backward.set(target.vertex, target.weight, target.vertex);
+        push(backward_queue, backward, target.vertex, false);
+        meet(target.vertex);
+    }
+
+    while (! forward_queue.empty() && ! backward_queue.empty()) {
+        if (meeting != invalid_vertex && forward_queue.top().key + backward_queue.top().key >= 2 * best) {
+            break;
+        }
+        const bool is_forward = forward_queue.top().key <= backward_queue.top().key;
+        auto& queue = is_forward ? forward_queue : backward_queue;
+        auto& labels = is_forward ? forward : backward;
+        const auto item = queue.top();
+        queue.pop();
+        const auto u = item.vertex;
+        if (item.weight > labels.weights[u]) { continue; }
+        ++nb_settled_vertices;
+        const auto relax = [&](uint32_t v, Weight arc_weight) {
+            const auto weight = add(item.weight, arc_weight);
+            if (weight >= labels.weights[v] || weight > max_weight) { return; }
+            labels.set(v, weight, u);
+            push(queue, labels, v, is_forward);
+            meet(v);
+        };
+        if (is_forward) {
+            BOOST_FOREACH(const auto& e, boost::out_edges(u, graph)) {
+                relax(boost::target(e, graph), graph[e].duration.ticks());
+            }
+        } else {
+            BOOST_FOREACH(const auto& e, boost::out_edges(u, reverse_graph)) {
+                relax(boost::target(e, reverse_graph), reverse_graph[e].duration.ticks());
+            }
+        }
+    }
+    if (meeting == invalid_vertex || best > int64_t(max_weight)) { return {}; }
+
+    std::vector<uint32_t> path = {meeting};
+    while (forward.parents[path.back()] != path.back()) {
+        path.push_back(forward.parents[path.back()]);
+    }
+    std::reverse(path.begin(), path.end());
+    for (auto v = meeting; backward.parents[v] != v;) {
+        v = backward.parents[v];
+        path.push_back(v);
+    }
+    return path;
+}
+
+}}
@@ -0,0 +1,170 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+#include "contraction_hierarchy.h"
+#include "type/type.h"
+#include "utils/flat_enum_map.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace navitia { namespace georef {
+
+struct GeoRef;
+
+/// algorithm of the direct paths of a transportation mode without contraction hierarchy
+enum class DirectPathAlgorithm {
+    Dijkstra,
+    AStar,
+    BidirectionalAStar
+};
+
+/// "dijkstra", "astar" or "bidirectional_astar", throws std::invalid_argument otherwise
+DirectPathAlgorithm direct_path_algorithm_from_string(const std::string& name);
+
+/// how the direct paths are searched, given at load
+struct DirectPathParams {
+    flat_enum_map<type::Mode_e, DirectPathAlgorithm> algorithms {{{
+        DirectPathAlgorithm::Dijkstra,
+        DirectPathAlgorithm::Dijkstra,
+        DirectPathAlgorithm::Dijkstra,
+        DirectPathAlgorithm::Dijkstra
+    }}};
+    /// number of landmarks of the lower bounds, 0 to only use the crow fly bound
+    size_t nb_landmarks = 0;
+};
+
+/** Lower bounds of the weights between the vertices of the graph of a transportation mode
+ *
+ * The crow fly bound is the distance divided by the speed of the fastest arc
+ * of the graph. The landmarks (ALT) give the bounds of the triangle
+ * inequality with the weights from and to a few vertices far from each other:
+ *     w(u, v) >= w(L, v) - w(L, u)  and  w(u, v) >= w(u, L) - w(v, L)
+ *
+ * The weights are the durations (in ticks) at the default speed of the
+ * graph, as in the ContractionHierarchy.
+ */
+struct GoalDirectedBounds {
+    typedef ContractionHierarchy::Weight Weight;
+
+    size_t nb_vertices = 0;
+
+    /// meters by weight unit of the fastest arc (infinite if an arc with a length weights 0)
+    double max_speed = 0;
+
+    std::vector<uint32_t> landmarks;
+
+    /// weight from the landmark i to v in from_landmarks[i * nb_vertices + v], inf if not reachable
+    std::vector<Weight> from_landmarks;
+
+    /// weight from v to the landmark i, stored the same way
+    std::vector<Weight> to_landmarks;
+
+    GoalDirectedBounds() {}
+
+    /** Bounds of the graph made of the arcs, max_speed being computed by
+     * the caller from the coordinates of the vertices
+     *
+     * The first landmark is the vertex the farthest from the first vertex
+     * having an arc, each next one is the vertex the farthest from the
+     * landmarks already chosen.
+     */
+    GoalDirectedBounds(size_t nb_vertices,
+                       const std::vector<ContractionHierarchy::InputArc>& arcs,
+                       double max_speed,
+                       size_t nb_landmarks);
+
+    bool empty() const { return nb_vertices == 0; }
+
+    /// lower bound of the weight from u to v, distance being their crow fly distance in meters
+    Weight lower_bound(uint32_t u, uint32_t v, double distance) const;
+};
+
+/** A* search of the lightest path between two sets of vertices of the graph
+ * of a transportation mode, guided by its GoalDirectedBounds
+ *
+ * The bidirectional search runs a backward search from the targets at the
+ * same time, on the reverse graph of the mode, with the average of the
+ * forward and backward bounds as potential so both searches stay exact.
+ *
+ * The labels are kept between the searches, only the vertices reached by a
+ * search are reset by the next one.
+ */
+class GoalDirectedSearch {
+public:
+    typedef GoalDirectedBounds::Weight Weight;
+    /// vertex starting or ending a path, with the weight it adds
+    typedef ContractionHierarchy::Source Extremity;
+
+    explicit GoalDirectedSearch(const GeoRef& geo_ref): geo_ref(geo_ref) {}
+
+    /** Vertices of the lightest path from a source to a target, from the
+     * source to the target, empty if no path is lighter than max_weight
+     *
+     * The bidirectional search needs the reverse mode graph, the search is
+     * unidirectional without it.
+     */
+    std::vector<uint32_t> shortest_path(type::Mode_e mode,
+                                        const std::vector<Extremity>& sources,
+                                        const std::vector<Extremity>& targets,
+                                        Weight max_weight,
+                                        bool bidirectional);
+
+    /// number of vertices settled by the last search
+    size_t nb_settled() const { return nb_settled_vertices; }
+
+private:
+    /// labels of one direction of the search
+    struct Labels {
+        std::vector<Weight> weights;
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> touched;
+
+        void reset(size_t nb_vertices);
+        void set(uint32_t v, Weight weight, uint32_t parent);
+    };
+
+    const GeoRef& geo_ref;
+    Labels forward;
+    Labels backward;
+    size_t nb_settled_vertices = 0;
+
+    std::vector<uint32_t> astar(type::Mode_e mode,
+                                const std::vector<Extremity>& sources,
+                                const std::vector<Extremity>& targets,
+                                Weight max_weight);
+    std::vector<uint32_t> bidirectional_astar(type::Mode_e mode,
+                                              const std::vector<Extremity>& sources,
+                                              const std::vector<Extremity>& targets,
+                                              Weight max_weight);
+};
+
+}}
@@ -0,0 +1,169 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "segment_distance.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <cmath>
+
+namespace navitia { namespace georef {
+
+namespace {
+
+// the operations are the ones of GeographicalCoord::approx_sqr_distance
+// and GeographicalCoord::project_common, in the same order, for the
+// results to be the same
+const double earth_radius_in_meters_square = 40612548751652.183023;
+const double deg_to_rad = type::GeographicalCoord::N_DEG_TO_RAD;
+
+inline double approx_sqr_distance(double lon, double lat, double other_lon, double other_lat, double coslat) {
+    const double latitude_arc = (lat - other_lat) * deg_to_rad;
+    const double longitude_arc = (lon - other_lon) * deg_to_rad;
+    const double tmp = coslat * longitude_arc;
+    return earth_radius_in_meters_square * (latitude_arc * latitude_arc + tmp * tmp);
+}
+
+void scalar_distances(double lon, double lat, double coslat, const Segments& segments,
+                      size_t begin, float* distances) {
+    for (size_t i = begin; i < segments.size(); ++i) {
+        const double start_lon = segments.start_lons[i], start_lat = segments.start_lats[i];
+        const double end_lon = segments.end_lons[i], end_lat = segments.end_lats[i];
+        const double dlon = end_lon - start_lon;
+        const double dlat = end_lat - start_lat;
+        const double length_sqr = dlon * dlon + dlat * dlat;
+        const double start_dist = sqrt(approx_sqr_distance(lon, lat, start_lon, start_lat, coslat));
+        const double end_dist = sqrt(approx_sqr_distance(lon, lat, end_lon, end_lat, coslat));
+        double u;
+        if (length_sqr < 1e-11) {
+            u = start_dist < end_dist ? 0 : 1;
+        } else {
+            u = ((lon - start_lon) * dlon + (lat - start_lat) * dlat) / length_sqr;
+        }
+        if (u < 0) {
+            distances[i] = start_dist;
+        } else if (u > 1) {
+            distances[i] = end_dist;
+        } else {
+            distances[i] = sqrt(approx_sqr_distance(lon, lat, start_lon + u * dlon, start_lat + u * dlat, coslat));
+        }
+    }
+}
+
+#if defined(__x86_64__)
+struct Sse2Distance {
+    __m128d lon, lat, coslat, deg_to_rad, earth_radius_square;
+
+    __m128d operator()(__m128d other_lon, __m128d other_lat) const {
+        const __m128d latitude_arc = _mm_mul_pd(_mm_sub_pd(lat, other_lat), deg_to_rad);
+        const __m128d longitude_arc = _mm_mul_pd(_mm_sub_pd(lon, other_lon), deg_to_rad);
+        const __m128d tmp = _mm_mul_pd(coslat, longitude_arc);
+        const __m128d sum = _mm_add_pd(_mm_mul_pd(latitude_arc, latitude_arc), _mm_mul_pd(tmp, tmp));
+        return _mm_sqrt_pd(_mm_mul_pd(earth_radius_square, sum));
+    }
+};
+
+// select a where mask is set, b elsewhere
+inline __m128d select(__m128d mask, __m128d a, __m128d b) {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+void sse2_distances(double lon, double lat, double coslat, const Segments& segments, float* distances) {
+    const Sse2Distance distance{_mm_set1_pd(lon), _mm_set1_pd(lat), _mm_set1_pd(coslat),
+                                _mm_set1_pd(deg_to_rad), _mm_set1_pd(earth_radius_in_meters_square)};
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.);
+    const __m128d min_length_sqr = _mm_set1_pd(1e-11);
+    size_t i = 0;
+    for (; i + 2 <= segments.size(); i += 2) {
+        const __m128d start_lon = _mm_loadu_pd(&segments.start_lons[i]);
+        const __m128d start_lat = _mm_loadu_pd(&segments.start_lats[i]);
+        const __m128d end_lon = _mm_loadu_pd(&segments.end_lons[i]);
+        const __m128d end_lat = _mm_loadu_pd(&segments.end_lats[i]);
+        const __m128d dlon = _mm_sub_pd(end_lon, start_lon);
+        const __m128d dlat = _mm_sub_pd(end_lat, start_lat);
+        const __m128d length_sqr = _mm_add_pd(_mm_mul_pd(dlon, dlon), _mm_mul_pd(dlat, dlat));
+        const __m128d start_dist = distance(start_lon, start_lat);
+        const __m128d end_dist = distance(end_lon, end_lat);
+
+        // the division by a null length gives nan or inf, replaced as the short segments
+        const __m128d dot = _mm_add_pd(_mm_mul_pd(_mm_sub_pd(distance.lon, start_lon), dlon),
+                                       _mm_mul_pd(_mm_sub_pd(distance.lat, start_lat), dlat));
+        const __m128d short_u = _mm_andnot_pd(_mm_cmplt_pd(start_dist, end_dist), one);
+        const __m128d u = select(_mm_cmplt_pd(length_sqr, min_length_sqr), short_u, _mm_div_pd(dot, length_sqr));
+
+        const __m128d projected_dist = distance(_mm_add_pd(start_lon, _mm_mul_pd(u, dlon)),
+                                                _mm_add_pd(start_lat, _mm_mul_pd(u, dlat)));
+        const __m128d result = select(_mm_cmplt_pd(u, zero), start_dist,
+                                      select(_mm_cmpgt_pd(u, one), end_dist, projected_dist));
+        const __m128 result_float = _mm_cvtpd_ps(result);
+        _mm_storel_pi(reinterpret_cast<__m64*>(distances + i), result_float);
+    }
+    scalar_distances(lon, lat, coslat, segments, i, distances);
+}
+#endif
+
+} // anonymous namespace
+
+void Segments::clear() {
+    start_lons.clear();
+    start_lats.clear();
+    end_lons.clear();
+    end_lats.clear();
+}
+
+void Segments::push_back(const type::GeographicalCoord& start, const type::GeographicalCoord& end) {
+    start_lons.push_back(start.lon());
+    start_lats.push_back(start.lat());
+    end_lons.push_back(end.lon());
+    end_lats.push_back(end.lat());
+}
+
+void approx_segment_distances(const type::GeographicalCoord& coord,
+                              double coslat,
+                              const Segments& segments,
+                              float* distances) {
+#if defined(__x86_64__)
+    sse2_distances(coord.lon(), coord.lat(), coslat, segments, distances);
+#else
+    scalar_distances(coord.lon(), coord.lat(), coslat, segments, 0, distances);
+#endif
+}
+
+void scalar_approx_segment_distances(const type::GeographicalCoord& coord,
+                                     double coslat,
+                                     const Segments& segments,
+                                     float* distances) {
+    scalar_distances(coord.lon(), coord.lat(), coslat, segments, 0, distances);
+}
+
+}} // namespace navitia::georef
@@ -0,0 +1,69 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/geographical_coord.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace navitia { namespace georef {
+
+/// Segments stored by coordinate, for their distances to be computed with SIMD
+struct Segments {
+    std::vector<double> start_lons;
+    std::vector<double> start_lats;
+    std::vector<double> end_lons;
+    std::vector<double> end_lats;
+
+    size_t size() const { return start_lons.size(); }
+    void clear();
+    void push_back(const type::GeographicalCoord& start, const type::GeographicalCoord& end);
+};
+
+/** Approximated distances from coord to each segment, written in distances.
+ *
+ * The distances are the ones of GeographicalCoord::approx_project, to the
+ * bit, computed two segments at a time with SSE2 on x86_64 (scalar
+ * elsewhere).
+ */
+void approx_segment_distances(const type::GeographicalCoord& coord,
+                              double coslat,
+                              const Segments& segments,
+                              float* distances);
+
+/// Scalar implementation, exposed for testing
+void scalar_approx_segment_distances(const type::GeographicalCoord& coord,
+                                     double coslat,
+                                     const Segments& segments,
+                                     float* distances);
+
+}} // namespace navitia::georef
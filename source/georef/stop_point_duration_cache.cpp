@@ -0,0 +1,99 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#include "stop_point_duration_cache.h"
+#include "utils/logger.h"
+#include <chrono>
+#include <tuple>
+
+namespace navitia { namespace georef {
+
+bool StopPointDurationKey::operator<(const StopPointDurationKey& other) const {
+    return std::tie(vertex, mode, speed_factor, radius)
+        < std::tie(other.vertex, other.mode, other.speed_factor, other.radius);
+}
+
+// an entry counts for one more duration, the empty ones have to be bounded too
+static size_t cost(const StopPointDurations& durations) {
+    return durations.size() + 1;
+}
+
+StopPointDurationCache::~StopPointDurationCache() {
+    auto logger = log4cplus::Logger::getInstance("log");
+    LOG4CPLUS_INFO(logger, "Stop point duration cache miss : " << nb_cache_miss.load() << " / " << nb_calls.load()
+                   << ", dropped: " << nb_dropped.load()
+                   << ", build time: " << build_duration_us.load() / 1000 << "ms");
+}
+
+std::shared_ptr<const StopPointDurations>
+StopPointDurationCache::get(const StopPointDurationKey& key, const std::function<StopPointDurations()>& compute) {
+    ++nb_calls;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = entries.find(key);
+        if (it != entries.end()) {
+            keys.splice(keys.begin(), keys, it->second.key_it);
+            return it->second.durations;
+        }
+    }
+
+    ++nb_cache_miss;
+    const auto begin = std::chrono::steady_clock::now();
+    const auto durations = std::make_shared<const StopPointDurations>(compute());
+    const auto end = std::chrono::steady_clock::now();
+    build_duration_us += std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cost(*durations) > max_nb_durations) { return durations; }
+    const auto it = entries.find(key);
+    if (it != entries.end()) {
+        // computed by another worker in the meantime
+        keys.splice(keys.begin(), keys, it->second.key_it);
+        return it->second.durations;
+    }
+    while (nb_durations + cost(*durations) > max_nb_durations) {
+        const auto oldest = entries.find(keys.back());
+        nb_durations -= cost(*oldest->second.durations);
+        entries.erase(oldest);
+        keys.pop_back();
+        ++nb_dropped;
+    }
+    keys.push_front(key);
+    entries.emplace(key, Entry{durations, keys.begin()});
+    nb_durations += cost(*durations);
+    return durations;
+}
+
+StopPointDurationCache::Stats StopPointDurationCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return {nb_calls.load(), nb_cache_miss.load(), nb_durations, nb_dropped.load(),
+            build_duration_us.load() / 1000};
+}
+
+}}
@@ -0,0 +1,111 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#pragma once
+#include "georef.h"
+#include "routing/raptor_utils.h"
+#include <atomic>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace navitia { namespace georef {
+
+/// durations from a vertex to the stop points reached within a radius, sorted by stop point
+typedef std::vector<std::pair<routing::SpIdx, navitia::time_duration>> StopPointDurations;
+
+struct StopPointDurationKey {
+    vertex_t vertex;
+    nt::Mode_e mode;
+    float speed_factor;
+    navitia::time_duration radius;
+
+    StopPointDurationKey(vertex_t vertex, nt::Mode_e mode, float speed_factor,
+                         const navitia::time_duration& radius):
+        vertex(vertex), mode(mode), speed_factor(speed_factor), radius(radius) {}
+    bool operator<(const StopPointDurationKey& other) const;
+};
+
+/** Cache of the durations from the vertices of the street network to the stop points
+ *
+ * The durations from a projection are the best of the durations from its two
+ * vertices (see PathFinder::find_nearest_stop_points), the radius dijkstra of
+ * the access and egress of the journeys is thus done once by vertex, mode,
+ * speed factor and radius, and not once by request.
+ *
+ * It is shared by the workers of a Data and dropped with it. When more than
+ * max_nb_durations durations are stored, the least recently used are dropped.
+ */
+class StopPointDurationCache {
+public:
+    struct Stats {
+        uint64_t nb_calls;
+        uint64_t nb_cache_miss;
+        uint64_t nb_durations;
+        uint64_t nb_dropped;
+        uint64_t build_duration_ms;
+    };
+
+    explicit StopPointDurationCache(size_t max_nb_durations): max_nb_durations(max_nb_durations) {}
+    ~StopPointDurationCache();
+
+    /**
+     * The durations of the key, computed by compute if they are not stored.
+     *
+     * compute is called without any lock: two workers missing the same key
+     * at the same time both compute it, and the first stored is kept.
+     */
+    std::shared_ptr<const StopPointDurations>
+    get(const StopPointDurationKey& key, const std::function<StopPointDurations()>& compute);
+
+    Stats get_stats() const;
+
+private:
+    // the most recently used first
+    typedef std::list<StopPointDurationKey> Keys;
+    struct Entry {
+        std::shared_ptr<const StopPointDurations> durations;
+        Keys::iterator key_it;
+    };
+
+    const size_t max_nb_durations;
+    mutable std::mutex mutex;
+    std::map<StopPointDurationKey, Entry> entries;
+    Keys keys;
+    size_t nb_durations = 0;
+
+    std::atomic<uint64_t> nb_calls{0};
+    std::atomic<uint64_t> nb_cache_miss{0};
+    std::atomic<uint64_t> nb_dropped{0};
+    std::atomic<uint64_t> build_duration_us{0};
+};
+
+}}
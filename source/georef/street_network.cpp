@@ -107,11 +107,13 @@ nt::LineString PathFinder::path_coordinates_on_same_edge(
 }
 
 
-StreetNetwork::StreetNetwork(const GeoRef &geo_ref) :
+StreetNetwork::StreetNetwork(const GeoRef &geo_ref, StopPointDurationCache* stop_point_duration_cache,
+                             bool concurrent_fallbacks) :
     geo_ref(geo_ref),
-    departure_path_finder(geo_ref),
-    arrival_path_finder(geo_ref),
-    direct_path_finder(geo_ref)
+    departure_path_finder(geo_ref, stop_point_duration_cache),
+    arrival_path_finder(geo_ref, stop_point_duration_cache),
+    direct_path_finder(geo_ref),
+    fallbacks_pool(std::make_unique<ThreadPool>(concurrent_fallbacks ? 2 : 1))
 {}
 
 void StreetNetwork::init(const type::EntryPoint& start, boost::optional<const type::EntryPoint&> end) {
@@ -200,7 +202,7 @@ StreetNetwork::get_direct_path(const type::EntryPoint& origin, const type::Entry
     const auto dest_edge = ProjectionData(destination.coordinates,
                                           geo_ref,
                                           geo_ref.offsets[dest_mode],
-                                          geo_ref.pl);
+                                          *geo_ref.pl);
     if (! dest_edge.found) { return Path(); }
     const auto max_dur = origin.streetnetwork_params.max_duration
         + destination.streetnetwork_params.max_duration;
@@ -208,14 +210,18 @@ StreetNetwork::get_direct_path(const type::EntryPoint& origin, const type::Entry
                             origin.streetnetwork_params.mode,
                             origin.streetnetwork_params.speed_factor);
 
-    direct_path_finder.start_distance_or_target_dijkstra(max_dur, {dest_edge[source_e], dest_edge[target_e]});
+    if (! direct_path_finder.start_contraction_hierarchy(max_dur, {dest_edge[source_e], dest_edge[target_e]})
+            && ! direct_path_finder.start_goal_directed_search(max_dur, dest_edge)) {
+        direct_path_finder.start_distance_or_target_dijkstra(max_dur, {dest_edge[source_e], dest_edge[target_e]});
+    }
     const auto dest_vertex = direct_path_finder.find_nearest_vertex(dest_edge, true);
     const auto res = direct_path_finder.get_path(dest_edge, dest_vertex);
     if (res.duration > max_dur) { return Path(); }
     return res;
 }
 
-PathFinder::PathFinder(const GeoRef& gref) : geo_ref(gref) {}
+PathFinder::PathFinder(const GeoRef& gref, StopPointDurationCache* stop_point_duration_cache) :
+    geo_ref(gref), color(0), stop_point_duration_cache(stop_point_duration_cache), goal_directed_search(gref) {}
 
 void PathFinder::init(const type::GeographicalCoord& start_coord, nt::Mode_e mode, const float speed_factor) {
     computation_launch = false;
@@ -225,16 +231,39 @@ void PathFinder::init(const type::GeographicalCoord& start_coord, nt::Mode_e mod
     this->speed_factor = speed_factor; //the speed factor is the factor we have to multiply the edge cost with
     nt::idx_t offset = this->geo_ref.offsets[mode];
     this->start_coord = start_coord;
-    starting_edge = ProjectionData(start_coord, this->geo_ref, offset, this->geo_ref.pl);
+    starting_edge = ProjectionData(start_coord, this->geo_ref, offset, *this->geo_ref.pl);
 
     distance_to_entry_point.clear();
+    durations_from_cache = false;
+    cached_durations.clear();
+    cached_paths_searched = false;
+    reset_search();
+}
+
+void PathFinder::reset_distances() {
     //we initialize the distances to the maximum value
-    size_t n = boost::num_vertices(geo_ref.graph);
-    distances.assign(n, bt::pos_infin);
-    //for the predecessors no need to clean the values, the important one will be updated during search
-    predecessors.resize(n);
+    size_t n = boost::num_vertices(*geo_ref.graph);
+    if (distances.size() != n) {
+        distances.assign(n, bt::pos_infin);
+        color = boost::two_bit_color_map<>(n);
+        //for the predecessors no need to clean the values, the important one will be updated during search
+        predecessors.resize(n);
+    } else {
+        // only the vertices reached by the previous search are not at their initial value
+        for (const auto v: touched_vertices) {
+            distances[v] = bt::pos_infin;
+            put(color, v, boost::two_bit_white);
+        }
+    }
+    touched_vertices.clear();
+}
+
+void PathFinder::reset_search() {
+    reset_distances();
 
     if (starting_edge.found) {
+        touched_vertices.push_back(starting_edge[source_e]);
+        touched_vertices.push_back(starting_edge[target_e]);
         //durations initializations
         distances[starting_edge[source_e]] = crow_fly_duration(starting_edge.distances[source_e]); //for the projection, we use the default walking speed.
         distances[starting_edge[target_e]] = crow_fly_duration(starting_edge.distances[target_e]);
@@ -259,20 +288,11 @@ void PathFinder::start_distance_dijkstra(const navitia::time_duration& radius) {
     // We start dijkstra from source and target nodes
     try {
 #ifndef _DEBUG_DIJKSTRA_QUANTUM_
-        dijkstra(starting_edge[source_e], distance_visitor(radius, distances));
-#else
-        dijkstra(starting_edge[source_e], printer_distance_visitor(radius, distances, "source"));
-#endif
-    } catch(DestinationFound){}
-
-    try {
-#ifndef _DEBUG_DIJKSTRA_QUANTUM_
-        dijkstra(starting_edge[target_e], distance_visitor(radius, distances));
+        dijkstra_from_starting_edge(distance_visitor(radius, distances));
 #else
-        dijkstra(starting_edge[target_e], printer_distance_visitor(radius, distances, "target"));
+        dijkstra_from_starting_edge(printer_distance_visitor(radius, distances, "start"));
 #endif
     } catch(DestinationFound){}
-
 }
 
 void PathFinder::start_distance_or_target_dijkstra(const navitia::time_duration& radius, const std::vector<vertex_t>& destinations){
@@ -282,22 +302,12 @@ void PathFinder::start_distance_or_target_dijkstra(const navitia::time_duration&
     // We start dijkstra from source and target nodes
     try {
 #ifndef _DEBUG_DIJKSTRA_QUANTUM_
-        dijkstra(starting_edge[source_e], distance_or_target_visitor(radius, distances, destinations));
-#else
-        dijkstra(starting_edge[source_e],
-                 printer_distance_or_target_visitor(radius, distances, destinations, "direct_path_source"));
-#endif
-    } catch(DestinationFound&){}
-
-    try {
-#ifndef _DEBUG_DIJKSTRA_QUANTUM_
-        dijkstra(starting_edge[target_e], distance_or_target_visitor(radius, distances, destinations));
+        dijkstra_from_starting_edge(distance_or_target_visitor(radius, distances, destinations));
 #else
-        dijkstra(starting_edge[target_e],
-                 printer_distance_or_target_visitor(radius, distances, destinations, "direct_path_target"));
+        dijkstra_from_starting_edge(printer_distance_or_target_visitor(radius, distances, destinations,
+                                                                       "direct_path"));
 #endif
     } catch(DestinationFound&){}
-
 }
 
 std::vector<std::pair<type::idx_t, type::GeographicalCoord>>
@@ -321,7 +331,7 @@ struct ProjectionGetterOnFly{
     const GeoRef& geo_ref;
     const nt::idx_t offset;
     const georef::ProjectionData operator()(const type::GeographicalCoord& coord) const{
-        return georef::ProjectionData{coord, geo_ref, offset, geo_ref.pl};
+        return georef::ProjectionData{coord, geo_ref, offset, *geo_ref.pl};
     }
 };
 
@@ -356,31 +366,31 @@ PathFinder::start_dijkstra_and_fill_duration_map(const navitia::time_duration& r
     dump_dijkstra_for_quantum(starting_edge);
 #endif
     for (const auto& dest: projection_found_dests) {
-        //if our two points are projected on the same edge the
-        // Dijkstra won't give us the correct value we need to handle
-        // this case separately
-        auto& projection = dest.second;
-        auto& id = dest.first;
-        navitia::time_duration duration;
-        if(is_projected_on_same_edge(starting_edge, projection)){
-            //We calculate the duration for going to the edge, then to
-            //the projected destination on the edge and finally to the
-            //destination
-            duration = path_duration_on_same_edge(starting_edge, projection);
-        } else {
-            duration = find_nearest_vertex(projection, true).first;
-        }
-        if(duration <= radius){
-            result[id] = georef::RoutingElement(duration, georef::RoutingStatus_e::reached) ;
-        } else {
-            result[id] = georef::RoutingElement(navitia::time_duration(),
-                                                georef::RoutingStatus_e::unreached);
-        }
-
+        result[dest.first] = get_routing_element(dest.second, radius);
     }
     return result;
 }
 
+georef::RoutingElement PathFinder::get_routing_element(const ProjectionData& projection,
+                                                       const navitia::time_duration& radius) {
+    //if our two points are projected on the same edge the
+    // Dijkstra won't give us the correct value we need to handle
+    // this case separately
+    navitia::time_duration duration;
+    if(is_projected_on_same_edge(starting_edge, projection)){
+        //We calculate the duration for going to the edge, then to
+        //the projected destination on the edge and finally to the
+        //destination
+        duration = path_duration_on_same_edge(starting_edge, projection);
+    } else {
+        duration = find_nearest_vertex(projection, true).first;
+    }
+    if(duration <= radius){
+        return georef::RoutingElement(duration, georef::RoutingStatus_e::reached);
+    }
+    return georef::RoutingElement(navitia::time_duration(), georef::RoutingStatus_e::unreached);
+}
+
 routing::map_stop_point_duration
 PathFinder::find_nearest_stop_points(const navitia::time_duration& radius,
                                      const proximitylist::ProximityList<type::idx_t>& pl) {
@@ -415,11 +425,14 @@ PathFinder::find_nearest_stop_points(const navitia::time_duration& radius,
     if (elements.empty()) {
         return result;
     }
+    if (stop_point_duration_cache) {
+        return find_nearest_stop_points_with_cache(radius, elements, pl);
+    }
     std::vector<routing::SpIdx> dest_sp_idx;
     for (const auto& e: elements) {
         dest_sp_idx.push_back(routing::SpIdx{e.first});
     }
-    ProjectionGetterByCache projection_getter{mode, geo_ref.projected_stop_points};
+    ProjectionGetterByCache projection_getter{mode, *geo_ref.projected_stop_points};
     auto resp = start_dijkstra_and_fill_duration_map<routing::SpIdx,
             routing::SpIdx,ProjectionGetterByCache>(
             radius, dest_sp_idx, projection_getter);
@@ -431,6 +444,99 @@ PathFinder::find_nearest_stop_points(const navitia::time_duration& radius,
     return result;
 }
 
+routing::map_stop_point_duration
+PathFinder::find_nearest_stop_points_with_cache(const navitia::time_duration& radius,
+                                                const std::vector<std::pair<type::idx_t, type::GeographicalCoord>>& elements,
+                                                const proximitylist::ProximityList<type::idx_t>& pl) {
+    // the dijkstra from the starting edge gives to each vertex the best of its
+    // durations from the vertices of the edge plus their durations from the
+    // starting point, and it's the same for the stop points
+    reset_search();
+    std::vector<std::pair<vertex_t, navitia::time_duration>> starts;
+    for (const auto direction: {source_e, target_e}) {
+        const auto vertex = starting_edge[direction];
+        // when the projection is done on a node, only this node is used
+        if (! distances[vertex].is_pos_infinity()) {
+            starts.emplace_back(vertex, distances[vertex]);
+        }
+    }
+    std::vector<std::pair<navitia::time_duration, std::shared_ptr<const StopPointDurations>>> from_starts;
+    for (const auto& start: starts) {
+        const StopPointDurationKey key(start.first, mode, speed_factor, radius);
+        from_starts.emplace_back(start.second, stop_point_duration_cache->get(key, [&]() {
+            return stop_point_durations_from_vertex(start.first, radius, pl);
+        }));
+    }
+    reset_search();
+
+    const auto by_sp = [](const std::pair<routing::SpIdx, navitia::time_duration>& a,
+                          const std::pair<routing::SpIdx, navitia::time_duration>& b) {
+        return a.first < b.first;
+    };
+    routing::map_stop_point_duration result;
+    for (const auto& element: elements) {
+        const routing::SpIdx sp_idx{element.first};
+        const auto& projection = (*geo_ref.projected_stop_points)[element.first][mode];
+        if (! projection.found) { continue; }
+        navitia::time_duration duration = bt::pos_infin;
+        if (is_projected_on_same_edge(starting_edge, projection)) {
+            duration = path_duration_on_same_edge(starting_edge, projection);
+        } else {
+            for (const auto& from_start: from_starts) {
+                const auto& durations = *from_start.second;
+                const auto it = std::lower_bound(durations.begin(), durations.end(),
+                                                 std::make_pair(sp_idx, navitia::time_duration()), by_sp);
+                if (it != durations.end() && it->first == sp_idx) {
+                    duration = std::min(duration, from_start.first + it->second);
+                }
+            }
+        }
+        if (duration <= radius) {
+            result[sp_idx] = duration;
+        }
+    }
+    computation_launch = true;
+    durations_from_cache = true;
+    cached_durations = result;
+    cached_radius = radius;
+    cached_paths_searched = false;
+    return result;
+}
+
+void PathFinder::search_cached_paths() {
+    if (cached_paths_searched) { return; }
+    // the same bounded dijkstra as without the cache, run once for all the
+    // paths: its distances and predecessors are the ones of the durations
+    reset_search();
+    start_distance_dijkstra(cached_radius);
+    cached_paths_searched = true;
+}
+
+StopPointDurations
+PathFinder::stop_point_durations_from_vertex(vertex_t vertex,
+                                             const navitia::time_duration& radius,
+                                             const proximitylist::ProximityList<type::idx_t>& pl) {
+    reset_distances();
+    touched_vertices.push_back(vertex);
+    distances[vertex] = navitia::seconds(0);
+    predecessors[vertex] = vertex;
+    try {
+        dijkstra(vertex, distance_visitor(radius, distances));
+    } catch(DestinationFound){}
+
+    StopPointDurations result;
+    const float crow_fly_dist = radius.total_seconds() * speed_factor * georef::default_speed[mode];
+    for (const auto& element: pl.find_within((*geo_ref.graph)[vertex].coord, crow_fly_dist)) {
+        const auto& projection = (*geo_ref.projected_stop_points)[element.first][mode];
+        const auto duration = find_nearest_vertex(projection, true).first;
+        if (duration <= radius) {
+            result.emplace_back(routing::SpIdx(element.first), duration);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
 boost::container::flat_map<PathFinder::coord_uri, georef::RoutingElement>
 PathFinder::get_duration_with_dijkstra(const navitia::time_duration& radius,
                                        const std::vector<type::GeographicalCoord>& dest_coords){
@@ -455,10 +561,16 @@ navitia::time_duration PathFinder::get_distance(type::idx_t target_idx) {
 
     if (! starting_edge.found)
         return max;
-    assert(boost::edge(starting_edge[source_e], starting_edge[target_e], geo_ref.graph).second);
+    assert(boost::edge(starting_edge[source_e], starting_edge[target_e], *geo_ref.graph).second);
 
-    ProjectionData target = this->geo_ref.projected_stop_points[target_idx][mode];
+    ProjectionData target = (*this->geo_ref.projected_stop_points)[target_idx][mode];
 
+    // the durations of the reached stop points are already known
+    if (durations_from_cache) {
+        const auto it = cached_durations.find(routing::SpIdx(target_idx));
+        if (it == cached_durations.end()) { return max; }
+        return it->second;
+    }
     auto nearest_edge = update_path(target);
 
     return nearest_edge.first;
@@ -469,7 +581,8 @@ std::pair<navitia::time_duration, ProjectionData::Direction> PathFinder::find_ne
     if (! target.found)
         return {max, source_e};
 
-    if (distances[target[source_e]] == max) //if one distance has not been reached, both have not been reached
+    // with the one way streets, or a bounded search, only one of the vertices may have been reached
+    if (distances[target[source_e]] == max && distances[target[target_e]] == max)
         return {max, source_e};
 
     if (handle_on_node) {
@@ -493,7 +606,16 @@ std::pair<navitia::time_duration, ProjectionData::Direction> PathFinder::find_ne
 Path PathFinder::get_path(type::idx_t idx) {
     if (! computation_launch)
         return {};
-    ProjectionData projection = this->geo_ref.projected_stop_points[idx][mode];
+    ProjectionData projection = (*this->geo_ref.projected_stop_points)[idx][mode];
+
+    if (durations_from_cache) {
+        // the durations come from the cache, the paths are only searched
+        // now, for the stop points reached, as they would have been by the dijkstra
+        if (cached_durations.find(routing::SpIdx(idx)) == cached_durations.end()) {
+            return {};
+        }
+        search_cached_paths();
+    }
 
     auto nearest_edge = find_nearest_vertex(projection);
 
@@ -656,7 +778,7 @@ PathFinder::get_path(const ProjectionData& target,
         PathItem item;
         item.duration = path_duration_on_same_edge(starting_edge, target);
 
-        auto edge_pair = boost::edge(starting_edge[source_e], starting_edge[target_e], geo_ref.graph);
+        auto edge_pair = boost::edge(starting_edge[source_e], starting_edge[target_e], *geo_ref.graph);
         if (! edge_pair.second) {
             throw navitia::exception("impossible to find an edge");
         }
@@ -683,9 +805,9 @@ void PathFinder::add_projections_to_path(Path& p, bool append_to_begin) const {
     // If source and target are the same keep the closest one
     if(starting_edge[source_e] == starting_edge[target_e]) {
         direction = starting_edge.distances[source_e] < starting_edge.distances[target_e] ? source_e : target_e;
-    } else if (coord_to_consider == geo_ref.graph[starting_edge[source_e]].coord) {
+    } else if (coord_to_consider == (*geo_ref.graph)[starting_edge[source_e]].coord) {
         direction = source_e;
-    } else if (coord_to_consider == geo_ref.graph[starting_edge[target_e]].coord) {
+    } else if (coord_to_consider == (*geo_ref.graph)[starting_edge[target_e]].coord) {
         direction = target_e;
     } else {
         throw navitia::exception("by construction, should never happen");
@@ -698,13 +820,13 @@ std::pair<navitia::time_duration, ProjectionData::Direction> PathFinder::update_
     constexpr auto max = bt::pos_infin;
     if (! target.found)
         return {max, source_e};
-    assert(boost::edge(target[source_e], target[target_e], geo_ref.graph).second );
+    assert(boost::edge(target[source_e], target[target_e], *geo_ref.graph).second );
 
     computation_launch = true;
     if (distances[target[source_e]] == max || distances[target[target_e]] == max) {
         bool found = false;
         try {
-            dijkstra(starting_edge[source_e], target_all_visitor({target[source_e], target[target_e]}));
+            dijkstra_from_starting_edge(target_all_visitor({target[source_e], target[target_e]}));
         } catch(DestinationFound) { found = true; }
 
         //if no way has been found, we can stop the search
@@ -719,12 +841,8 @@ std::pair<navitia::time_duration, ProjectionData::Direction> PathFinder::update_
 
             return {max, source_e};
         }
-        try {
-            dijkstra(starting_edge[target_e], target_all_visitor({target[source_e], target[target_e]}));
-        } catch(DestinationFound) { found = true; }
-
     }
-    //if we succeded in the first search, we must have found one of the other distances
+    //if we succeded in the search, we must have found both distances
     assert(distances[target[source_e]] != max && distances[target[target_e]] != max);
 
     return find_nearest_vertex(target);
@@ -742,7 +860,7 @@ Path PathFinder::build_path(vertex_t best_destination) const {
 }
 
 static edge_t get_best_edge(vertex_t u, vertex_t v, const GeoRef& georef) {
-    const auto& g = georef.graph;
+    const auto& g = *georef.graph;
     boost::optional<edge_t> best_edge;
     for (auto range = out_edges(u, g); range.first != range.second; ++range.first) {
         if (target(*range.first, g) != v) { continue; }
@@ -756,6 +874,91 @@ static edge_t get_best_edge(vertex_t u, vertex_t v, const GeoRef& georef) {
     return *best_edge;
 }
 
+bool PathFinder::start_contraction_hierarchy(const navitia::time_duration& radius,
+                                             const std::vector<vertex_t>& destinations) {
+    const auto* ch = geo_ref.get_contraction_hierarchy(mode);
+    if (! ch) { return false; }
+    if (! starting_edge.found) { return true; }
+    computation_launch = true;
+
+    const std::vector<uint32_t> targets(destinations.begin(), destinations.end());
+    for (const auto& path: ch->one_to_many(contraction_hierarchy_sources(), targets, to_weight(radius))) {
+        relax_path(path);
+    }
+    return true;
+}
+
+bool PathFinder::start_goal_directed_search(const navitia::time_duration& radius, const ProjectionData& target) {
+    const auto algorithm = geo_ref.direct_path_algorithms[mode];
+    if (algorithm == DirectPathAlgorithm::Dijkstra || (*geo_ref.goal_directed_bounds)[mode].empty()) {
+        return false;
+    }
+    if (! starting_edge.found) { return true; }
+    computation_launch = true;
+    if (! target.found) { return true; }
+
+    // the path ends as find_nearest_vertex(target, true) chooses the vertex
+    std::vector<GoalDirectedSearch::Extremity> targets;
+    if (target.distances[source_e] < 0.01) {
+        targets.push_back({uint32_t(target[source_e]), 0});
+    } else if (target.distances[target_e] < 0.01) {
+        targets.push_back({uint32_t(target[target_e]), 0});
+    } else {
+        for (const auto d: {source_e, target_e}) {
+            targets.push_back({uint32_t(target[d]), to_weight(crow_fly_duration(target.distances[d]))});
+        }
+    }
+    relax_path(goal_directed_search.shortest_path(mode, contraction_hierarchy_sources(), targets,
+                                                  to_weight(radius),
+                                                  algorithm == DirectPathAlgorithm::BidirectionalAStar));
+    return true;
+}
+
+void PathFinder::relax_path(const std::vector<uint32_t>& path) {
+    const SpeedDistanceCombiner combine(speed_factor);
+    const TouchedDistanceMap distance_map{&distances, &touched_vertices};
+    for (size_t i = 1; i < path.size(); ++i) {
+        const vertex_t u = path[i - 1], v = path[i];
+        const auto dist = combine(distances[u], (*geo_ref.graph)[get_best_edge(u, v, geo_ref)].duration);
+        if (dist < distances[v]) {
+            put(distance_map, v, dist);
+            predecessors[v] = u;
+        }
+    }
+}
+
+void PathFinder::start_contraction_hierarchy_buckets(const ContractionHierarchy& ch,
+                                                     const ContractionHierarchy::Buckets& buckets,
+                                                     const std::vector<vertex_t>& targets,
+                                                     const navitia::time_duration& radius) {
+    if (! starting_edge.found) { return; }
+    computation_launch = true;
+
+    const auto weights = ch.bucket_weights(buckets, targets.size(),
+                                           contraction_hierarchy_sources(), to_weight(radius));
+    const TouchedDistanceMap distance_map{&distances, &touched_vertices};
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (weights[i] == ContractionHierarchy::inf) { continue; }
+        const auto dist = navitia::time_duration(0, 0, 0, weights[i]) / speed_factor;
+        if (dist < distances[targets[i]]) {
+            put(distance_map, targets[i], dist);
+        }
+    }
+}
+
+ContractionHierarchy::Weight PathFinder::to_weight(const navitia::time_duration& duration) const {
+    return ContractionHierarchy::Weight(duration.ticks() * speed_factor);
+}
+
+std::vector<ContractionHierarchy::Source> PathFinder::contraction_hierarchy_sources() const {
+    std::vector<ContractionHierarchy::Source> sources;
+    for (const auto v: {starting_edge[source_e], starting_edge[target_e]}) {
+        if (distances[v] == bt::pos_infin) { continue; }
+        sources.push_back({uint32_t(v), to_weight(distances[v])});
+    }
+    return sources;
+}
+
 Path create_path(const GeoRef& geo_ref,
                  const std::vector<vertex_t>& reverse_path,
                  bool add_one_elt,
@@ -766,7 +969,7 @@ Path create_path(const GeoRef& geo_ref,
     nt::idx_t last_way = type::invalid_idx;
     boost::optional<PathItem::TransportCaracteristic> last_transport_carac{};
     PathItem path_item;
-    path_item.coordinates.push_back(geo_ref.graph[reverse_path.back()].coord);
+    path_item.coordinates.push_back((*geo_ref.graph)[reverse_path.back()].coord);
 
     for (size_t i = reverse_path.size(); i > 1; --i) {
         bool path_item_changed = false;
@@ -774,7 +977,7 @@ Path create_path(const GeoRef& geo_ref,
         vertex_t u = reverse_path[i-1];
         edge_t e = get_best_edge(u, v, geo_ref);
 
-        Edge edge = geo_ref.graph[e];
+        Edge edge = (*geo_ref.graph)[e];
         PathItem::TransportCaracteristic transport_carac = geo_ref.get_caracteristic(e);
         if ((edge.way_idx != last_way && last_way != type::invalid_idx) || (last_transport_carac && transport_carac != *last_transport_carac)) {
             p.path_items.push_back(path_item);
@@ -782,7 +985,7 @@ Path create_path(const GeoRef& geo_ref,
             path_item_changed = true;
         }
 
-        nt::GeographicalCoord coord = geo_ref.graph[v].coord;
+        nt::GeographicalCoord coord = (*geo_ref.graph)[v].coord;
         if(edge.geom_idx != nt::invalid_idx)
         {
             auto geometry = geo_ref.ways[edge.way_idx]->geoms[edge.geom_idx];
@@ -949,22 +1152,22 @@ void PathFinder::dump_dijkstra_for_quantum(const ProjectionData& target) {
     start.open("start.csv");
     destination.open("destination.csv");
     start << "x;y;mode transport" << std::endl
-          << geo_ref.graph[starting_edge[source_e]].coord << ";" << (int)(mode) << std::endl
-          << geo_ref.graph[starting_edge[target_e]].coord << ";" << (int)(mode) << std::endl;
+          << (*geo_ref.graph)[starting_edge[source_e]].coord << ";" << (int)(mode) << std::endl
+          << (*geo_ref.graph)[starting_edge[target_e]].coord << ";" << (int)(mode) << std::endl;
     destination << "x;y;" << std::endl
-          << geo_ref.graph[target[source_e]].coord << std::endl
-          << geo_ref.graph[target[target_e]].coord << std::endl;
+          << (*geo_ref.graph)[target[source_e]].coord << std::endl
+          << (*geo_ref.graph)[target[target_e]].coord << std::endl;
 
     out_edge.open("out_edges.csv");
     out_edge << "target;x;y;" << std::endl;
-    BOOST_FOREACH(edge_t e, boost::out_edges(target[source_e], geo_ref.graph)) {
-        out_edge << "source;" << geo_ref.graph[boost::target(e, geo_ref.graph)].coord << std::endl;
+    BOOST_FOREACH(edge_t e, boost::out_edges(target[source_e], *geo_ref.graph)) {
+        out_edge << "source;" << (*geo_ref.graph)[boost::target(e, *geo_ref.graph)].coord << std::endl;
     }
-    BOOST_FOREACH(edge_t e, boost::out_edges(target[target_e], geo_ref.graph)) {
-        out_edge << "target;" << geo_ref.graph[boost::target(e, geo_ref.graph)].coord << std::endl;
+    BOOST_FOREACH(edge_t e, boost::out_edges(target[target_e], *geo_ref.graph)) {
+        out_edge << "target;" << (*geo_ref.graph)[boost::target(e, *geo_ref.graph)].coord << std::endl;
     }
     try {
-        dijkstra(starting_edge[source_e], printer_all_visitor({target[source_e], target[target_e]}));
+        dijkstra_from_starting_edge(printer_all_visitor({target[source_e], target[target_e]}));
     } catch(DestinationFound) { }
 }
 #endif
@@ -30,12 +30,15 @@ www.navitia.io
 
 #pragma once
 #include "georef.h"
+#include "stop_point_duration_cache.h"
 #include "routing/raptor_utils.h"
 #include "type/time_duration.h"
+#include "type/thread_pool.h"
 #include <boost/graph/filtered_graph.hpp>
 #include <boost/graph/two_bit_color_map.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 #include <boost/format.hpp>
+#include <algorithm>
 
 namespace bt = boost::posix_time;
 
@@ -52,30 +55,6 @@ struct SpeedDistanceCombiner : public std::binary_function<navitia::time_duratio
         return a + b / speed_factor;
     }
 };
-template <typename T>
-using map_by_mode = flat_enum_map<type::Mode_e, T>;
-/**
- * create a map of map of boolean from a map of map of allowed mode
- * (because it's simpler to define with only the allowed mode, but  more efficient with the boolean masks)
- */
-inline map_by_mode<map_by_mode<bool>> create_from_allowedlist(map_by_mode<std::vector<nt::Mode_e>> allowed_modes) {
-    map_by_mode<map_by_mode<bool>> res;
-    for (auto modes_pair : allowed_modes) {
-        res[modes_pair.first] = {{{}}}; //force false initialization of all members
-        for (auto mode : modes_pair.second) {
-            res[modes_pair.first][mode] = true;
-        }
-    }
-    return res;
-}
-
-const auto allowed_transportation_mode = create_from_allowedlist({{{
-                                                                {type::Mode_e::Walking}, //for walking, only walking is allowed
-                                                                {type::Mode_e::Bike}, //for biking, only bike
-                                                                {type::Mode_e::Car, type::Mode_e::Walking}, //for car, only car and walking is allowed
-                                                                {type::Mode_e::Walking, type::Mode_e::Bike} //for vls, walking and bike is allowed
-                                                          }}});
-
 struct TransportationModeFilter {
     flat_enum_map<type::Mode_e, bool> acceptable_modes; //map associating a boolean to a mode,
     type::idx_t nb_vertex_by_mode;
@@ -110,6 +89,32 @@ struct RoutingElement {
         routing_status(routing_status){}
 };
 
+/**
+ * Read/write property map on the distances of a PathFinder, recording
+ * the vertices reached, so that only them are reset at the next init
+ *
+ * All the distances not in touched are pos_infin.
+ */
+struct TouchedDistanceMap {
+    typedef vertex_t key_type;
+    typedef navitia::time_duration value_type;
+    typedef const navitia::time_duration& reference;
+    typedef boost::read_write_property_map_tag category;
+
+    std::vector<navitia::time_duration>* distances;
+    std::vector<vertex_t>* touched;
+};
+
+inline const navitia::time_duration& get(const TouchedDistanceMap& m, vertex_t v) {
+    return (*m.distances)[v];
+}
+
+inline void put(const TouchedDistanceMap& m, vertex_t v, const navitia::time_duration& d) {
+    auto& distance = (*m.distances)[v];
+    if (distance.is_pos_infinity()) { m.touched->push_back(v); }
+    distance = d;
+}
+
 struct PathFinder {
     const GeoRef & geo_ref;
 
@@ -132,7 +137,22 @@ struct PathFinder {
     /// Predecessors array for the Dijkstra
     std::vector<vertex_t> predecessors;
 
-    PathFinder(const GeoRef& geo_ref);
+    /// Vertices whose distance has been set since the last init.
+    /// Only them are reset by the next init, the cost of init is thus
+    /// proportional to the previous search and not to the graph size.
+    std::vector<vertex_t> touched_vertices;
+
+    /// Color map of the Dijkstra, reset as the distances
+    boost::two_bit_color_map<> color;
+
+    /// durations from the vertices to the stop points, shared between the
+    /// workers, used by find_nearest_stop_points if not null
+    StopPointDurationCache* stop_point_duration_cache = nullptr;
+
+    /// A* of the direct paths, for the modes whose direct_path_algorithms asks for it
+    GoalDirectedSearch goal_directed_search;
+
+    PathFinder(const GeoRef& geo_ref, StopPointDurationCache* stop_point_duration_cache = nullptr);
 
     /**
      *  Update the structure for a given starting point and transportation mode
@@ -143,10 +163,61 @@ struct PathFinder {
     void start_distance_dijkstra(const navitia::time_duration& radius);
     void start_distance_or_target_dijkstra(const navitia::time_duration& radius, const std::vector<vertex_t>& destinations);
 
-    /// compute the reachable stop points within the radius
+    /**
+     * Same as start_distance_or_target_dijkstra, but using the contraction hierarchy
+     * of the mode: only the vertices of the paths to the destinations are reached.
+     *
+     * Return false (and does nothing) if no contraction hierarchy has been built for the mode.
+     */
+    bool start_contraction_hierarchy(const navitia::time_duration& radius, const std::vector<vertex_t>& destinations);
+
+    /**
+     * Same as start_distance_or_target_dijkstra toward the vertices of the
+     * target projection, but with the A* (or bidirectional A*) asked by the
+     * direct_path_algorithms of the GeoRef: only the vertices of the path to
+     * the nearest vertex of the target are reached.
+     *
+     * Return false (and does nothing) if the mode uses the dijkstra.
+     */
+    bool start_goal_directed_search(const navitia::time_duration& radius, const ProjectionData& target);
+
+    /**
+     * Set the distances of the targets with the buckets built from them
+     * (see ContractionHierarchy::build_buckets), for the many to many.
+     *
+     * Only the distances of the targets are set, no path can be built.
+     */
+    void start_contraction_hierarchy_buckets(const ContractionHierarchy& ch,
+                                             const ContractionHierarchy::Buckets& buckets,
+                                             const std::vector<vertex_t>& targets,
+                                             const navitia::time_duration& radius);
+
+    /// duration to the projected destination, once the distances to its vertices are computed
+    georef::RoutingElement get_routing_element(const ProjectionData& projection,
+                                               const navitia::time_duration& radius);
+
+    /**
+     * compute the reachable stop points within the radius
+     *
+     * With a stop_point_duration_cache, the durations are computed from the ones
+     * of the vertices of the starting edge and no dijkstra is kept: the first
+     * get_path runs the bounded dijkstra giving the paths.
+     */
     routing::map_stop_point_duration
     find_nearest_stop_points(const navitia::time_duration& radius,
                              const proximitylist::ProximityList<type::idx_t>& pl);
+
+    /**
+     * Durations from the vertex to the stop points of pl reached within the
+     * radius at the current mode and speed, as find_nearest_stop_points would
+     * give them from a projection on this vertex.
+     *
+     * Used to fill the stop_point_duration_cache, it runs its own dijkstra:
+     * the search started from the starting point is lost.
+     */
+    StopPointDurations stop_point_durations_from_vertex(vertex_t vertex,
+                                                        const navitia::time_duration& radius,
+                                                        const proximitylist::ProximityList<type::idx_t>& pl);
     using coord_uri = std::string;
     boost::container::flat_map<coord_uri, georef::RoutingElement>
     get_duration_with_dijkstra(const navitia::time_duration& radius,
@@ -167,14 +238,65 @@ struct PathFinder {
      **/
     template<class Visitor>
     void dijkstra(vertex_t start, Visitor visitor) {
+        dijkstra(&start, &start + 1, visitor);
+    }
+
+    /**
+     * Same as dijkstra, but with several starting vertices settled in a
+     * single search, each from its current distance
+     **/
+    template<class Visitor>
+    void dijkstra(const vertex_t* starts_begin, const vertex_t* starts_end, Visitor visitor) {
         // Note: the predecessors have been updated in init
-        boost::two_bit_color_map<> color(boost::num_vertices(geo_ref.graph));
+        // the colors of the previous dijkstra since init are cleaned,
+        // all the colored vertices have been touched
+        for (const auto v: touched_vertices) {
+            put(color, v, boost::two_bit_white);
+        }
 
-        //we filter the graph to only use certain mean of transport
+#ifndef _DEBUG_DIJKSTRA_QUANTUM_
+        const auto& mode_graph = (*geo_ref.mode_graphs)[mode];
+        if (boost::num_vertices(mode_graph) == boost::num_vertices(*geo_ref.graph)) {
+            run_dijkstra(mode_graph, boost::get(&ModeGraphEdge::duration, mode_graph),
+                         starts_begin, starts_end, visitor);
+            return;
+        }
+#endif
+        // the mode graphs have not been built (graph built by hand as
+        // in ed or in the tests, or debug visitors that need the
+        // coordinates of the vertices): we filter the graph to only
+        // use certain mean of transport
         using filtered_graph = boost::filtered_graph<georef::Graph, boost::keep_all, TransportationModeFilter>;
-        boost::dijkstra_shortest_paths_no_init(filtered_graph(geo_ref.graph, {}, TransportationModeFilter(mode, geo_ref)),
-                                               start, &predecessors[0], &distances[0],
-                                               boost::get(&Edge::duration, geo_ref.graph), // weigth map
+        run_dijkstra(filtered_graph(*geo_ref.graph, {}, TransportationModeFilter(mode, geo_ref)),
+                     boost::get(&Edge::duration, *geo_ref.graph),
+                     starts_begin, starts_end, visitor);
+    }
+
+    /**
+     * Launch a single dijkstra from both vertices of the starting edge, at
+     * the crow fly duration set by init (the vertex disabled by a
+     * projection on a node is not a starting vertex)
+     **/
+    template<class Visitor>
+    void dijkstra_from_starting_edge(Visitor visitor) {
+        vertex_t starts[2];
+        size_t nb_starts = 0;
+        for (const auto d: {ProjectionData::Direction::Source, ProjectionData::Direction::Target}) {
+            const auto v = starting_edge[d];
+            if (distances[v] != bt::pos_infin && (nb_starts == 0 || starts[0] != v)) {
+                starts[nb_starts++] = v;
+            }
+        }
+        dijkstra(starts, starts + nb_starts, visitor);
+    }
+
+    template<class G, class WeightMap, class Visitor>
+    void run_dijkstra(const G& g, WeightMap weights,
+                      const vertex_t* starts_begin, const vertex_t* starts_end, Visitor visitor) {
+        boost::dijkstra_shortest_paths_no_init(g,
+                                               starts_begin, starts_end, &predecessors[0],
+                                               TouchedDistanceMap{&distances, &touched_vertices},
+                                               weights,
                                                boost::identity_property_map(),
                                                std::less<navitia::time_duration>(),
                                                SpeedDistanceCombiner(speed_factor), //we multiply the edge duration by a speed factor
@@ -208,9 +330,41 @@ struct PathFinder {
     );
 
 private:
+    /// the durations of find_nearest_stop_points have been read from the
+    /// stop_point_duration_cache: the paths to those stop points are searched by get_path
+    bool durations_from_cache = false;
+    routing::map_stop_point_duration cached_durations;
+    navitia::time_duration cached_radius;
+    bool cached_paths_searched = false;
+
+    /// run, once for all the get_path after find_nearest_stop_points_with_cache,
+    /// the dijkstra bounded by its radius
+    void search_cached_paths();
+
+    /// reset the distances reached by the previous search
+    void reset_distances();
+
+    /// reset the distances and start again from the starting edge
+    void reset_search();
+
+    routing::map_stop_point_duration
+    find_nearest_stop_points_with_cache(const navitia::time_duration& radius,
+                                        const std::vector<std::pair<type::idx_t, type::GeographicalCoord>>& elements,
+                                        const proximitylist::ProximityList<type::idx_t>& pl);
+
     ///return the time the travel the distance at the current speed (used for projections)
     navitia::time_duration crow_fly_duration(const double val) const;
 
+    /// weight in the contraction hierarchy of a duration at the current speed
+    ContractionHierarchy::Weight to_weight(const navitia::time_duration& duration) const;
+
+    /// starting vertices of the searches in the contraction hierarchy
+    std::vector<ContractionHierarchy::Source> contraction_hierarchy_sources() const;
+
+    /// relax the edges of the path as the dijkstra would, so the
+    /// predecessors can be used as after a dijkstra
+    void relax_path(const std::vector<uint32_t>& path);
+
     void add_custom_projections_to_path(Path& p, bool append_to_begin, const ProjectionData& projection, ProjectionData::Direction d) const;
 
     /// Build a path with a destination and the predecessors list
@@ -234,7 +388,8 @@ private:
 
 /** Structure managing the computation on the streetnetwork */
 struct StreetNetwork {
-    StreetNetwork(const GeoRef& geo_ref);
+    StreetNetwork(const GeoRef& geo_ref, StopPointDurationCache* stop_point_duration_cache = nullptr,
+                  bool concurrent_fallbacks = false);
 
     void init(const type::EntryPoint& start_coord, boost::optional<const type::EntryPoint&> end_coord = {});
 
@@ -258,6 +413,12 @@ struct StreetNetwork {
     PathFinder departure_path_finder;
     PathFinder arrival_path_finder;
     PathFinder direct_path_finder;
+
+    /// the departure and arrival path finders have their own labels: with
+    /// concurrent fallbacks, the stop points around the departure and the
+    /// arrival are searched at the same time on this pool of two threads,
+    /// one after the other on the calling thread otherwise
+    std::unique_ptr<ThreadPool> fallbacks_pool;
 };
 
 /// Build a path from a reverse path list
@@ -354,13 +515,17 @@ struct printer_distance_visitor : public distance_visitor {
 struct target_all_visitor : virtual public boost::dijkstra_visitor<> {
     std::vector<vertex_t> destinations;
     size_t nbFound = 0;
-    target_all_visitor(const std::vector<vertex_t>& destinations):
-        destinations(destinations.begin(), destinations.end()) {}
+    target_all_visitor(const std::vector<vertex_t>& dests):
+        destinations(dests.begin(), dests.end()) {
+        // sorted for the lookups, and without duplicates since each is found once
+        std::sort(destinations.begin(), destinations.end());
+        destinations.erase(std::unique(destinations.begin(), destinations.end()), destinations.end());
+    }
     target_all_visitor(const target_all_visitor& other) = default;
     virtual ~target_all_visitor();
     template <typename graph_type>
     void finish_vertex(vertex_t u, const graph_type&){
-        if (std::find(destinations.begin(), destinations.end(), u) != destinations.end()) {
+        if (std::binary_search(destinations.begin(), destinations.end(), u)) {
             nbFound++;
             if (nbFound == destinations.size()) {
                 throw DestinationFound();
@@ -0,0 +1,103 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#include "street_network_matrix.h"
+#include <atomic>
+
+namespace navitia { namespace georef {
+
+StreetNetworkMatrix::StreetNetworkMatrix(const GeoRef& geo_ref, ThreadPool& pool, size_t nb_threads) :
+    geo_ref(geo_ref), pool(pool), nb_threads(std::max(std::min(nb_threads, pool.nb_threads()), size_t(1))) {}
+
+StreetNetworkMatrix::Matrix
+StreetNetworkMatrix::compute(const std::vector<type::GeographicalCoord>& origins,
+                             const std::vector<type::GeographicalCoord>& destinations,
+                             nt::Mode_e mode,
+                             float speed_factor,
+                             const navitia::time_duration& max_duration) {
+    Matrix matrix(origins.size(), std::vector<RoutingElement>(destinations.size()));
+    if (origins.empty() || destinations.empty()) { return matrix; }
+
+    //on direct path with car we want to arrive on the walking graph
+    const auto dest_mode = mode == nt::Mode_e::Car ? nt::Mode_e::Walking : mode;
+    const auto projections = geo_ref.project_coords(destinations, geo_ref.offsets[dest_mode], pool, nb_threads);
+    std::vector<vertex_t> targets;
+    for (const auto& projection: projections) {
+        if (projection.found) {
+            targets.push_back(projection[ProjectionData::Direction::Source]);
+            targets.push_back(projection[ProjectionData::Direction::Target]);
+        }
+    }
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+
+    const auto* ch = geo_ref.get_contraction_hierarchy(mode);
+    ContractionHierarchy::Buckets buckets;
+    if (ch && ! targets.empty()) {
+        // same weight bound as PathFinder::to_weight, the rows are bounded the same way
+        const std::vector<uint32_t> ch_targets(targets.begin(), targets.end());
+        buckets = ch->build_buckets(ch_targets,
+                                    ContractionHierarchy::Weight(max_duration.ticks() * speed_factor));
+    }
+
+    const auto compute_row = [&](PathFinder& path_finder, size_t origin_idx) {
+        auto& row = matrix[origin_idx];
+        path_finder.init(origins[origin_idx], mode, speed_factor);
+        if (! targets.empty()) {
+            if (ch) {
+                path_finder.start_contraction_hierarchy_buckets(*ch, buckets, targets, max_duration);
+            } else {
+                path_finder.start_distance_or_target_dijkstra(max_duration, targets);
+            }
+        }
+        for (size_t i = 0; i < projections.size(); ++i) {
+            if (projections[i].found) {
+                row[i] = path_finder.get_routing_element(projections[i], max_duration);
+            } else {
+                row[i] = RoutingElement(navitia::time_duration(), RoutingStatus_e::unknown);
+            }
+        }
+    };
+
+    const auto nb_workers = std::min(nb_threads, origins.size());
+    while (path_finders.size() < nb_workers) {
+        path_finders.push_back(std::make_unique<PathFinder>(geo_ref));
+    }
+
+    // the rows are given to the threads one by one, as their durations vary a lot
+    std::atomic<size_t> next_row(0);
+    pool.run(nb_workers, [&](size_t w) {
+        for (auto i = next_row++; i < origins.size(); i = next_row++) {
+            compute_row(*path_finders[w], i);
+        }
+    });
+    return matrix;
+}
+
+}}
@@ -0,0 +1,68 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#pragma once
+#include "street_network.h"
+#include <memory>
+#include <vector>
+
+namespace navitia { namespace georef {
+
+/** Street network durations from N origins to M destinations
+ *
+ * The destinations are projected once for the whole matrix, then the rows are
+ * computed by at most nb_threads threads of the pool of the worker, each one with
+ * its own PathFinder kept between the requests. A row stops its dijkstra as soon
+ * as all the destinations are reached.
+ *
+ * When a contraction hierarchy has been built for the mode, the backward searches
+ * from the destinations are done once in buckets, and each row is only a forward
+ * search in the hierarchy scanning those buckets.
+ */
+class StreetNetworkMatrix {
+public:
+    typedef std::vector<std::vector<RoutingElement>> Matrix;
+
+    StreetNetworkMatrix(const GeoRef& geo_ref, ThreadPool& pool, size_t nb_threads);
+
+    /// durations from each origin (the rows) to each destination (the columns)
+    Matrix compute(const std::vector<type::GeographicalCoord>& origins,
+                   const std::vector<type::GeographicalCoord>& destinations,
+                   nt::Mode_e mode,
+                   float speed_factor,
+                   const navitia::time_duration& max_duration);
+
+private:
+    const GeoRef& geo_ref;
+    ThreadPool& pool;
+    const size_t nb_threads;
+    std::vector<std::unique_ptr<PathFinder>> path_finders;
+};
+
+}}
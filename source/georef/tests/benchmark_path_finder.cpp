@@ -0,0 +1,147 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "georef/street_network.h"
+#include "type/data.h"
+#include "tests/benchmark_utils.h"
+#include <iostream>
+
+/*
+ * Benchmark of the street network fallbacks: PathFinder::init and a
+ * short radius dijkstra from random coordinates of a data.nav.lz4,
+ * compared to what a full reset of the distances costs on the graph,
+ * and the settled vertices by second of the dijkstra on the mode
+ * graphs and on the filtered graph.
+ */
+
+using namespace navitia;
+using namespace navitia::georef;
+using benchmark::Clock;
+using benchmark::elapsed_us;
+
+namespace {
+struct settled_counter: public distance_visitor {
+    size_t& nb_settled;
+    settled_counter(const navitia::time_duration& max_dur,
+                    const std::vector<navitia::time_duration>& dur,
+                    size_t& nb_settled):
+        distance_visitor(max_dur, dur), nb_settled(nb_settled) {}
+    template<typename G>
+    void finish_vertex(vertex_t, const G&) { ++nb_settled; }
+};
+}
+
+int main(int argc, char** argv) {
+    namespace po = boost::program_options;
+    benchmark::CommandLine command_line("Options of the street network fallback benchmark");
+    int nb_searches, radius;
+    command_line.add_options()
+            ("nb_searches,n", po::value<int>(&nb_searches)->default_value(1000),
+                     "Number of searches")
+            ("radius,r", po::value<int>(&radius)->default_value(300),
+                     "Radius of the searches in seconds");
+    if (! command_line.parse(argc, argv)) {
+        return 1;
+    }
+
+    type::Data data;
+    benchmark::load_data(data, command_line.file);
+    const auto& geo_ref = *data.geo_ref;
+    const auto nb_vertices = boost::num_vertices(*geo_ref.graph);
+    if (geo_ref.nb_vertex_by_mode == 0) {
+        std::cout << "no street network" << std::endl;
+        return 1;
+    }
+    std::cout << nb_vertices << " vertices, " << geo_ref.nb_vertex_by_mode << " by mode" << std::endl;
+
+    auto rng = benchmark::make_rng();
+    std::uniform_int_distribution<vertex_t> vertex_gen(0, geo_ref.nb_vertex_by_mode - 1);
+    std::vector<type::GeographicalCoord> coords;
+    for (int i = 0; i < nb_searches; ++i) {
+        coords.push_back((*geo_ref.graph)[vertex_gen(rng)].coord);
+    }
+
+    PathFinder path_finder(geo_ref);
+    double init_us = 0, search_us = 0;
+    size_t nb_touched = 0;
+    for (const auto& coord: coords) {
+        auto begin = Clock::now();
+        path_finder.init(coord, type::Mode_e::Walking, 1);
+        init_us += elapsed_us(begin);
+
+        begin = Clock::now();
+        path_finder.start_distance_dijkstra(navitia::seconds(radius));
+        search_us += elapsed_us(begin);
+        nb_touched += path_finder.touched_vertices.size();
+    }
+
+    // settled vertices by second on the mode graph and on the filtered graph
+    const auto settled_by_second = [&](PathFinder& finder) {
+        size_t nb_settled = 0;
+        double dijkstra_us = 0;
+        for (const auto& coord: coords) {
+            finder.init(coord, type::Mode_e::Walking, 1);
+            if (! finder.starting_edge.found) { continue; }
+            const auto begin = Clock::now();
+            try {
+                finder.dijkstra(finder.starting_edge[ProjectionData::Direction::Source],
+                                settled_counter(navitia::seconds(radius), finder.distances, nb_settled));
+            } catch (DestinationFound) {}
+            dijkstra_us += elapsed_us(begin);
+        }
+        return nb_settled / dijkstra_us * 1e6;
+    };
+    const auto mode_graph_settled = settled_by_second(path_finder);
+    GeoRef filtered_geo_ref;
+    filtered_geo_ref.graph = geo_ref.graph;
+    filtered_geo_ref.offsets = geo_ref.offsets;
+    filtered_geo_ref.nb_vertex_by_mode = geo_ref.nb_vertex_by_mode;
+    filtered_geo_ref.pl = geo_ref.pl;
+    PathFinder filtered_path_finder(filtered_geo_ref);
+    const auto filtered_graph_settled = settled_by_second(filtered_path_finder);
+
+    // what the init did before, resetting every vertex
+    std::vector<navitia::time_duration> distances;
+    double full_reset_us = 0;
+    for (int i = 0; i < std::min(nb_searches, 100); ++i) {
+        const auto begin = Clock::now();
+        distances.assign(nb_vertices, bt::pos_infin);
+        full_reset_us += elapsed_us(begin);
+    }
+
+    std::cout << "init: " << init_us / nb_searches << " us by search" << std::endl
+              << "search: " << search_us / nb_searches << " us by search" << std::endl
+              << "reached vertices: " << double(nb_touched) / nb_searches << " by search" << std::endl
+              << "full reset of the distances: " << full_reset_us / std::min(nb_searches, 100)
+              << " us" << std::endl
+              << "settled vertices by second: " << mode_graph_settled << " on the mode graph, "
+              << filtered_graph_settled << " on the filtered graph" << std::endl;
+    return 0;
+}
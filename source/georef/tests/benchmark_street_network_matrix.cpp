@@ -0,0 +1,125 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "georef/street_network_matrix.h"
+#include "type/data.h"
+#include "tests/benchmark_utils.h"
+#include <iostream>
+
+/*
+ * Benchmark of the street network matrices of N origins by M destinations
+ * taken at random on the vertices of a data.nav.lz4: a dijkstra by origin
+ * as done before, then the StreetNetworkMatrix with one and several threads.
+ * The matrix uses the contraction hierarchy of the mode if ed2nav built it.
+ */
+
+using namespace navitia;
+using namespace navitia::georef;
+using benchmark::Clock;
+using benchmark::elapsed_ms;
+
+int main(int argc, char** argv) {
+    namespace po = boost::program_options;
+    benchmark::CommandLine command_line("Options of the street network matrix benchmark");
+    std::string mode_name;
+    int nb_origins, nb_destinations, radius, nb_threads;
+    command_line.add_options()
+            ("nb_origins,n", po::value<int>(&nb_origins)->default_value(50),
+                     "Number of origins")
+            ("nb_destinations,m", po::value<int>(&nb_destinations)->default_value(500),
+                     "Number of destinations")
+            ("radius,r", po::value<int>(&radius)->default_value(1800),
+                     "Max duration in seconds")
+            ("nb_threads,t", po::value<int>(&nb_threads)->default_value(4),
+                     "Number of threads of the matrix")
+            ("mode", po::value<std::string>(&mode_name)->default_value("walking"),
+                     "Street network mode: walking, bike or car");
+    if (! command_line.parse(argc, argv)) {
+        return 1;
+    }
+    type::Mode_e mode = type::Mode_e::Walking;
+    if (mode_name == "bike") {
+        mode = type::Mode_e::Bike;
+    } else if (mode_name == "car") {
+        mode = type::Mode_e::Car;
+    }
+
+    type::Data data;
+    benchmark::load_data(data, command_line.file);
+    const auto& geo_ref = *data.geo_ref;
+    if (geo_ref.nb_vertex_by_mode == 0) {
+        std::cout << "no street network" << std::endl;
+        return 1;
+    }
+
+    auto rng = benchmark::make_rng();
+    std::uniform_int_distribution<vertex_t> vertex_gen(0, geo_ref.nb_vertex_by_mode - 1);
+    const auto random_coords = [&](int nb) {
+        std::vector<type::GeographicalCoord> coords;
+        for (int i = 0; i < nb; ++i) {
+            coords.push_back((*geo_ref.graph)[vertex_gen(rng)].coord);
+        }
+        return coords;
+    };
+    const auto origins = random_coords(nb_origins);
+    const auto destinations = random_coords(nb_destinations);
+    const auto max_duration = navitia::seconds(radius);
+
+    // a dijkstra by origin, as Worker::street_network_routing_matrix did
+    auto begin = Clock::now();
+    PathFinder path_finder(geo_ref);
+    size_t nb_reached = 0;
+    for (const auto& origin: origins) {
+        path_finder.init(origin, mode, 1);
+        for (const auto& elt: path_finder.get_duration_with_dijkstra(max_duration, destinations)) {
+            if (elt.second.routing_status == RoutingStatus_e::reached) { ++nb_reached; }
+        }
+    }
+    const auto by_origin_ms = elapsed_ms(begin);
+
+    const auto matrix_ms = [&](size_t threads) {
+        navitia::ThreadPool pool(threads);
+        StreetNetworkMatrix matrix(geo_ref, pool, threads);
+        const auto start = Clock::now();
+        matrix.compute(origins, destinations, mode, 1, max_duration);
+        return elapsed_ms(start);
+    };
+    const auto one_thread_ms = matrix_ms(1);
+    const auto threads_ms = matrix_ms(nb_threads);
+
+    std::cout << nb_origins << "x" << nb_destinations << " matrix, "
+              << (geo_ref.get_contraction_hierarchy(mode) ? "with" : "without")
+              << " contraction hierarchy" << std::endl
+              << "reached: " << nb_reached << std::endl
+              << "dijkstra by origin: " << by_origin_ms << " ms" << std::endl
+              << "matrix, 1 thread: " << one_thread_ms << " ms" << std::endl
+              << "matrix, " << nb_threads << " threads: " << threads_ms << " ms" << std::endl;
+    return 0;
+}
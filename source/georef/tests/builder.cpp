@@ -37,16 +37,18 @@ GraphBuilder & GraphBuilder::add_vertex(std::string node_name, float x, float y)
     vertex_t v;
     type::GeographicalCoord coord;
     coord.set_xy(x,y);
+    auto& graph = mutable_part(this->geo_ref.graph);
     if(it  == this->vertex_map.end()){
-        v = boost::add_vertex(this->geo_ref.graph);
+        v = boost::add_vertex(graph);
         vertex_map[node_name] = v;
     } else {
         v = it->second;
     }
 
-    this->geo_ref.graph[v].coord = coord;
-    this->geo_ref.pl.add(coord, v);
-    this->geo_ref.pl.build();
+    graph[v].coord = coord;
+    auto& pl = mutable_part(this->geo_ref.pl);
+    pl.add(coord, v);
+    pl.build();
     return *this;
 }
 
@@ -70,15 +72,16 @@ GraphBuilder & GraphBuilder::add_edge(std::string source_name, std::string targe
     this->geo_ref.ways.push_back(way);
     edge.way_idx = way->idx;
 
-    boost::add_edge(source, target, edge, this->geo_ref.graph);
+    auto& graph = mutable_part(this->geo_ref.graph);
+    boost::add_edge(source, target, edge, graph);
     if(bidirectionnal)
-        boost::add_edge(target, source, edge, this->geo_ref.graph);
+        boost::add_edge(target, source, edge, graph);
 
     return *this;
 }
 
 GraphBuilder& GraphBuilder::add_geom(edge_t edge_ref, const nt::LineString& geom) {
-    auto& edge = this->geo_ref.graph[edge_ref];
+    auto& edge = mutable_part(this->geo_ref.graph)[edge_ref];
     if(edge.way_idx == nt::invalid_idx) {
         Way* way = new Way();
         way->idx = this->geo_ref.ways.size();
@@ -102,7 +105,7 @@ edge_t GraphBuilder::get(const std::string &source_name, const std::string &targ
     vertex_t target = this->get(target_name);
     edge_t e;
     bool b;
-    boost::tie(e,b) =  boost::edge(source, target, this->geo_ref.graph);
+    boost::tie(e,b) =  boost::edge(source, target, *this->geo_ref.graph);
     if(!b) throw proximitylist::NotFound();
     else return e;
 }
@@ -40,6 +40,7 @@ www.navitia.io
 #include "builder.h"
 #include "ed/build_helper.h"
 #include "georef/street_network.h"
+#include "georef/segment_distance.h"
 #include <boost/graph/detail/adjacency_list.hpp>
 
 struct logger_initialized {
@@ -82,17 +83,17 @@ BOOST_AUTO_TEST_CASE(init_test) {
 
     b("a", 0, 0)("b", 1, 1)("c", 2, 2)("d", 3, 3)("e", 4, 4);
     b("a", "b")("b","c")("c","d")("d","e")("e","d"); //bug ? if no edge leave the vertex, the projection cannot work...
-    b.geo_ref.graph[b.get("a","b")].way_idx = 0;
-    b.geo_ref.graph[b.get("b","c")].way_idx = 0;
-    b.geo_ref.graph[b.get("c","d")].way_idx = 1;
-    b.geo_ref.graph[b.get("d","e")].way_idx = 1;
-    b.geo_ref.graph[b.get("e","d")].way_idx = 1;
+    mutable_part(b.geo_ref.graph)[b.get("a","b")].way_idx = 0;
+    mutable_part(b.geo_ref.graph)[b.get("b","c")].way_idx = 0;
+    mutable_part(b.geo_ref.graph)[b.get("c","d")].way_idx = 1;
+    mutable_part(b.geo_ref.graph)[b.get("d","e")].way_idx = 1;
+    mutable_part(b.geo_ref.graph)[b.get("e","d")].way_idx = 1;
 
-    BOOST_CHECK_EQUAL(boost::num_vertices(b.geo_ref.graph), 5);
+    BOOST_CHECK_EQUAL(boost::num_vertices(*b.geo_ref.graph), 5);
 
     b.geo_ref.init();
 
-    BOOST_CHECK_EQUAL(boost::num_vertices(b.geo_ref.graph), 15); //one graph for each transportation mode save VLS
+    BOOST_CHECK_EQUAL(boost::num_vertices(*b.geo_ref.graph), 15); //one graph for each transportation mode save VLS
 
     BOOST_CHECK_EQUAL(b.geo_ref.offsets[Mode_e::Walking], 0);
     BOOST_CHECK_EQUAL(b.geo_ref.offsets[Mode_e::Bike], 5);
@@ -102,7 +103,7 @@ BOOST_AUTO_TEST_CASE(init_test) {
 
 BOOST_AUTO_TEST_CASE(outil_de_graph) {
     GraphBuilder builder;
-    Graph & g = builder.geo_ref.graph;
+    const Graph& g = *builder.geo_ref.graph;
 
     BOOST_CHECK_EQUAL(num_vertices(g), 0);
     BOOST_CHECK_EQUAL(num_edges(g), 0);
@@ -162,6 +163,72 @@ BOOST_AUTO_TEST_CASE(nearest_segment){
     BOOST_CHECK_EQUAL(b.geo_ref.nearest_edge(c), b.get("o", "c"));
 }
 
+BOOST_AUTO_TEST_CASE(segment_distances) {
+    using navitia::type::GeographicalCoord;
+    const GeographicalCoord coord(2.3522, 48.8566);
+    const double coslat = ::cos(coord.lat() * GeographicalCoord::N_DEG_TO_RAD);
+
+    // odd number of segments to test the remainder, with a zero length one
+    Segments segments;
+    segments.push_back({2.35, 48.85}, {2.36, 48.86});
+    segments.push_back({2.3522, 48.8566}, {2.3522, 48.8566});
+    segments.push_back({2.30, 48.80}, {2.31, 48.80});
+    segments.push_back({2.36, 48.86}, {2.35, 48.87});
+    segments.push_back({2.3522, 48.85}, {2.3522, 48.86});
+
+    std::vector<float> distances(segments.size());
+    std::vector<float> scalar_distances(segments.size());
+    approx_segment_distances(coord, coslat, segments, distances.data());
+    scalar_approx_segment_distances(coord, coslat, segments, scalar_distances.data());
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const GeographicalCoord start(segments.start_lons[i], segments.start_lats[i]);
+        const GeographicalCoord end(segments.end_lons[i], segments.end_lats[i]);
+        const float expected = coord.approx_project(start, end, coslat).second;
+        BOOST_CHECK_EQUAL(distances[i], expected);
+        BOOST_CHECK_EQUAL(scalar_distances[i], expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(project_coords) {
+    GraphBuilder b;
+
+    /*               a           e
+                     |
+                  b—–o––c
+                     |
+                     d             */
+
+    b("a", 0,10)("b", -10, 0)("c",10,0)("d",0,-10)("o",0,0)("e", 50,10);
+    b("o", "a")("o","b")("o","c")("o","d")("b","o");
+    b.geo_ref.init();
+
+    std::vector<navitia::type::GeographicalCoord> coords;
+    for (int x = -20; x <= 60; x += 3) {
+        for (int y = -20; y <= 20; y += 3) {
+            coords.emplace_back(x, y, false);
+        }
+    }
+    // too far to be projected
+    coords.emplace_back(5000, 5000, false);
+
+    for (size_t nb_threads: {1, 4}) {
+        const auto projections = b.geo_ref.project_coords(coords, 0, nb_threads);
+        BOOST_REQUIRE_EQUAL(projections.size(), coords.size());
+        for (size_t i = 0; i < coords.size(); ++i) {
+            const ProjectionData expected(coords[i], b.geo_ref, 0, *b.geo_ref.pl);
+            BOOST_REQUIRE_EQUAL(projections[i].found, expected.found);
+            BOOST_CHECK_EQUAL(projections[i][ProjectionData::Direction::Source],
+                              expected[ProjectionData::Direction::Source]);
+            BOOST_CHECK_EQUAL(projections[i][ProjectionData::Direction::Target],
+                              expected[ProjectionData::Direction::Target]);
+            if (expected.found) {
+                BOOST_CHECK_EQUAL(projections[i].projected, expected.projected);
+            }
+        }
+    }
+    BOOST_CHECK(! b.geo_ref.project_coords(coords, 0).back().found);
+}
+
 BOOST_AUTO_TEST_CASE(real_nearest_edge){
     GraphBuilder b;
 
@@ -179,7 +246,7 @@ BOOST_AUTO_TEST_CASE(real_nearest_edge){
 
 /// Compute the path from the starting point to the the target geographical coord
 static Path compute_path(PathFinder& finder, const navitia::type::GeographicalCoord& target_coord) {
-    ProjectionData dest(target_coord, finder.geo_ref, finder.geo_ref.pl);
+    ProjectionData dest(target_coord, finder.geo_ref, *finder.geo_ref.pl);
 
     auto best_pair = finder.update_path(dest);
 
@@ -447,8 +514,8 @@ BOOST_AUTO_TEST_CASE(parallel_and_same_vertex_edges) {
     geom.push_back(nt::GeographicalCoord(0, 0, false));
     geom.push_back(nt::GeographicalCoord(50, 0, false));
     geom.push_back(nt::GeographicalCoord(50, 50, false));
-    BOOST_FOREACH(const auto out_edge, boost::out_edges(b.get("a"), b.geo_ref.graph)) {
-        if(boost::target(out_edge, b.geo_ref.graph) == b.get("a")) {
+    BOOST_FOREACH(const auto out_edge, boost::out_edges(b.get("a"), *b.geo_ref.graph)) {
+        if(boost::target(out_edge, *b.geo_ref.graph) == b.get("a")) {
             b.add_geom(out_edge, geom);
             std::reverse(geom.begin(), geom.end());
         }
@@ -462,28 +529,28 @@ BOOST_AUTO_TEST_CASE(parallel_and_same_vertex_edges) {
     short_geom_bc.push_back(nt::GeographicalCoord(200, 50, false));
     short_geom_bc.push_back(nt::GeographicalCoord(250, 50, false));
 
-    BOOST_FOREACH(const auto out_edge, boost::out_edges(b.get("b"), b.geo_ref.graph)) {
-        if(boost::target(out_edge, b.geo_ref.graph) == b.get("c")) {
-            b.add_geom(out_edge, b.geo_ref.graph[out_edge].duration.total_seconds() == 50 ? short_geom_bc : long_geom_bc);
+    BOOST_FOREACH(const auto out_edge, boost::out_edges(b.get("b"), *b.geo_ref.graph)) {
+        if(boost::target(out_edge, *b.geo_ref.graph) == b.get("c")) {
+            b.add_geom(out_edge, (*b.geo_ref.graph)[out_edge].duration.total_seconds() == 50 ? short_geom_bc : long_geom_bc);
         }
     }
     std::reverse(long_geom_bc.begin(), long_geom_bc.end());
     std::reverse(short_geom_bc.begin(), short_geom_bc.end());
-    BOOST_FOREACH(const auto out_edge, boost::out_edges(b.get("c"), b.geo_ref.graph)) {
-        if(boost::target(out_edge, b.geo_ref.graph) == b.get("b")) {
-            b.add_geom(out_edge, b.geo_ref.graph[out_edge].duration.total_seconds() == 50 ? short_geom_bc : long_geom_bc);
+    BOOST_FOREACH(const auto out_edge, boost::out_edges(b.get("c"), *b.geo_ref.graph)) {
+        if(boost::target(out_edge, *b.geo_ref.graph) == b.get("b")) {
+            b.add_geom(out_edge, (*b.geo_ref.graph)[out_edge].duration.total_seconds() == 50 ? short_geom_bc : long_geom_bc);
         }
     }
 
     b.geo_ref.init();
 
     auto edge_x1 = b.geo_ref.nearest_edge(x1);
-    BOOST_REQUIRE_EQUAL(boost::source(edge_x1, b.geo_ref.graph), b.get("a"));
-    BOOST_REQUIRE_EQUAL(boost::target(edge_x1, b.geo_ref.graph), b.get("a"));
+    BOOST_REQUIRE_EQUAL(boost::source(edge_x1, *b.geo_ref.graph), b.get("a"));
+    BOOST_REQUIRE_EQUAL(boost::target(edge_x1, *b.geo_ref.graph), b.get("a"));
     auto edge_x4 = b.geo_ref.nearest_edge(x4);
-    BOOST_REQUIRE_EQUAL(boost::source(edge_x4, b.geo_ref.graph), b.get("b"));
-    BOOST_REQUIRE_EQUAL(boost::target(edge_x4, b.geo_ref.graph), b.get("c"));
-    BOOST_REQUIRE_EQUAL(b.geo_ref.graph[edge_x4].duration.total_seconds(), 300);
+    BOOST_REQUIRE_EQUAL(boost::source(edge_x4, *b.geo_ref.graph), b.get("b"));
+    BOOST_REQUIRE_EQUAL(boost::target(edge_x4, *b.geo_ref.graph), b.get("c"));
+    BOOST_REQUIRE_EQUAL((*b.geo_ref.graph)[edge_x4].duration.total_seconds(), 300);
 
     StreetNetwork worker(b.geo_ref);
     auto origin = nt::EntryPoint();;
@@ -628,11 +695,11 @@ BOOST_AUTO_TEST_CASE(compute_directions_test) {
 
     b("a", 0, 0)("b", 1, 1)("c", 2, 2)("d", 3, 3)("e", 4, 4);
     b("a", "b")("b","c")("c","d")("d","e")("e","d"); //bug ? if no edge leave the vertex, the projection cannot work...
-    b.geo_ref.graph[b.get("a","b")].way_idx = 0;
-    b.geo_ref.graph[b.get("b","c")].way_idx = 0;
-    b.geo_ref.graph[b.get("c","d")].way_idx = 1;
-    b.geo_ref.graph[b.get("d","e")].way_idx = 1;
-    b.geo_ref.graph[b.get("e","d")].way_idx = 1;
+    mutable_part(b.geo_ref.graph)[b.get("a","b")].way_idx = 0;
+    mutable_part(b.geo_ref.graph)[b.get("b","c")].way_idx = 0;
+    mutable_part(b.geo_ref.graph)[b.get("c","d")].way_idx = 1;
+    mutable_part(b.geo_ref.graph)[b.get("d","e")].way_idx = 1;
+    mutable_part(b.geo_ref.graph)[b.get("e","d")].way_idx = 1;
 
     b.geo_ref.init();
 
@@ -685,23 +752,23 @@ BOOST_AUTO_TEST_CASE(compute_coord){
     w = new Way;
     w->name = "BobDB";
     b.geo_ref.ways.push_back(w);
-    b.geo_ref.graph[b.get("a","b")].way_idx = 0;
-    b.geo_ref.graph[b.get("b","a")].way_idx = 0;
+    mutable_part(b.geo_ref.graph)[b.get("a","b")].way_idx = 0;
+    mutable_part(b.geo_ref.graph)[b.get("b","a")].way_idx = 0;
 
     auto vertex_a = b.get("a"), vertex_c = b.get("c");
-    for (auto range = out_edges(vertex_a, b.geo_ref.graph); range.first != range.second; ++range.first) {
-        if (target(*range.first, b.geo_ref.graph) != vertex_c) { continue; }
-        b.geo_ref.graph[*range.first].way_idx = 1;
+    for (auto range = out_edges(vertex_a, *b.geo_ref.graph); range.first != range.second; ++range.first) {
+        if (target(*range.first, *b.geo_ref.graph) != vertex_c) { continue; }
+        mutable_part(b.geo_ref.graph)[*range.first].way_idx = 1;
     }
-    for (auto range = out_edges(vertex_c, b.geo_ref.graph); range.first != range.second; ++range.first) {
-        if (target(*range.first, b.geo_ref.graph) != vertex_a) { continue; }
-        b.geo_ref.graph[*range.first].way_idx = 1;
+    for (auto range = out_edges(vertex_c, *b.geo_ref.graph); range.first != range.second; ++range.first) {
+        if (target(*range.first, *b.geo_ref.graph) != vertex_a) { continue; }
+        mutable_part(b.geo_ref.graph)[*range.first].way_idx = 1;
     }
 
-    b.geo_ref.graph[b.get("c","d")].way_idx = 2;
-    b.geo_ref.graph[b.get("d","c")].way_idx = 2;
-    b.geo_ref.graph[b.get("d","b")].way_idx = 3;
-    b.geo_ref.graph[b.get("b","d")].way_idx = 3;
+    mutable_part(b.geo_ref.graph)[b.get("c","d")].way_idx = 2;
+    mutable_part(b.geo_ref.graph)[b.get("d","c")].way_idx = 2;
+    mutable_part(b.geo_ref.graph)[b.get("d","b")].way_idx = 3;
+    mutable_part(b.geo_ref.graph)[b.get("b","d")].way_idx = 3;
 
     GeographicalCoord start;
     start.set_xy(3, -1);
@@ -1095,17 +1162,18 @@ BOOST_AUTO_TEST_CASE(build_autocomplete_test){
     hn.number = 4;
     way->add_house_number(hn);
     v.coord = hn.coord;
-    vertex_t debut = boost::add_vertex(v, b.data->geo_ref->graph);
+    auto& graph = mutable_part(b.data->geo_ref->graph);
+    vertex_t debut = boost::add_vertex(v, graph);
 
     hn.coord.set_lon(2.0);
     hn.coord.set_lat(8.0);
     hn.number = 8;
     way->add_house_number(hn);
     v.coord = hn.coord;
-    vertex_t fin = boost::add_vertex(v, b.data->geo_ref->graph);
+    vertex_t fin = boost::add_vertex(v, graph);
 
-    boost::add_edge(debut, fin, navitia::georef::Edge{way->idx, 1_s}, b.data->geo_ref->graph);
-    boost::add_edge(fin, debut, navitia::georef::Edge{way->idx, 1_s}, b.data->geo_ref->graph);
+    boost::add_edge(debut, fin, navitia::georef::Edge{way->idx, 1_s}, graph);
+    boost::add_edge(fin, debut, navitia::georef::Edge{way->idx, 1_s}, graph);
     way->edges.push_back(std::make_pair(debut, fin));
     way->edges.push_back(std::make_pair(fin, debut));
 
@@ -1114,10 +1182,10 @@ BOOST_AUTO_TEST_CASE(build_autocomplete_test){
     hn.number = 18;
     way->add_house_number(hn);
     v.coord = hn.coord;
-    debut = boost::add_vertex(v, b.data->geo_ref->graph);
+    debut = boost::add_vertex(v, graph);
 
-    boost::add_edge(fin, debut, navitia::georef::Edge{way->idx, 1_s}, b.data->geo_ref->graph);
-    boost::add_edge(debut, fin, navitia::georef::Edge{way->idx, 1_s}, b.data->geo_ref->graph);
+    boost::add_edge(fin, debut, navitia::georef::Edge{way->idx, 1_s}, graph);
+    boost::add_edge(debut, fin, navitia::georef::Edge{way->idx, 1_s}, graph);
     way->edges.push_back(std::make_pair(fin, debut));
     way->edges.push_back(std::make_pair(debut, fin));
 
@@ -1125,10 +1193,10 @@ BOOST_AUTO_TEST_CASE(build_autocomplete_test){
     hn.number = 54;
     way->add_house_number(hn);
     v.coord = hn.coord;
-    fin = boost::add_vertex(v, b.data->geo_ref->graph);
+    fin = boost::add_vertex(v, graph);
 
-    boost::add_edge(debut, fin, navitia::georef::Edge{way->idx, 1_s}, b.data->geo_ref->graph);
-    boost::add_edge(fin, debut, navitia::georef::Edge{way->idx, 1_s}, b.data->geo_ref->graph);
+    boost::add_edge(debut, fin, navitia::georef::Edge{way->idx, 1_s}, graph);
+    boost::add_edge(fin, debut, navitia::georef::Edge{way->idx, 1_s}, graph);
     way->edges.push_back(std::make_pair(debut, fin));
     way->edges.push_back(std::make_pair(fin, debut));
     b.data->geo_ref->ways.push_back(way);
@@ -1329,11 +1397,12 @@ BOOST_AUTO_TEST_CASE(geolocalization) {
 
     ed::builder b = {"20140828"};
 
-    boost::add_vertex(navitia::georef::Vertex(A),b.data->geo_ref->graph);
-    boost::add_vertex(navitia::georef::Vertex(B),b.data->geo_ref->graph);
-    boost::add_vertex(navitia::georef::Vertex(C),b.data->geo_ref->graph);
-    boost::add_vertex(navitia::georef::Vertex(D),b.data->geo_ref->graph);
-    boost::add_vertex(navitia::georef::Vertex(E),b.data->geo_ref->graph);
+    auto& graph = mutable_part(b.data->geo_ref->graph);
+    boost::add_vertex(navitia::georef::Vertex(A), graph);
+    boost::add_vertex(navitia::georef::Vertex(B), graph);
+    boost::add_vertex(navitia::georef::Vertex(C), graph);
+    boost::add_vertex(navitia::georef::Vertex(D), graph);
+    boost::add_vertex(navitia::georef::Vertex(E), graph);
     b.data->geo_ref->init();
 
     b.data->geo_ref->admins.push_back(new navitia::georef::Admin());
@@ -1361,14 +1430,14 @@ BOOST_AUTO_TEST_CASE(geolocalization) {
     b.data->geo_ref->ways.push_back(ac);
 
     // A->B
-    add_edge(AA, BB, Edge(0, 42_s), b.data->geo_ref->graph);
-    add_edge(BB, AA, Edge(0, 42_s), b.data->geo_ref->graph);
+    add_edge(AA, BB, Edge(0, 42_s), graph);
+    add_edge(BB, AA, Edge(0, 42_s), graph);
     ab->edges.push_back(std::make_pair(AA, BB));
     ab->edges.push_back(std::make_pair(BB, AA));
 
     // A->C
-    add_edge(AA, CC, Edge(1, 42_s), b.data->geo_ref->graph);
-    add_edge(CC, AA, Edge(1, 42_s), b.data->geo_ref->graph);
+    add_edge(AA, CC, Edge(1, 42_s), graph);
+    add_edge(CC, AA, Edge(1, 42_s), graph);
     ac->edges.push_back(std::make_pair(AA, CC));
     ac->edges.push_back(std::make_pair(CC, AA));
 
@@ -1492,3 +1561,158 @@ BOOST_AUTO_TEST_CASE(find_nearest_on_same_edge){
         BOOST_CHECK_EQUAL(elt.second, w.get_path(elt.first.val, false).duration);
     }
 }
+
+// the durations computed from the stop point duration cache are the ones of the dijkstra
+BOOST_AUTO_TEST_CASE(find_nearest_with_stop_point_duration_cache){
+    using namespace navitia::type;
+
+    GraphBuilder b;
+
+    /*              0          1
+     *              +          +
+     *    o-----------o---------------------o----------------o
+     *    a           b        |            c                d
+     *                     +   |         +
+     *                     2   o e       3         + 4
+     */
+
+    b("a", 0, 0)("b", 100, 0)("c", 300, 0)("d", 400, 0)("e", 180, -100);
+    b("a", "b", 100_s, true)("b", "c", 200_s, true)("c", "d", 100_s, true)("b", "e", 150_s, true)("e", "c", 150_s, true);
+
+    const std::vector<GeographicalCoord> coords = {
+        GeographicalCoord(120, 10, false), GeographicalCoord(250, 20, false), GeographicalCoord(110, -10, false),
+        GeographicalCoord(280, -30, false), GeographicalCoord(350, -20, false)};
+    navitia::proximitylist::ProximityList<idx_t> pl;
+    std::vector<StopPoint*> stop_points;
+    for (idx_t i = 0; i < coords.size(); ++i) {
+        pl.add(coords[i], i);
+        stop_points.push_back(new StopPoint());
+        stop_points.back()->idx = i;
+        stop_points.back()->coord = coords[i];
+    }
+    pl.build();
+    b.geo_ref.init();
+    b.geo_ref.project_stop_points(stop_points);
+
+    StopPointDurationCache cache(1000);
+    StreetNetwork w(b.geo_ref);
+    StreetNetwork cached_w(b.geo_ref, &cache);
+    std::vector<GeographicalCoord> starts = coords;
+    starts.push_back(GeographicalCoord(0, 0, false));
+    starts.push_back(GeographicalCoord(100, 0, false));
+    starts.push_back(GeographicalCoord(170, -80, false));
+    uint64_t nb_cache_miss = 0;
+    for (size_t i = 0; i < 2; ++i) {
+        nb_cache_miss = cache.get_stats().nb_cache_miss;
+        for (const auto& start: starts) {
+            for (const auto radius: {10_s, 100_s, 180_s, 500_s}) {
+                EntryPoint starting_point;
+                starting_point.coordinates = start;
+                starting_point.streetnetwork_params.mode = Mode_e::Walking;
+                starting_point.streetnetwork_params.speed_factor = 1;
+                w.init(starting_point);
+                cached_w.init(starting_point);
+                const auto res = w.find_nearest_stop_points(radius, pl, false);
+                const auto cached_res = cached_w.find_nearest_stop_points(radius, pl, false);
+                BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), cached_res.begin(), cached_res.end());
+
+                for (const auto& elt: cached_res) {
+                    BOOST_CHECK_EQUAL(w.get_path(elt.first.val, false).duration,
+                                      cached_w.get_path(elt.first.val, false).duration);
+                }
+            }
+        }
+    }
+    // the second time, all the durations come from the cache
+    const auto stats = cache.get_stats();
+    BOOST_CHECK(stats.nb_cache_miss > 0);
+    BOOST_CHECK_EQUAL(stats.nb_cache_miss, nb_cache_miss);
+    BOOST_CHECK_EQUAL(stats.nb_dropped, 0);
+
+    for (auto* sp: stop_points) { delete sp; }
+}
+
+// with the stop point duration cache, the durations and the paths of the stop
+// points projected on a one way edge are the ones of the dijkstra
+BOOST_AUTO_TEST_CASE(stop_point_duration_cache_one_way){
+    using namespace navitia::type;
+
+    GraphBuilder b;
+
+    /*    0
+     *    +
+     *    o--------->o------------o
+     *    a          b            c
+     *                          +
+     *                        start
+     */
+
+    b("a", 0, 0)("b", 100, 0)("c", 200, 0);
+    b("a", "b", 100_s)("b", "c", 100_s, true);
+
+    navitia::proximitylist::ProximityList<idx_t> pl;
+    std::vector<StopPoint*> stop_points = {new StopPoint()};
+    stop_points.front()->idx = 0;
+    stop_points.front()->coord = GeographicalCoord(10, 10, false);
+    pl.add(stop_points.front()->coord, 0);
+    pl.build();
+    b.geo_ref.init();
+    b.geo_ref.project_stop_points(stop_points);
+
+    StopPointDurationCache cache(1000);
+    StreetNetwork w(b.geo_ref);
+    StreetNetwork cached_w(b.geo_ref, &cache);
+    EntryPoint starting_point;
+    starting_point.coordinates = GeographicalCoord(190, -5, false);
+    starting_point.streetnetwork_params.mode = Mode_e::Walking;
+    starting_point.streetnetwork_params.speed_factor = 1;
+    w.init(starting_point);
+    cached_w.init(starting_point);
+
+    // a can't be reached, the stop point is reached by b
+    const auto res = w.find_nearest_stop_points(500_s, pl, false);
+    const auto cached_res = cached_w.find_nearest_stop_points(500_s, pl, false);
+    BOOST_REQUIRE_EQUAL(cached_res.size(), 1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), cached_res.begin(), cached_res.end());
+
+    const auto duration = cached_res.begin()->second;
+    BOOST_CHECK_EQUAL(cached_w.get_distance(0, false), duration);
+    const auto path = cached_w.get_path(0, false);
+    BOOST_CHECK_EQUAL(path.duration, duration);
+    BOOST_CHECK_EQUAL(path.duration, w.get_path(0, false).duration);
+    // the second path comes from the same search
+    BOOST_CHECK_EQUAL(cached_w.get_path(0, false).duration, duration);
+
+    for (auto* sp: stop_points) { delete sp; }
+}
+
+// the graph is serialized through a FlatGraph, we check that the round trip
+// gives back the same vertices and edges
+BOOST_AUTO_TEST_CASE(flat_graph_round_trip) {
+    GraphBuilder b;
+
+    b("a", 0, 0)("b", 100, 0)("c", 300, 0)("d", 400, 50);
+    b("a", "b", 100_s, true)("b", "c", 200_s, true)("c", "d", 100_s)("d", "a", 42_s);
+    mutable_part(b.geo_ref.graph)[b.get("a", "b")].way_idx = 3;
+    mutable_part(b.geo_ref.graph)[b.get("c", "d")].geom_idx = 7;
+
+    const FlatGraph flat_graph(*b.geo_ref.graph);
+    Graph graph;
+    flat_graph.fill_graph(graph);
+
+    const Graph& ref = *b.geo_ref.graph;
+    BOOST_REQUIRE_EQUAL(num_vertices(graph), num_vertices(ref));
+    BOOST_REQUIRE_EQUAL(num_edges(graph), num_edges(ref));
+    for (vertex_t v = 0; v < num_vertices(ref); ++v) {
+        BOOST_CHECK_EQUAL(graph[v].coord, ref[v].coord);
+        BOOST_REQUIRE_EQUAL(out_degree(v, graph), out_degree(v, ref));
+        auto it = out_edges(v, graph).first;
+        BOOST_FOREACH(edge_t e, out_edges(v, ref)) {
+            BOOST_CHECK_EQUAL(target(*it, graph), target(e, ref));
+            BOOST_CHECK_EQUAL(graph[*it].way_idx, ref[e].way_idx);
+            BOOST_CHECK_EQUAL(graph[*it].geom_idx, ref[e].geom_idx);
+            BOOST_CHECK_EQUAL(graph[*it].duration, ref[e].duration);
+            ++it;
+        }
+    }
+}
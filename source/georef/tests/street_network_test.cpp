@@ -36,6 +36,7 @@ www.navitia.io
 #include "type/pt_data.h"
 
 #include"georef/street_network.h"
+#include "georef/street_network_matrix.h"
 #include <boost/test/unit_test.hpp>
 
 using namespace navitia::georef;
@@ -72,6 +73,376 @@ static std::string get_name(int i, int j) {
     std::stringstream ss; ss << i << "_" << j; return ss.str();
 }
 
+/*
+ * Build the same dumb square graph as idempotence
+ */
+static void build_square_graph(GraphBuilder& b, size_t square_size) {
+    for (size_t i = 0; i < square_size ; ++i) {
+        for (size_t j = 0; j < square_size ; ++j) {
+            b(get_name(i, j), i, j);
+        }
+    }
+    for (size_t i = 0; i < square_size - 1; ++i) {
+        for (size_t j = 0; j < square_size - 1; ++j) {
+            std::string name(get_name(i, j));
+            b.add_edge(name, get_name(i, j + 1), navitia::seconds((i + j) * j));
+            b.add_edge(name, get_name(i + 1, j), navitia::seconds((i + j) * i));
+        }
+    }
+}
+
+/*
+ * init only resets the vertices reached by the previous search: a
+ * PathFinder reused from another starting point must give the same
+ * distances as a new one
+ */
+BOOST_AUTO_TEST_CASE(reinit_from_another_start) {
+    GraphBuilder b;
+    build_square_graph(b, 10);
+    b.geo_ref.init();
+    b.geo_ref.build_proximity_list();
+
+    type::GeographicalCoord start, other_start;
+    start.set_xy(2., 2.);
+    other_start.set_xy(7., 3.);
+    const auto speed = georef::default_speed[type::Mode_e::Walking];
+
+    PathFinder reused(b.geo_ref);
+    reused.init(start, type::Mode_e::Walking, speed);
+    reused.start_distance_dijkstra(navitia::seconds(1000));
+    BOOST_CHECK(! reused.touched_vertices.empty());
+    reused.init(other_start, type::Mode_e::Walking, speed);
+    reused.start_distance_dijkstra(navitia::seconds(50));
+
+    PathFinder fresh(b.geo_ref);
+    fresh.init(other_start, type::Mode_e::Walking, speed);
+    fresh.start_distance_dijkstra(navitia::seconds(50));
+
+    BOOST_REQUIRE_EQUAL(reused.distances.size(), fresh.distances.size());
+    for (size_t i = 0; i < fresh.distances.size(); ++i) {
+        BOOST_CHECK_EQUAL(reused.distances[i], fresh.distances[i]);
+    }
+}
+
+/*
+ * with a one way street, only one end of the projected edge may be
+ * reached: the nearest vertex is the reached end, and the target is
+ * unreached only if none of its ends is reached
+ *
+ * a <-> b <- c        d <-> e
+ */
+BOOST_AUTO_TEST_CASE(nearest_vertex_reached_by_one_end) {
+    GraphBuilder b;
+    b("a", 0, 0)("b", 100, 0)("c", 200, 0)("d", 1000, 0)("e", 1100, 0);
+    b("a", "b", navitia::seconds(100), true);
+    b("c", "b", navitia::seconds(100));
+    b("d", "e", navitia::seconds(100), true);
+    b.geo_ref.init();
+    b.geo_ref.build_proximity_list();
+
+    type::GeographicalCoord start, on_one_way, unreachable;
+    start.set_xy(0., 0.);
+    on_one_way.set_xy(150., 5.);
+    unreachable.set_xy(1050., 5.);
+
+    PathFinder worker(b.geo_ref);
+    worker.init(start, type::Mode_e::Walking, georef::default_speed[type::Mode_e::Walking]);
+    worker.start_distance_dijkstra(navitia::seconds(1000));
+
+    const ProjectionData target(on_one_way, b.geo_ref, *b.geo_ref.pl);
+    BOOST_REQUIRE(target.found);
+    BOOST_REQUIRE_EQUAL(target[dir::Source], b.vertex_map.at("c"));
+    BOOST_REQUIRE_EQUAL(target[dir::Target], b.vertex_map.at("b"));
+    BOOST_CHECK(worker.distances[b.vertex_map.at("c")].is_pos_infinity());
+    const auto dist_b = worker.distances[b.vertex_map.at("b")];
+    BOOST_REQUIRE(! dist_b.is_special());
+
+    for (bool handle_on_node: {false, true}) {
+        const auto nearest = worker.find_nearest_vertex(target, handle_on_node);
+        BOOST_CHECK(nearest.second == dir::Target);
+        BOOST_CHECK(! nearest.first.is_special());
+        BOOST_CHECK_GT(nearest.first, dist_b);
+    }
+
+    const ProjectionData unreached(unreachable, b.geo_ref, *b.geo_ref.pl);
+    BOOST_REQUIRE(unreached.found);
+    BOOST_CHECK(worker.find_nearest_vertex(unreached).first.is_pos_infinity());
+}
+
+/*
+ * the dijkstra on the mode graphs gives the same distances and
+ * predecessors as on the filtered graph
+ */
+BOOST_AUTO_TEST_CASE(mode_graphs_same_as_filtered_graph) {
+    GraphBuilder b, b_mode_graphs;
+    for (auto* builder: {&b, &b_mode_graphs}) {
+        build_square_graph(*builder, 10);
+        builder->geo_ref.init();
+        // a link from the walking graph to the bike graph
+        boost::add_edge(builder->vertex_map["2_2"],
+                        builder->vertex_map["2_3"] + builder->geo_ref.offsets[type::Mode_e::Bike],
+                        Edge(0, navitia::seconds(10)), mutable_part(builder->geo_ref.graph));
+        builder->geo_ref.build_proximity_list();
+    }
+    const auto& with_mode_graphs = b_mode_graphs.geo_ref;
+    b_mode_graphs.geo_ref.build_mode_graphs();
+    BOOST_CHECK_EQUAL(boost::num_vertices((*b.geo_ref.mode_graphs)[type::Mode_e::Walking]), 0);
+
+    type::GeographicalCoord start;
+    start.set_xy(2., 2.);
+    for (const auto mode: {type::Mode_e::Walking, type::Mode_e::Bike, type::Mode_e::Bss}) {
+        PathFinder filtered(b.geo_ref);
+        filtered.init(start, mode, 1);
+        filtered.start_distance_dijkstra(navitia::seconds(1000));
+
+        PathFinder on_mode_graph(with_mode_graphs);
+        on_mode_graph.init(start, mode, 1);
+        on_mode_graph.start_distance_dijkstra(navitia::seconds(1000));
+
+        BOOST_CHECK(filtered.distances == on_mode_graph.distances);
+        BOOST_CHECK(filtered.touched_vertices == on_mode_graph.touched_vertices);
+        for (const auto v: filtered.touched_vertices) {
+            BOOST_CHECK_EQUAL(filtered.predecessors[v], on_mode_graph.predecessors[v]);
+        }
+    }
+}
+
+/*
+ * the single dijkstra from both ends of the starting edge gives the same
+ * distances as a dijkstra from each end
+ */
+BOOST_AUTO_TEST_CASE(starting_edge_dijkstra_same_as_two_dijkstras) {
+    GraphBuilder b;
+    build_square_graph(b, 10);
+    b.geo_ref.init();
+    b.geo_ref.build_proximity_list();
+
+    for (const auto& start_xy: {std::make_pair(2., 2.5), std::make_pair(4.5, 3.), std::make_pair(3., 3.)}) {
+        type::GeographicalCoord start;
+        start.set_xy(start_xy.first, start_xy.second);
+        for (const auto radius: {navitia::seconds(1000), navitia::seconds(60)}) {
+            PathFinder single(b.geo_ref);
+            single.init(start, type::Mode_e::Walking, 1);
+            BOOST_REQUIRE(single.starting_edge.found);
+            single.start_distance_dijkstra(radius);
+
+            PathFinder two(b.geo_ref);
+            two.init(start, type::Mode_e::Walking, 1);
+            for (const auto d: {dir::Source, dir::Target}) {
+                try {
+                    two.dijkstra(two.starting_edge[d], distance_visitor(radius, two.distances));
+                } catch (DestinationFound) {}
+            }
+
+            for (vertex_t v = 0; v < boost::num_vertices(*b.geo_ref.graph); ++v) {
+                if (two.distances[v] > radius) {
+                    BOOST_CHECK(single.distances[v] == bt::pos_infin || single.distances[v] > radius);
+                    continue;
+                }
+                BOOST_CHECK_EQUAL(single.distances[v], two.distances[v]);
+            }
+            // the single search settles at most the vertices of the two searches
+            BOOST_CHECK_LE(single.touched_vertices.size(), two.touched_vertices.size());
+        }
+    }
+}
+
+/*
+ * the paths found with the contraction hierarchies reach the
+ * destinations with the same durations as the dijkstra
+ */
+BOOST_AUTO_TEST_CASE(contraction_hierarchy_same_as_dijkstra) {
+    GraphBuilder b, b_ch;
+    for (auto* builder: {&b, &b_ch}) {
+        build_square_graph(*builder, 10);
+        builder->geo_ref.init();
+        builder->geo_ref.build_proximity_list();
+    }
+    b_ch.geo_ref.build_contraction_hierarchies({type::Mode_e::Walking, type::Mode_e::Bike});
+    BOOST_CHECK_EQUAL((*b_ch.geo_ref.contraction_hierarchies)[type::Mode_e::Walking].nb_vertices(),
+                      boost::num_vertices(*b_ch.geo_ref.graph));
+
+    type::GeographicalCoord start;
+    start.set_xy(2., 2.5);
+    PathFinder without_ch(b.geo_ref);
+    without_ch.init(start, type::Mode_e::Walking, 1);
+    BOOST_CHECK(! without_ch.start_contraction_hierarchy(navitia::seconds(1000), {}));
+
+    for (const auto mode: {type::Mode_e::Walking, type::Mode_e::Bike}) {
+        const auto offset = b.geo_ref.offsets[mode];
+        for (const auto& dest_name: {"2_3", "5_5", "9_9", "3_8", "1_1"}) {
+            for (const auto radius: {navitia::seconds(1000), navitia::seconds(60)}) {
+                const std::vector<vertex_t> destinations = {b.vertex_map[dest_name] + offset};
+
+                PathFinder dijkstra(b.geo_ref);
+                dijkstra.init(start, mode, 1);
+                dijkstra.start_distance_or_target_dijkstra(radius, destinations);
+
+                PathFinder ch(b_ch.geo_ref);
+                ch.init(start, mode, 1);
+                BOOST_REQUIRE(ch.start_contraction_hierarchy(radius, destinations));
+
+                const auto dest = destinations.front();
+                if (dijkstra.distances[dest] > radius) {
+                    BOOST_CHECK(ch.distances[dest] == bt::pos_infin || ch.distances[dest] > radius);
+                    continue;
+                }
+                BOOST_CHECK_EQUAL(dijkstra.distances[dest], ch.distances[dest]);
+                // the predecessors lead back to the start
+                auto v = dest;
+                for (size_t i = 0; i < boost::num_vertices(*b.geo_ref.graph)
+                     && ch.predecessors[v] != v; ++i) {
+                    v = ch.predecessors[v];
+                }
+                BOOST_CHECK(v == ch.starting_edge[dir::Source] || v == ch.starting_edge[dir::Target]);
+            }
+        }
+    }
+}
+
+/*
+ * the A* and the bidirectional A*, with or without landmarks, reach the
+ * destinations with the same durations as the dijkstra
+ */
+BOOST_AUTO_TEST_CASE(goal_directed_search_same_as_dijkstra) {
+    GraphBuilder b;
+    const size_t square_size = 10;
+    for (size_t i = 0; i < square_size; ++i) {
+        for (size_t j = 0; j < square_size; ++j) {
+            b(get_name(i, j), i * 100, j * 100);
+        }
+    }
+    // pseudo random durations, so the lightest paths are not all along the crow fly
+    for (size_t i = 0; i < square_size; ++i) {
+        for (size_t j = 0; j < square_size; ++j) {
+            if (j + 1 < square_size) {
+                b(get_name(i, j), get_name(i, j + 1), navitia::seconds(60 + (i * 7919 + j * 104729) % 61));
+                b(get_name(i, j + 1), get_name(i, j), navitia::seconds(60 + (i * 3571 + j * 7907) % 61));
+            }
+            if (i + 1 < square_size) {
+                b(get_name(i, j), get_name(i + 1, j), navitia::seconds(60 + (i * 6143 + j * 4799) % 61));
+                b(get_name(i + 1, j), get_name(i, j), navitia::seconds(60 + (i * 2357 + j * 1237) % 61));
+            }
+        }
+    }
+    b.geo_ref.init();
+    b.geo_ref.build_proximity_list();
+
+    type::GeographicalCoord start;
+    start.set_xy(200., 250.);
+    const auto radius = navitia::seconds(5000);
+    for (const auto algorithm: {DirectPathAlgorithm::AStar, DirectPathAlgorithm::BidirectionalAStar}) {
+        for (const size_t nb_landmarks: {0, 3}) {
+            DirectPathParams params;
+            params.algorithms[type::Mode_e::Walking] = algorithm;
+            params.algorithms[type::Mode_e::Bike] = algorithm;
+            params.nb_landmarks = nb_landmarks;
+            b.geo_ref.build_goal_directed_search(params);
+            BOOST_CHECK_EQUAL((*b.geo_ref.goal_directed_bounds)[type::Mode_e::Walking].landmarks.size(), nb_landmarks);
+
+            for (const auto mode: {type::Mode_e::Walking, type::Mode_e::Bike}) {
+                const auto offset = b.geo_ref.offsets[mode];
+                PathFinder goal_directed(b.geo_ref);
+                for (const auto& dest_name: {"2_3", "5_5", "9_9", "3_8", "1_1", "8_0"}) {
+                    const auto dest_coord = (*b.geo_ref.graph)[b.vertex_map[dest_name]].coord;
+                    // on a vertex and on an edge
+                    type::GeographicalCoord on_edge;
+                    on_edge.set_lon(dest_coord.lon() + 30 * type::GeographicalCoord::N_M_TO_DEG);
+                    on_edge.set_lat(dest_coord.lat());
+                    for (const auto& coord: {dest_coord, on_edge}) {
+                        const ProjectionData target(coord, b.geo_ref, offset, *b.geo_ref.pl);
+                        BOOST_REQUIRE(target.found);
+
+                        PathFinder dijkstra(b.geo_ref);
+                        dijkstra.init(start, mode, 1);
+                        dijkstra.start_distance_or_target_dijkstra(radius, {target[dir::Source], target[dir::Target]});
+                        const auto expected = dijkstra.find_nearest_vertex(target, true);
+
+                        goal_directed.init(start, mode, 1);
+                        BOOST_REQUIRE(goal_directed.start_goal_directed_search(radius, target));
+                        const auto found = goal_directed.find_nearest_vertex(target, true);
+                        BOOST_CHECK_EQUAL(found.first, expected.first);
+                        BOOST_CHECK(found.second == expected.second);
+
+                        // the predecessors lead back to the start
+                        auto v = target[found.second];
+                        for (size_t i = 0; i < boost::num_vertices(*b.geo_ref.graph)
+                             && goal_directed.predecessors[v] != v; ++i) {
+                            v = goal_directed.predecessors[v];
+                        }
+                        BOOST_CHECK(v == goal_directed.starting_edge[dir::Source]
+                                    || v == goal_directed.starting_edge[dir::Target]);
+                    }
+                }
+            }
+        }
+    }
+
+    DirectPathParams dijkstra_params;
+    b.geo_ref.build_goal_directed_search(dijkstra_params);
+    PathFinder dijkstra(b.geo_ref);
+    dijkstra.init(start, type::Mode_e::Walking, 1);
+    BOOST_CHECK(! dijkstra.start_goal_directed_search(radius, ProjectionData()));
+    BOOST_CHECK_THROW(direct_path_algorithm_from_string("bfs"), std::invalid_argument);
+}
+
+/*
+ * the street network matrix gives the same durations as a dijkstra by
+ * origin, with several threads and with the contraction hierarchies
+ */
+BOOST_AUTO_TEST_CASE(street_network_matrix_same_as_dijkstra) {
+    GraphBuilder b, b_ch;
+    for (auto* builder: {&b, &b_ch}) {
+        build_square_graph(*builder, 10);
+        builder->geo_ref.init();
+        builder->geo_ref.build_proximity_list();
+    }
+    b_ch.geo_ref.build_contraction_hierarchies({type::Mode_e::Walking, type::Mode_e::Bike});
+
+    std::vector<type::GeographicalCoord> origins, destinations;
+    for (size_t i = 0; i < 5; ++i) {
+        origins.emplace_back();
+        origins.back().set_xy(i * 1.5 + 0.2, i + 0.5);
+    }
+    for (size_t i = 0; i < 9; ++i) {
+        destinations.emplace_back();
+        destinations.back().set_xy(i + 0.3, 9 - i * 0.7);
+    }
+    const auto radius = navitia::seconds(150);
+
+    for (const auto mode: {type::Mode_e::Walking, type::Mode_e::Bike}) {
+        PathFinder path_finder(b.geo_ref);
+        StreetNetworkMatrix::Matrix expected;
+        for (const auto& origin: origins) {
+            path_finder.init(origin, mode, 2);
+            const auto durations = path_finder.get_duration_with_dijkstra(radius, destinations);
+            expected.emplace_back();
+            for (const auto& dest: destinations) {
+                expected.back().push_back(durations.at(dest.uri()));
+            }
+        }
+
+        size_t nb_reached = 0;
+        for (const auto* geo_ref: {&b.geo_ref, &b_ch.geo_ref}) {
+            for (const size_t nb_threads: {1, 3}) {
+                navitia::ThreadPool pool(nb_threads);
+                StreetNetworkMatrix matrix_engine(*geo_ref, pool, nb_threads);
+                const auto matrix = matrix_engine.compute(origins, destinations, mode, 2, radius);
+                BOOST_REQUIRE_EQUAL(matrix.size(), origins.size());
+                for (size_t i = 0; i < origins.size(); ++i) {
+                    BOOST_REQUIRE_EQUAL(matrix[i].size(), destinations.size());
+                    for (size_t j = 0; j < destinations.size(); ++j) {
+                        BOOST_CHECK(matrix[i][j].routing_status == expected[i][j].routing_status);
+                        BOOST_CHECK_EQUAL(matrix[i][j].time_duration, expected[i][j].time_duration);
+                        if (matrix[i][j].routing_status == RoutingStatus_e::reached) { ++nb_reached; }
+                    }
+                }
+            }
+        }
+        BOOST_CHECK(nb_reached > 0);
+    }
+}
+
 /**
   * The aim of the test is to check that the street network answer give the same answer
   * to multiple get_distance question
@@ -113,7 +484,7 @@ BOOST_AUTO_TEST_CASE(idempotence) {
     b.geo_ref.init();
     b.geo_ref.project_stop_points(data.pt_data->stop_points);
 
-    const GeoRef::ProjectionByMode& projections = b.geo_ref.projected_stop_points[sp->idx];
+    const GeoRef::ProjectionByMode& projections = (*b.geo_ref.projected_stop_points)[sp->idx];
     const ProjectionData proj = projections[type::Mode_e::Walking];
 
     BOOST_REQUIRE(proj.found); //we have to be able to project this point (on the walking graph)
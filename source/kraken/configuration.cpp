@@ -69,6 +69,26 @@ po::options_description get_options_description(const boost::optional<std::strin
              po::value<bool>()->default_value(*display_contributors) : po::value<bool>()->default_value(false),
          "display all contributors in feed publishers")
         ("GENERAL.raptor_cache_size", po::value<int>()->default_value(10), "maximum number of stored raptor caches")
+        ("GENERAL.nb_snd_pass_threads", po::value<int>()->default_value(1),
+         "number of threads used by each worker to run the raptor second passes")
+        ("GENERAL.nb_sn_matrix_threads", po::value<int>()->default_value(1),
+         "number of threads used by each worker to compute the rows of the street network matrices")
+        ("GENERAL.nb_heat_map_threads", po::value<int>()->default_value(1),
+         "number of threads used by each worker to fill the grid of a heat map")
+        ("GENERAL.concurrent_fallbacks", po::value<bool>()->default_value(false),
+         "search the stop points around the departure and the arrival of a journey on two threads")
+        ("GENERAL.journeys_profile", po::value<bool>()->default_value(false),
+         "compute the journeys leaving between the first and the last datetimes of a clockwise request with a profile query")
+        ("GENERAL.sp_duration_cache_size", po::value<int>()->default_value(2000000),
+         "maximum number of street network durations to the stop points kept in cache, 0 to disable it")
+        ("GENERAL.sp_duration_cache_warmup_radius", po::value<int>()->default_value(0),
+         "walking duration (in seconds) of the stop point durations computed at load from the stop areas and the pois, 0 to disable it")
+        ("GENERAL.walking_direct_path_algorithm", po::value<std::string>()->default_value("dijkstra"),
+         "algorithm of the walking direct paths: dijkstra, astar or bidirectional_astar")
+        ("GENERAL.bike_direct_path_algorithm", po::value<std::string>()->default_value("dijkstra"),
+         "algorithm of the bike direct paths: dijkstra, astar or bidirectional_astar")
+        ("GENERAL.nb_landmarks", po::value<int>()->default_value(0),
+         "number of landmarks computed at load to guide the astar direct paths, 0 to use only the crow fly bound")
         ("GENERAL.log_level", po::value<std::string>(), "log level of kraken")
         ("GENERAL.log_format", po::value<std::string>()->default_value("[%D{%y-%m-%d %H:%M:%S,%q}] [%p] [%x] - %m %b:%L  %n"), "log format")
 
@@ -213,6 +233,95 @@ size_t Configuration::raptor_cache_size() const{
     return size_t(raptor_cache_size);
 }
 
+size_t Configuration::nb_snd_pass_threads() const{
+    if (! vm.count("GENERAL.nb_snd_pass_threads")) {
+        return 1;
+    }
+    int nb_snd_pass_threads = vm["GENERAL.nb_snd_pass_threads"].as<int>();
+    if (nb_snd_pass_threads < 1) {
+        throw std::invalid_argument("nb_snd_pass_threads must be strictly positive");
+    }
+    return size_t(nb_snd_pass_threads);
+}
+
+size_t Configuration::nb_sn_matrix_threads() const{
+    if (! vm.count("GENERAL.nb_sn_matrix_threads")) {
+        return 1;
+    }
+    int nb_sn_matrix_threads = vm["GENERAL.nb_sn_matrix_threads"].as<int>();
+    if (nb_sn_matrix_threads < 1) {
+        throw std::invalid_argument("nb_sn_matrix_threads must be strictly positive");
+    }
+    return size_t(nb_sn_matrix_threads);
+}
+
+size_t Configuration::nb_heat_map_threads() const{
+    if (! vm.count("GENERAL.nb_heat_map_threads")) {
+        return 1;
+    }
+    int nb_heat_map_threads = vm["GENERAL.nb_heat_map_threads"].as<int>();
+    if (nb_heat_map_threads < 1) {
+        throw std::invalid_argument("nb_heat_map_threads must be strictly positive");
+    }
+    return size_t(nb_heat_map_threads);
+}
+
+bool Configuration::concurrent_fallbacks() const{
+    if (! vm.count("GENERAL.concurrent_fallbacks")) {
+        return false;
+    }
+    return vm["GENERAL.concurrent_fallbacks"].as<bool>();
+}
+
+bool Configuration::journeys_profile() const{
+    if (! vm.count("GENERAL.journeys_profile")) {
+        return false;
+    }
+    return vm["GENERAL.journeys_profile"].as<bool>();
+}
+
+size_t Configuration::sp_duration_cache_size() const{
+    if (! vm.count("GENERAL.sp_duration_cache_size")) {
+        return 0;
+    }
+    int sp_duration_cache_size = vm["GENERAL.sp_duration_cache_size"].as<int>();
+    if (sp_duration_cache_size < 0) {
+        throw std::invalid_argument("sp_duration_cache_size must be positive");
+    }
+    return size_t(sp_duration_cache_size);
+}
+
+int Configuration::sp_duration_cache_warmup_radius() const{
+    if (! vm.count("GENERAL.sp_duration_cache_warmup_radius")) {
+        return 0;
+    }
+    int sp_duration_cache_warmup_radius = vm["GENERAL.sp_duration_cache_warmup_radius"].as<int>();
+    if (sp_duration_cache_warmup_radius < 0) {
+        throw std::invalid_argument("sp_duration_cache_warmup_radius must be positive");
+    }
+    return sp_duration_cache_warmup_radius;
+}
+
+navitia::georef::DirectPathParams Configuration::direct_path_params() const{
+    navitia::georef::DirectPathParams params;
+    if (vm.count("GENERAL.walking_direct_path_algorithm")) {
+        params.algorithms[navitia::type::Mode_e::Walking] = navitia::georef::direct_path_algorithm_from_string(
+                    vm["GENERAL.walking_direct_path_algorithm"].as<std::string>());
+    }
+    if (vm.count("GENERAL.bike_direct_path_algorithm")) {
+        params.algorithms[navitia::type::Mode_e::Bike] = navitia::georef::direct_path_algorithm_from_string(
+                    vm["GENERAL.bike_direct_path_algorithm"].as<std::string>());
+    }
+    if (vm.count("GENERAL.nb_landmarks")) {
+        int nb_landmarks = vm["GENERAL.nb_landmarks"].as<int>();
+        if (nb_landmarks < 0) {
+            throw std::invalid_argument("nb_landmarks must be positive");
+        }
+        params.nb_landmarks = size_t(nb_landmarks);
+    }
+    return params;
+}
+
 boost::optional<std::string> Configuration::log_level() const{
     boost::optional<std::string> result;
     if (this->vm.count("GENERAL.log_level") > 0) {
@@ -31,6 +31,7 @@ www.navitia.io
 #pragma once
 #include <boost/program_options.hpp>
 #include <boost/optional.hpp>
+#include "georef/goal_directed_search.h"
 
 namespace navitia { namespace kraken{
 
@@ -60,6 +61,14 @@ namespace navitia { namespace kraken{
             int kirin_retry_timeout() const;
             bool display_contributors() const;
             size_t raptor_cache_size() const;
+            size_t nb_snd_pass_threads() const;
+            size_t nb_sn_matrix_threads() const;
+            size_t nb_heat_map_threads() const;
+            bool concurrent_fallbacks() const;
+            bool journeys_profile() const;
+            size_t sp_duration_cache_size() const;
+            int sp_duration_cache_warmup_radius() const;
+            navitia::georef::DirectPathParams direct_path_params() const;
             int slow_request_duration() const;
             boost::optional<std::string> log_level() const;
             boost::optional<std::string> log_format() const;
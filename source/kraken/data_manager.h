@@ -82,19 +82,24 @@ public:
     }
     boost::shared_ptr<const Data> get_data() const { return current_data; }
     boost::shared_ptr<Data> get_data_clone() {
+        const auto from = get_data();
+        return get_data_clone(*from);
+    }
+    /// clone the given data, a snapshot previously got by get_data
+    boost::shared_ptr<Data> get_data_clone(const Data& from) {
         ++ data_identifier;
         auto data = create_data(data_identifier.load());
-        time_it("Clone data: ", [&]() { data->clone_from(*current_data); });
+        time_it("Clone data: ", [&]() { data->clone_from(from); });
         return std::move(data);
     }
 
     bool load(const std::string& database,
               const boost::optional<std::string>& chaos_database = boost::none,
-              const std::vector<std::string>& contributors = {}){
+              const typename Data::LoadOptions& options = typename Data::LoadOptions()){
         bool success;
         ++ data_identifier;
         auto data = create_data(data_identifier.load());
-        success = data->load(database, chaos_database, contributors);
+        success = data->load(database, chaos_database, options);
         if (success) {
             set_data(std::move(data));
         }
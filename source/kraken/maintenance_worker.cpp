@@ -40,6 +40,7 @@ www.navitia.io
 #include <sys/stat.h>
 #include <signal.h>
 #include <SimpleAmqpClient/Envelope.h>
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include "utils/get_hostname.h"
@@ -55,9 +56,14 @@ namespace navitia {
 void MaintenanceWorker::load(){
     const std::string database = conf.databases_path();
     auto chaos_database = conf.chaos_database();
-    auto contributors = conf.rt_topics();
+    nt::LoadOptions options;
+    options.contributors = conf.rt_topics();
+    options.stop_point_duration_cache_size = conf.sp_duration_cache_size();
+    options.stop_point_duration_cache_warmup = navitia::seconds(conf.sp_duration_cache_warmup_radius());
+    options.direct_path_params = conf.direct_path_params();
+    options.nb_threads = std::max(conf.nb_threads(), 1);
     LOG4CPLUS_INFO(logger, "Loading database from file: " + database);
-    if(this->data_manager.load(database, chaos_database, contributors)){
+    if(this->data_manager.load(database, chaos_database, options)){
         auto data = data_manager.get_data();
         data->is_realtime_loaded = false;
         data->meta->instance_name = conf.instance_name();
@@ -158,6 +164,8 @@ void MaintenanceWorker::handle_task_in_batch(const std::vector<AmqpClient::Envel
 
 void MaintenanceWorker::handle_rt_in_batch(const std::vector<AmqpClient::Envelope::ptr_t>& envelopes){
     boost::shared_ptr<nt::Data> data{};
+    // the data the clone comes from, to update its dataRaptor
+    boost::shared_ptr<const nt::Data> cloned_from{};
     pt::ptime begin = pt::microsec_clock::universal_time();
     for (auto& envelope: envelopes) {
         LOG4CPLUS_DEBUG(logger, "realtime info received!");
@@ -170,7 +178,9 @@ void MaintenanceWorker::handle_rt_in_batch(const std::vector<AmqpClient::Envelop
         LOG4CPLUS_TRACE(logger, "received entity: " << feed_message.DebugString());
         for(const auto& entity: feed_message.entity()){
             if (!data) {
-                data = data_manager.get_data_clone();
+                // one snapshot, the current data can be replaced meanwhile
+                cloned_from = data_manager.get_data();
+                data = data_manager.get_data_clone(*cloned_from);
                 data->last_rt_data_loaded = pt::microsec_clock::universal_time();
                 LOG4CPLUS_INFO(logger, "data copied in " << (data->last_rt_data_loaded - begin));
             }
@@ -193,8 +203,12 @@ void MaintenanceWorker::handle_rt_in_batch(const std::vector<AmqpClient::Envelop
     }
     if (data) {
         data->pt_data->clean_weak_impacts();
-        LOG4CPLUS_INFO(logger, "rebuilding data raptor");
-        data->build_raptor(conf.raptor_cache_size());
+        LOG4CPLUS_INFO(logger, "updating data raptor");
+        data->build_raptor(*cloned_from, conf.raptor_cache_size());
+        data->warmup_raptor_cache(pt::microsec_clock::universal_time(), std::max(conf.nb_threads(), 1));
+        // the cache belongs to the previous Data, freed once it's not used
+        // anymore: the clone starts with an empty cache, filled by the requests
+        data->build_stop_point_duration_cache(conf.sp_duration_cache_size());
         data_manager.set_data(std::move(data));
         LOG4CPLUS_INFO(logger, "data updated " << envelopes.size() << " disrutpion applied in "
                                                << pt::microsec_clock::universal_time() - begin);
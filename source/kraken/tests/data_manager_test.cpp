@@ -39,9 +39,10 @@ www.navitia.io
 //mock of navitia::type::Data class
 class Data{
     public:
+        struct LoadOptions {};
         bool load(const std::string&,
                   const boost::optional<std::string>&,
-                  const std::vector<std::string>&) {
+                  const LoadOptions&) {
             return load_status;
         }
         mutable std::atomic<bool> is_connected_to_rabbitmq;
@@ -1962,3 +1962,123 @@ BOOST_AUTO_TEST_CASE(skipped_stop_then_delay) {
     BOOST_REQUIRE_EQUAL(journeys.size(), 1);
     BOOST_CHECK_EQUAL(journeys[0].items.back().arrival, "20170101T083500"_dt);
 }
+
+namespace {
+// Description of a dataRAPTOR that does not depend on the indexes of
+// the jps and jpps, to compare a dataRAPTOR updated from a previous
+// version of the data with one loaded from scratch.
+struct JpSummary {
+    std::vector<navitia::idx_t> sps;
+    std::vector<std::vector<navitia::idx_t>> departures; // vj idx for each jpp
+    std::vector<std::vector<navitia::idx_t>> arrivals; // vj idx for each jpp
+    std::vector<std::string> validity; // for each level, the days of the jp
+    bool operator==(const JpSummary& other) const {
+        return sps == other.sps && departures == other.departures
+            && arrivals == other.arrivals && validity == other.validity;
+    }
+};
+std::ostream& operator<<(std::ostream& os, const JpSummary& s) {
+    return os << "JpSummary(" << s.sps.size() << " sps)";
+}
+
+// the jps are identified by the list of their vjs
+std::map<std::vector<navitia::idx_t>, JpSummary>
+summarize(const navitia::routing::dataRAPTOR& data_raptor) {
+    namespace nr = navitia::routing;
+    std::map<std::vector<navitia::idx_t>, JpSummary> res;
+    const auto& jp_container = data_raptor.jp_container;
+    for (const auto& jp: jp_container.get_jps()) {
+        std::vector<navitia::idx_t> vjs;
+        jp.second.for_each_vehicle_journey([&](const nt::VehicleJourney& vj) {
+            vjs.push_back(vj.idx);
+            return true;
+        });
+        std::sort(vjs.begin(), vjs.end());
+        auto& summary = res[vjs];
+        for (const auto& jpp_idx: jp.second.jpps) {
+            summary.sps.push_back(jp_container.get(jpp_idx).sp_idx.val);
+            const auto& nst = data_raptor.next_stop_time_data;
+            std::vector<navitia::idx_t> deps, arrs;
+            for (const auto* st: nst.stop_time_range_forward(jpp_idx, navitia::routing::StopEvent::pick_up)) {
+                deps.push_back(st->vehicle_journey->idx);
+            }
+            for (const auto* st: nst.stop_time_range_forward(jpp_idx, navitia::routing::StopEvent::drop_off)) {
+                arrs.push_back(st->vehicle_journey->idx);
+            }
+            summary.departures.push_back(deps);
+            summary.arrivals.push_back(arrs);
+            // the jpps from sp must contain this jpp
+            const auto& jpps = data_raptor.jpps_from_sp[jp_container.get(jpp_idx).sp_idx];
+            BOOST_CHECK(std::any_of(jpps.begin(), jpps.end(), [&](const nr::dataRAPTOR::JppsFromSp::Jpp& jpp) {
+                return jpp.idx == jpp_idx && jpp.jp_idx == jp.first;
+            }));
+        }
+        for (const auto level_cont: data_raptor.jp_validity_patterns) {
+            std::string days;
+            for (const auto& bitset: level_cont.second) { days += bitset[jp.first.val] ? '1' : '0'; }
+            summary.validity.push_back(days);
+        }
+    }
+    return res;
+}
+}
+
+/*
+ * The dataRAPTOR updated after a realtime batch must be the same as
+ * the one loaded from scratch on the same data.
+ */
+BOOST_AUTO_TEST_CASE(update_data_raptor_after_realtime) {
+    ed::builder b("20150928");
+    b.vj("A", "0000011", "", true, "vj:1")("stop1", "08:01"_t)("stop2", "09:01"_t);
+    b.vj("A", "0000011", "", true, "vj:2")("stop1", "10:01"_t)("stop2", "11:01"_t);
+    b.vj("B", "0000011", "", true, "vj:3")("stop2", "08:01"_t)("stop3", "09:01"_t);
+    b.vj("C", "0000011", "", true, "vj:4")("stop3", "08:01"_t)("stop4", "09:01"_t);
+
+    b.data->pt_data->index();
+    b.finish();
+    b.data->build_raptor();
+    b.data->build_uri();
+
+    b.data->load_durations = {{"deserialize", 42}};
+    nt::Data rt_data(1);
+    rt_data.clone_from(*b.data);
+    // the clone keeps the load stages of the data it comes from
+    BOOST_CHECK(rt_data.load_durations == b.data->load_durations);
+
+    // vj:1 is delayed enough to overtake vj:2, vj:3 is delayed and vj:4 is canceled
+    navitia::handle_realtime("delay_1", timestamp,
+                             ntest::make_delay_message("vj:1", "20150928", {
+                                 DelayedTimeStop("stop1", "20150928T0950"_pts).delay(109_min),
+                                 DelayedTimeStop("stop2", "20150928T1110"_pts).delay(129_min)
+                             }), rt_data);
+    navitia::handle_realtime("delay_3", timestamp,
+                             ntest::make_delay_message("vj:3", "20150928", {
+                                 DelayedTimeStop("stop2", "20150928T0810"_pts).delay(9_min),
+                                 DelayedTimeStop("stop3", "20150928T0910"_pts).delay(9_min)
+                             }), rt_data);
+    navitia::handle_realtime("cancel_4", timestamp, make_cancellation_message("vj:4", "20150928"), rt_data);
+    BOOST_REQUIRE_EQUAL(rt_data.pt_data->vehicle_journeys.size(), 6);
+
+    rt_data.build_raptor(*b.data);
+
+    navitia::routing::dataRAPTOR full_data_raptor;
+    full_data_raptor.load(*rt_data.pt_data);
+
+    BOOST_CHECK_EQUAL(rt_data.dataRaptor->jp_container.nb_jps(), full_data_raptor.jp_container.nb_jps());
+    BOOST_CHECK_EQUAL(rt_data.dataRaptor->jp_container.nb_jpps(), full_data_raptor.jp_container.nb_jpps());
+    const auto updated = summarize(*rt_data.dataRaptor);
+    const auto full = summarize(full_data_raptor);
+    BOOST_REQUIRE_EQUAL(updated.size(), full.size());
+    for (const auto& jp: full) {
+        BOOST_REQUIRE_EQUAL(updated.count(jp.first), 1);
+        BOOST_CHECK_EQUAL(updated.at(jp.first), jp.second);
+    }
+
+    // and raptor gives the realtime solution
+    navitia::routing::RAPTOR raptor(rt_data);
+    auto res = raptor.compute(rt_data.pt_data->stop_areas_map.at("stop2"),
+                              rt_data.pt_data->stop_areas_map.at("stop3"),
+                              "08:00"_t, 0, navitia::DateTimeUtils::inf, nt::RTLevel::RealTime, 2_min, true);
+    BOOST_REQUIRE_EQUAL(res.size(), 1);
+    BOOST_CHECK_EQUAL(res[0].items[0].arrival, "20150928T0910"_dt);
+}
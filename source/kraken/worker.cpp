@@ -70,7 +70,7 @@ static type::GeographicalCoord coord_of_entry_point(
         auto way = data.geo_ref->way_map.find(entry_point.uri);
         if (way != data.geo_ref->way_map.end()){
             const auto geo_way = data.geo_ref->ways[way->second];
-            return geo_way->nearest_coord(entry_point.house_number, data.geo_ref->graph);
+            return geo_way->nearest_coord(entry_point.house_number, *data.geo_ref->graph);
         }
     } else if (entry_point.type == Type_e::StopPoint) {
         auto sp_it = data.pt_data->stop_points_map.find(entry_point.uri);
@@ -172,6 +172,7 @@ std::vector<std::string> vector_of_admins(const T & admin){
 
 Worker::Worker(kraken::Configuration conf) :
     conf(conf),
+    thread_pool(std::max(this->conf.nb_sn_matrix_threads(), this->conf.nb_heat_map_threads())),
     logger(log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"))){}
 
 Worker::~Worker(){}
@@ -233,6 +234,19 @@ void Worker::status() {
     status->set_is_connected_to_rabbitmq(d->is_connected_to_rabbitmq);
     status->set_status(get_string_status(d));
     status->set_is_realtime_loaded(d->is_realtime_loaded);
+    if (d->dataRaptor->cached_next_st_manager) {
+        // the status message has no field for them, they are logged
+        const auto stats = d->dataRaptor->cached_next_st_manager->get_stats();
+        LOG4CPLUS_DEBUG(logger, "raptor cache: " << stats.nb_calls << " calls, "
+                       << stats.nb_cache_miss << " misses, built in "
+                       << stats.build_duration_ms << "ms");
+    }
+    if (d->stop_point_duration_cache) {
+        const auto stats = d->stop_point_duration_cache->get_stats();
+        LOG4CPLUS_DEBUG(logger, "stop point duration cache: " << stats.nb_calls << " calls, "
+                       << stats.nb_cache_miss << " misses, " << stats.nb_durations << " durations, "
+                       << stats.nb_dropped << " dropped, built in " << stats.build_duration_ms << "ms");
+    }
     for(const auto& contrib: this->conf.rt_topics()){
         status->add_rt_contributors(contrib);
     }
@@ -308,8 +322,12 @@ void Worker::init_worker_data(const navitia::type::Data* data,
                               const bool disable_feedpublisher){
     //@TODO should be done in data_manager
     if(data->data_identifier != this->last_data_identifier || !planner){
-        planner = std::make_unique<routing::RAPTOR>(*data);
-        street_network_worker = std::make_unique<georef::StreetNetwork>(*data->geo_ref);
+        planner = std::make_unique<routing::RAPTOR>(*data, conf.nb_snd_pass_threads());
+        street_network_worker = std::make_unique<georef::StreetNetwork>(*data->geo_ref,
+                                                                        data->stop_point_duration_cache.get(),
+                                                                        conf.concurrent_fallbacks());
+        street_network_matrix_worker = std::make_unique<georef::StreetNetworkMatrix>(
+                    *data->geo_ref, thread_pool, conf.nb_sn_matrix_threads());
         this->last_data_identifier = data->data_identifier;
         LOG4CPLUS_INFO(logger, "Instanciate planner");        
     }
@@ -704,7 +722,8 @@ void Worker::journeys(const pbnavitia::JourneysRequest &request, pbnavitia::API
                 request.clockwise(), arg.accessibilite_params,
                 arg.forbidden, arg.allowed, *street_network_worker,
                 arg.rt_level, seconds{request.walking_transfer_penalty()}, request.max_duration(),
-                request.max_transfers(), request.max_extra_second_pass());
+                request.max_transfers(), request.max_extra_second_pass(),
+                conf.journeys_profile() && arg.datetimes.size() > 1);
         }
     }catch(const navitia::coord_conversion_exception& e) {
         this->pb_creator.fill_pb_error(pbnavitia::Error::bad_format, e.what());
@@ -798,7 +817,7 @@ void Worker::heat_map(const pbnavitia::HeatMapRequest& request) {
                                     request_journey.clockwise(), arg.rt_level,
                                     *street_network_worker,
                                     request_journey.streetnetwork_params().walking_speed(), mode,
-                                    request.resolution());
+                                    request.resolution(), thread_pool, conf.nb_heat_map_threads());
 }
 
 void Worker::car_co2_emission_on_crow_fly(const pbnavitia::CarCO2EmissionRequest& request) {
@@ -892,31 +911,31 @@ void Worker::street_network_routing_matrix(const pbnavitia::StreetNetworkRouting
         }
     }
 
+    // all the origins share the mode and the speed of the request
+    std::vector<type::GeographicalCoord> origin_coords;
+    type::EntryPoint entry_point;
     for (const auto& origin: request.origins()) {
-        type::EntryPoint entry_point;
         try{
             entry_point = make_sn_entry_point(origin.place(), request.mode(), request.speed(), request.max_duration(), *data);
         }catch(const navitia::coord_conversion_exception& e) {
             this->pb_creator.fill_pb_error(pbnavitia::Error::bad_format, e.what());
             return;
         }
+        origin_coords.push_back(entry_point.coordinates);
+    }
 
-        street_network_worker->departure_path_finder.init(entry_point.coordinates,
-                entry_point.streetnetwork_params.mode,
-                entry_point.streetnetwork_params.speed_factor);
-        auto nearest = street_network_worker->departure_path_finder.get_duration_with_dijkstra(
-                navitia::time_duration::from_boost_duration(boost::posix_time::seconds(request.max_duration())),
-                dest_coords);
+    const auto matrix = street_network_matrix_worker->compute(origin_coords,
+            dest_coords,
+            entry_point.streetnetwork_params.mode,
+            entry_point.streetnetwork_params.speed_factor,
+            navitia::time_duration::from_boost_duration(boost::posix_time::seconds(request.max_duration())));
 
+    for (const auto& matrix_row: matrix) {
         auto* row = this->pb_creator.mutable_sn_routing_matrix()->add_rows();
-        for(auto coord : dest_coords) {
+        for (const auto& elt: matrix_row) {
             auto* k = row->add_routing_response();
-            auto it = nearest.find(coord.uri());
-            if(it == nearest.end()) {
-                throw navitia::recoverable_exception("Cannot found object: " + coord.uri());
-            }
-            k->set_duration(it->second.time_duration.total_seconds());
-            switch(it->second.routing_status){
+            k->set_duration(elt.time_duration.total_seconds());
+            switch(elt.routing_status){
             case georef::RoutingStatus_e::reached:
                 k->set_routing_status(pbnavitia::RoutingStatus::reached);
                 break;
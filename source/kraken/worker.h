@@ -38,6 +38,7 @@ namespace routing{
 }
 
 #include "georef/street_network.h"
+#include "georef/street_network_matrix.h"
 #include "type/type.pb.h"
 #include "type/response.pb.h"
 #include "type/request.pb.h"
@@ -45,6 +46,7 @@ namespace routing{
 #include "utils/logger.h"
 #include "kraken/configuration.h"
 #include "type/pb_converter.h"
+#include "type/thread_pool.h"
 
 #include <memory>
 #include <limits>
@@ -73,8 +75,11 @@ class Worker {
     private:
         std::unique_ptr<navitia::routing::RAPTOR> planner;
         std::unique_ptr<navitia::georef::StreetNetwork> street_network_worker;
+        std::unique_ptr<navitia::georef::StreetNetworkMatrix> street_network_matrix_worker;
 
         const kraken::Configuration conf;
+        // threads of the worker running the parallel parts of its requests
+        navitia::ThreadPool thread_pool;
         log4cplus::Logger logger;
         size_t last_data_identifier = std::numeric_limits<size_t>::max();// to check that data did not change, do not use directly
         boost::posix_time::ptime last_load_at;
@@ -34,6 +34,8 @@ www.navitia.io
 #include "utils/exception.h"
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <algorithm>
 
 namespace navitia { namespace proximitylist {
 
@@ -45,12 +47,16 @@ struct NotFound : public recoverable_exception{
     virtual ~NotFound() noexcept;
 };
 
+/// nombre de mètres par degré de latitude
+constexpr double meters_by_degree = 111320.;
+
 /** Définit un indexe spatial qui permet de retrouver les n éléments les plus proches
  *
  * Le template T est le type que l'on souhaite indexer (typiquement un Idx). L'élément sera copié.
  * On rajoute des élements itérativements et on appelle build pour construire l'indexe.
- * L'implémentation est un bête tableau trié par X.
- * On cherche les bornes inf/sup selon X, puis on itère sur les données et on garde les bonnes
+ * L'implémentation est une grille uniforme : les éléments sont triés par cellule,
+ * et seules les cellules non vides sont gardées. Une recherche ne parcourt que
+ * les cellules qui touchent le rayon, ligne par ligne.
  */
 
 template<class T>
@@ -67,40 +73,138 @@ struct ProximityList
         }
     };
 
-    /// Contient toutes les coordonnées de manière à trouver rapidement
+    /// Contient toutes les coordonnées, triées par cellule (ligne par ligne)
     std::vector<Item> items;
 
+    /// Numéros des cellules non vides, triés, et indice dans items de leur premier élément
+    std::vector<uint64_t> cell_keys;
+    std::vector<uint32_t> cell_begins;
+
+    /// Origine et pas de la grille en degrés
+    double min_lon = 0, min_lat = 0, lon_step = 1, lat_step = 1;
+    uint64_t nb_cols = 0, nb_rows = 0;
+
     /// Rajoute un nouvel élément. Attention, il faut appeler build avant de pouvoir utiliser la structure
     void add(GeographicalCoord coord, T element){
         items.push_back(Item(coord,element));
     }
     void clear(){
         items.clear();
+        cell_keys.clear();
+        cell_begins.clear();
+        nb_cols = nb_rows = 0;
     }
 
-    /// Construit l'indexe
-    void build(){
-        std::sort(items.begin(), items.end(), [](const Item & a, const Item & b){return a.coord < b.coord;});
+    /** Construit l'indexe
+     *
+     * La taille des cellules est choisie pour avoir en moyenne items_by_cell
+     * éléments par cellule sur la zone où se trouvent la plupart des éléments
+     */
+    void build(double items_by_cell = 8){
+        cell_keys.clear();
+        cell_begins.clear();
+        nb_cols = nb_rows = 0;
+        if (items.empty()) { return; }
+
+        std::vector<double> lons, lats;
+        lons.reserve(items.size());
+        lats.reserve(items.size());
+        for (const auto& item: items) {
+            lons.push_back(item.coord.lon());
+            lats.push_back(item.coord.lat());
+        }
+        const auto quantile = [](std::vector<double>& values, double q) {
+            auto it = values.begin() + size_t(q * (values.size() - 1));
+            std::nth_element(values.begin(), it, values.end());
+            return *it;
+        };
+        // the outliers (as some 0,0 coordinates) are not used for the density,
+        // they would blow up the size of the cells
+        const double lon_low = quantile(lons, 0.01), lon_high = quantile(lons, 0.99);
+        const double lat_low = quantile(lats, 0.01), lat_high = quantile(lats, 0.99);
+        const double coslat = std::max(::cos((lat_low + lat_high) / 2 * type::GeographicalCoord::N_DEG_TO_RAD), 0.01);
+        const double area = (lon_high - lon_low) * coslat * meters_by_degree
+                * (lat_high - lat_low) * meters_by_degree;
+        const double nb_cells = std::max(items.size() * 0.98 / items_by_cell, 1.);
+        const double cell_size = std::min(std::max(::sqrt(area / nb_cells), 20.), 10000.);
+
+        lat_step = cell_size / meters_by_degree;
+        lon_step = lat_step / coslat;
+        min_lon = *std::min_element(lons.begin(), lons.end());
+        min_lat = *std::min_element(lats.begin(), lats.end());
+        nb_cols = uint64_t((*std::max_element(lons.begin(), lons.end()) - min_lon) / lon_step) + 1;
+        nb_rows = uint64_t((*std::max_element(lats.begin(), lats.end()) - min_lat) / lat_step) + 1;
+
+        std::sort(items.begin(), items.end(), [&](const Item & a, const Item & b){
+            const auto key_a = cell_key(a.coord), key_b = cell_key(b.coord);
+            return key_a < key_b || (key_a == key_b && a.coord < b.coord);
+        });
+        for (size_t i = 0; i < items.size(); ++i) {
+            const auto key = cell_key(items[i].coord);
+            if (cell_keys.empty() || cell_keys.back() != key) {
+                cell_keys.push_back(key);
+                cell_begins.push_back(i);
+            }
+        }
+    }
+
+    /// Appelle f sur tous les éléments dans le rectangle donné par ses coins sud-ouest et nord-est
+    template<typename F>
+    void for_each_in_box(const GeographicalCoord& bottom_left, const GeographicalCoord& top_right, F f) const {
+        if (cell_keys.empty()) { return; }
+        const int64_t col_begin = std::max<int64_t>(col(bottom_left.lon()), 0);
+        const int64_t col_end = std::min<int64_t>(col(top_right.lon()), nb_cols - 1);
+        const int64_t row_begin = std::max<int64_t>(row(bottom_left.lat()), 0);
+        const int64_t row_end = std::min<int64_t>(row(top_right.lat()), nb_rows - 1);
+        for (int64_t r = row_begin; r <= row_end && col_begin <= col_end; ++r) {
+            // the cells of a row are contiguous in items
+            const auto first = std::lower_bound(cell_keys.begin(), cell_keys.end(), r * nb_cols + col_begin);
+            const auto last = std::upper_bound(first, cell_keys.end(), r * nb_cols + col_end);
+            if (first == last) { continue; }
+            const size_t begin = cell_begins[first - cell_keys.begin()];
+            const size_t end = last == cell_keys.end() ? items.size() : cell_begins[last - cell_keys.begin()];
+            for (size_t i = begin; i < end; ++i) {
+                const auto& c = items[i].coord;
+                if (c.lon() >= bottom_left.lon() && c.lon() <= top_right.lon()
+                        && c.lat() >= bottom_left.lat() && c.lat() <= top_right.lat()) {
+                    f(items[i]);
+                }
+            }
+        }
     }
 
     /// Retourne tous les éléments dans un rayon de x mètres
     std::vector< std::pair<T, GeographicalCoord> > find_within(GeographicalCoord coord, double distance = 500) const {
-        double distance_degree = distance / 111320;
-
-        double coslat = ::cos(coord.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
-
-        auto begin = std::lower_bound(items.begin(), items.end(), coord.lon() - distance_degree / coslat, [](const Item & i, double min){return i.coord.lon() < min;});
-        auto end = std::upper_bound(begin, items.end(), coord.lon() + distance_degree / coslat, [](double max, const Item & i){return max < i.coord.lon();});
+        auto found = find_within_unsorted(coord, distance);
+        std::sort(found.begin(), found.end(), by_distance);
         std::vector< std::pair<T, GeographicalCoord> > result;
-        double max_dist = distance * distance;
-        for(; begin != end; ++begin){
-            if(begin->coord.approx_sqr_distance(coord, coslat) <= max_dist)
-                result.push_back(std::make_pair(begin->element, begin->coord));
+        result.reserve(found.size());
+        for (const auto& elt: found) {
+            result.push_back(std::make_pair(elt.second->element, elt.second->coord));
         }
-        std::sort(result.begin(), result.end(), [&coord, &coslat](const std::pair<T, GeographicalCoord> & a, const std::pair<T, GeographicalCoord> & b){return a.second.approx_sqr_distance(coord, coslat) < b.second.approx_sqr_distance(coord, coslat);});
         return result;
     }
 
+    /** Retourne les k éléments les plus proches à moins de max_dist mètres, du plus proche au plus lointain
+     *
+     * Le rayon de recherche est doublé tant que k éléments ne sont pas trouvés
+     */
+    std::vector< std::pair<T, GeographicalCoord> > find_k_nearest(GeographicalCoord coord, size_t k,
+                                                                  double max_dist = 500) const {
+        std::vector<std::pair<double, const Item*>> found;
+        if (k == 0 || cell_keys.empty()) { return {}; }
+        for (double radius = std::min(max_dist, lat_step * meters_by_degree);; radius = std::min(2 * radius, max_dist)) {
+            found = find_within_unsorted(coord, radius);
+            if (found.size() >= k || radius >= max_dist) { break; }
+        }
+        const auto nb = std::min(k, found.size());
+        std::partial_sort(found.begin(), found.begin() + nb, found.end(), by_distance);
+        std::vector< std::pair<T, GeographicalCoord> > result;
+        for (size_t i = 0; i < nb; ++i) {
+            result.push_back(std::make_pair(found[i].second->element, found[i].second->coord));
+        }
+        return result;
+    }
 
     /// Fonction de confort pour retrouver l'élément le plus proche dans l'indexe
     T find_nearest(double lon, double lat) const {
@@ -109,7 +213,7 @@ struct ProximityList
 
     /// Retourne l'élément le plus proche dans tout l'indexe
     T find_nearest(GeographicalCoord coord, double max_dist = 500) const {
-        auto temp = find_within(coord, max_dist);
+        auto temp = find_k_nearest(coord, 1, max_dist);
         if(temp.empty())
             throw NotFound();
         else
@@ -122,9 +226,33 @@ struct ProximityList
       * Elle est appelée par boost et pas directement
       */
     template<class Archive> void serialize(Archive & ar, const unsigned int) {
-        ar & items;
+        ar & items & cell_keys & cell_begins & min_lon & min_lat & lon_step & lat_step & nb_cols & nb_rows;
     }
 
+private:
+    int64_t col(double lon) const { return int64_t(::floor((lon - min_lon) / lon_step)); }
+    int64_t row(double lat) const { return int64_t(::floor((lat - min_lat) / lat_step)); }
+    uint64_t cell_key(const GeographicalCoord& coord) const { return row(coord.lat()) * nb_cols + col(coord.lon()); }
+
+    static bool by_distance(const std::pair<double, const Item*>& a, const std::pair<double, const Item*>& b) {
+        return a.first < b.first;
+    }
+
+    /// éléments dans le rayon avec le carré de leur distance
+    std::vector<std::pair<double, const Item*>> find_within_unsorted(const GeographicalCoord& coord, double distance) const {
+        // approx_sqr_distance uses a slightly smaller earth, so the box is a bit enlarged
+        const double distance_degree = 1.01 * distance / meters_by_degree;
+        const double coslat = ::cos(coord.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
+        const double max_dist = distance * distance;
+        std::vector<std::pair<double, const Item*>> found;
+        for_each_in_box(GeographicalCoord(coord.lon() - distance_degree / coslat, coord.lat() - distance_degree),
+                        GeographicalCoord(coord.lon() + distance_degree / coslat, coord.lat() + distance_degree),
+                        [&](const Item& item) {
+            const double dist = item.coord.approx_sqr_distance(coord, coslat);
+            if (dist <= max_dist) { found.push_back({dist, &item}); }
+        });
+        return found;
+    }
 };
 
 }} // namespace navitia::proximitylist
@@ -130,7 +130,7 @@ void find(navitia::PbCreator& pb_creator,
             list = pb_creator.data->pt_data->stop_point_proximity_list.find_within(coord, distance);
             break;
         case nt::Type_e::POI:
-            list = pb_creator.data->geo_ref->poi_proximity_list.find_within(coord, distance);
+            list = pb_creator.data->geo_ref->poi_proximity_list->find_within(coord, distance);
             break;
         default: break;
         }
@@ -0,0 +1,136 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "proximity_list/proximity_list.h"
+#include "georef/georef.h"
+#include "type/data.h"
+#include "tests/benchmark_utils.h"
+#include <iostream>
+
+/*
+ * Benchmark of the proximity list on the street network vertices of a
+ * data.nav.lz4: find_within and find_nearest on the grid, compared to a
+ * scan of the longitude band of the vector sorted by longitude used before.
+ */
+
+using namespace navitia;
+using navitia::type::GeographicalCoord;
+using benchmark::Clock;
+using benchmark::elapsed_us;
+
+namespace {
+typedef proximitylist::ProximityList<georef::vertex_t>::Item Item;
+
+// the previous implementation: a binary search of the longitude band, then a scan of the band
+size_t find_within_band(const std::vector<Item>& items, const GeographicalCoord& coord, double distance) {
+    const double distance_degree = distance / proximitylist::meters_by_degree;
+    const double coslat = ::cos(coord.lat() * GeographicalCoord::N_DEG_TO_RAD);
+    auto begin = std::lower_bound(items.begin(), items.end(), coord.lon() - distance_degree / coslat,
+                                  [](const Item& i, double min){ return i.coord.lon() < min; });
+    auto end = std::upper_bound(begin, items.end(), coord.lon() + distance_degree / coslat,
+                                [](double max, const Item& i){ return max < i.coord.lon(); });
+    std::vector<std::pair<double, georef::vertex_t>> result;
+    for (; begin != end; ++begin) {
+        const auto dist = begin->coord.approx_sqr_distance(coord, coslat);
+        if (dist <= distance * distance) { result.push_back({dist, begin->element}); }
+    }
+    std::sort(result.begin(), result.end());
+    return result.size();
+}
+}
+
+int main(int argc, char** argv) {
+    namespace po = boost::program_options;
+    benchmark::CommandLine command_line("Options of the proximity list benchmark");
+    int nb_queries;
+    double radius;
+    command_line.add_options()
+            ("nb_queries,n", po::value<int>(&nb_queries)->default_value(10000),
+                     "Number of queries")
+            ("radius,r", po::value<double>(&radius)->default_value(500),
+                     "Radius of the find_within queries in meters");
+    if (! command_line.parse(argc, argv)) {
+        return 1;
+    }
+
+    type::Data data;
+    benchmark::load_data(data, command_line.file);
+    const auto& pl = *data.geo_ref->pl;
+    if (pl.items.empty()) {
+        std::cout << "no street network" << std::endl;
+        return 1;
+    }
+
+    auto begin = Clock::now();
+    proximitylist::ProximityList<georef::vertex_t> rebuilt = pl;
+    rebuilt.build();
+    const auto build_us = elapsed_us(begin);
+
+    auto sorted_by_lon = pl.items;
+    std::sort(sorted_by_lon.begin(), sorted_by_lon.end(),
+              [](const Item& a, const Item& b){ return a.coord < b.coord; });
+
+    // queries around random vertices
+    auto rng = benchmark::make_rng();
+    std::uniform_int_distribution<size_t> item_gen(0, pl.items.size() - 1);
+    std::uniform_real_distribution<double> jitter(-0.002, 0.002);
+    std::vector<GeographicalCoord> coords;
+    for (int i = 0; i < nb_queries; ++i) {
+        const auto& c = pl.items[item_gen(rng)].coord;
+        coords.emplace_back(c.lon() + jitter(rng), c.lat() + jitter(rng));
+    }
+
+    size_t nb_found = 0, nb_found_band = 0;
+    begin = Clock::now();
+    for (const auto& coord: coords) { nb_found += pl.find_within(coord, radius).size(); }
+    const auto grid_us = elapsed_us(begin);
+
+    begin = Clock::now();
+    for (const auto& coord: coords) { nb_found_band += find_within_band(sorted_by_lon, coord, radius); }
+    const auto band_us = elapsed_us(begin);
+
+    begin = Clock::now();
+    for (const auto& coord: coords) {
+        try {
+            pl.find_nearest(coord);
+        } catch (const proximitylist::NotFound&) {}
+    }
+    const auto nearest_us = elapsed_us(begin);
+
+    std::cout << pl.items.size() << " vertices, " << pl.cell_keys.size() << " non empty cells of "
+              << pl.lat_step * proximitylist::meters_by_degree << " m" << std::endl
+              << "build: " << build_us / 1000 << " ms" << std::endl
+              << "find_within: " << grid_us / nb_queries << " us on the grid, "
+              << band_us / nb_queries << " us on the longitude band ("
+              << double(nb_found) / nb_queries << " and " << double(nb_found_band) / nb_queries
+              << " found by query)" << std::endl
+              << "find_nearest: " << nearest_us / nb_queries << " us" << std::endl;
+    return 0;
+}
@@ -38,6 +38,7 @@ www.navitia.io
 #include "georef/georef.h"
 #include "type/pt_data.h"
 #include "type/pb_converter.h"
+#include <random>
 
 using namespace navitia::type;
 using namespace navitia::proximitylist;
@@ -115,9 +116,11 @@ BOOST_AUTO_TEST_CASE(find_nearest){
 
     pl.build();
 
-    std::vector<unsigned int> expected {1,4,2,6,5,3};
-    for(size_t i=0; i < expected.size(); ++i)
-        BOOST_CHECK_EQUAL(pl.items[i].element, expected[i]);
+    std::vector<unsigned int> expected {1,2,3,4,5,6};
+    std::vector<unsigned int> elements;
+    for (const auto& item: pl.items) { elements.push_back(item.element); }
+    std::sort(elements.begin(), elements.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(elements.begin(), elements.end(), expected.begin(), expected.end());
 
 
     c.set_lon(M_TO_DEG *2); c.set_lat(M_TO_DEG *3);
@@ -174,6 +177,70 @@ BOOST_AUTO_TEST_CASE(find_nearest){
     BOOST_CHECK_EQUAL_COLLECTIONS(tmp.begin(), tmp.end(), expected.begin(), expected.end());
 }
 
+/*
+ * the grid gives the same elements as a scan of all the elements, even
+ * with some 0,0 coordinates far away from the others
+ */
+BOOST_AUTO_TEST_CASE(find_within_same_as_scan) {
+    ProximityList<unsigned int> pl;
+    std::vector<GeographicalCoord> coords;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> lon_gen(2.2, 2.5), lat_gen(48.8, 48.9);
+    for (unsigned int i = 0; i < 5000; ++i) {
+        const auto coord = i % 1000 == 0 ? GeographicalCoord(0, 0) : GeographicalCoord(lon_gen(rng), lat_gen(rng));
+        coords.push_back(coord);
+        pl.add(coord, i);
+    }
+    pl.build();
+
+    for (int i = 0; i < 100; ++i) {
+        const auto coord = i % 10 == 0 ? GeographicalCoord(0.001, 0) : GeographicalCoord(lon_gen(rng), lat_gen(rng));
+        const double coslat = ::cos(coord.lat() * GeographicalCoord::N_DEG_TO_RAD);
+        for (const double distance: {50., 300., 1000.}) {
+            std::vector<std::pair<double, unsigned int>> expected;
+            for (unsigned int idx = 0; idx < coords.size(); ++idx) {
+                const auto dist = coords[idx].approx_sqr_distance(coord, coslat);
+                if (dist <= distance * distance) { expected.push_back({dist, idx}); }
+            }
+            std::sort(expected.begin(), expected.end());
+
+            const auto within = pl.find_within(coord, distance);
+            BOOST_REQUIRE_EQUAL(within.size(), expected.size());
+            for (size_t j = 0; j < within.size(); ++j) {
+                BOOST_CHECK_EQUAL(within[j].second.approx_sqr_distance(coord, coslat), expected[j].first);
+            }
+
+            const auto nearest = pl.find_k_nearest(coord, 3, distance);
+            BOOST_REQUIRE_EQUAL(nearest.size(), std::min<size_t>(3, expected.size()));
+            for (size_t j = 0; j < nearest.size(); ++j) {
+                BOOST_CHECK_EQUAL(nearest[j].second.approx_sqr_distance(coord, coslat), expected[j].first);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(find_k_nearest) {
+    constexpr double M_TO_DEG = 1.0/111320.0;
+    ProximityList<unsigned int> pl;
+    BOOST_CHECK(pl.find_k_nearest(GeographicalCoord(0, 0), 2).empty());
+    BOOST_CHECK_THROW(pl.find_nearest(GeographicalCoord(0, 0)), NotFound);
+
+    for (unsigned int i = 0; i < 100; ++i) {
+        pl.add(GeographicalCoord(M_TO_DEG * 10 * i, 0), i);
+    }
+    pl.build();
+
+    const auto nearest = pl.find_k_nearest(GeographicalCoord(M_TO_DEG * 502, 0), 3);
+    BOOST_REQUIRE_EQUAL(nearest.size(), 3);
+    BOOST_CHECK_EQUAL(nearest[0].first, 50);
+    BOOST_CHECK_EQUAL(nearest[1].first, 51);
+    BOOST_CHECK_EQUAL(nearest[2].first, 49);
+    // only the elements within max_dist
+    BOOST_CHECK_EQUAL(pl.find_k_nearest(GeographicalCoord(M_TO_DEG * 502, 0), 10, 10).size(), 2);
+    BOOST_CHECK_EQUAL(pl.find_nearest(GeographicalCoord(M_TO_DEG * 2000, 0), 2000), 99);
+    BOOST_CHECK_THROW(pl.find_nearest(GeographicalCoord(M_TO_DEG * 2000, 0)), NotFound);
+}
+
 BOOST_AUTO_TEST_CASE(test_api) {
     navitia::type::Data data;
     //Everything in the range
@@ -302,8 +302,10 @@ static Indexes get_indexes_by_impacts(const Data & d, const type::Type_e& type_e
     return result;
 }
 
+// Indexes of the objects of requested_type matching the filter, as a
+// bitset of get_nb_obj(requested_type) bits
 template<typename T>
-Indexes get_indexes(Filter filter,  Type_e requested_type, const Data & d) {
+static IndexesBitset get_indexes_bitset(Filter filter,  Type_e requested_type, const Data & d) {
     Indexes indexes;
     if(filter.op == DWITHIN) {
         std::vector<std::string> splited;
@@ -324,7 +326,7 @@ Indexes get_indexes(Filter filter,  Type_e requested_type, const Data & d) {
             switch(filter.navitia_type){
             case Type_e::StopPoint: tmp = d.pt_data->stop_point_proximity_list.find_within(coord, distance); break;
             case Type_e::StopArea: tmp = d.pt_data->stop_area_proximity_list.find_within(coord, distance);break;
-            case Type_e::POI: tmp = d.geo_ref->poi_proximity_list.find_within(coord, distance);break;
+            case Type_e::POI: tmp = d.geo_ref->poi_proximity_list->find_within(coord, distance);break;
             default: throw ptref_error("The requested object can not be used a DWITHIN clause");
             }
             std::vector<idx_t> tmp_idx;
@@ -388,19 +390,22 @@ Indexes get_indexes(Filter filter,  Type_e requested_type, const Data & d) {
         const auto& data = d.get_data<T>();
         indexes = filtered_indexes(data, build_clause<T>({filter}));
     }
+    // the traversal can reach a lot of objects (all the vehicle journeys
+    // of a network for example), thus it is done on dense sets
     Type_e current = filter.navitia_type;
+    IndexesBitset bitset = make_bitset(indexes, d.get_nb_obj(current));
     std::map<Type_e, Type_e> path = find_path(requested_type);
     while(path[current] != current){
-        indexes = d.get_target_by_source(current, path[current], indexes);
+        bitset = d.get_target_by_source(current, path[current], bitset);
         current = path[current];
     }
 
     if (current != requested_type) {
         // there was no path to find a requested type
-        return Indexes{};
+        return IndexesBitset(d.get_nb_obj(requested_type));
     }
 
-    return indexes;
+    return bitset;
 }
 
 std::vector<Filter> parse(std::string request){
@@ -586,44 +591,47 @@ Indexes make_query(const Type_e requested_type,
         }
     }
 
-    Indexes final_indexes;
-    if (! data.get_nb_obj(requested_type)) {
+    const size_t nb_obj = data.get_nb_obj(requested_type);
+    if (! nb_obj) {
         throw ptref_error("Filters: No requested object in the database");
     }
 
+    // the intermediate results are dense sets of nb_obj bits, sorted
+    // indexes are only built at the end
+    IndexesBitset final_bitset(nb_obj);
     if (filters.empty()) {
-        final_indexes = data.get_all_index(requested_type);
+        final_bitset.set();
     } else {
-        Indexes indexes;
+        IndexesBitset indexes;
         bool first_time = true;
         for (const Filter& filter : filters) {
             switch(filter.navitia_type){
     #define GET_INDEXES(type_name, collection_name)\
             case Type_e::type_name:\
-                indexes = get_indexes<type_name>(filter, requested_type, data);\
+                indexes = get_indexes_bitset<type_name>(filter, requested_type, data);\
                 break;
             ITERATE_NAVITIA_PT_TYPES(GET_INDEXES)
     #undef GET_INDEXES
             case Type_e::JourneyPattern:
-                indexes = get_indexes<routing::JourneyPattern>(filter, requested_type, data);
+                indexes = get_indexes_bitset<routing::JourneyPattern>(filter, requested_type, data);
                 break;
             case Type_e::JourneyPatternPoint:
-                indexes = get_indexes<routing::JourneyPatternPoint>(filter, requested_type, data);
+                indexes = get_indexes_bitset<routing::JourneyPatternPoint>(filter, requested_type, data);
                 break;
             case Type_e::POI:
-                indexes = get_indexes<georef::POI>(filter, requested_type, data);
+                indexes = get_indexes_bitset<georef::POI>(filter, requested_type, data);
                 break;
             case Type_e::POIType:
-                indexes = get_indexes<georef::POIType>(filter, requested_type, data);
+                indexes = get_indexes_bitset<georef::POIType>(filter, requested_type, data);
                 break;
             case Type_e::Connection:
-                indexes = get_indexes<type::StopPointConnection>(filter, requested_type, data);
+                indexes = get_indexes_bitset<type::StopPointConnection>(filter, requested_type, data);
                 break;
             case Type_e::MetaVehicleJourney:
-                indexes = get_indexes<type::MetaVehicleJourney>(filter, requested_type, data);
+                indexes = get_indexes_bitset<type::MetaVehicleJourney>(filter, requested_type, data);
                 break;
             case Type_e::Impact:
-                indexes = get_indexes<type::disruption::Impact>(filter, requested_type, data);
+                indexes = get_indexes_bitset<type::disruption::Impact>(filter, requested_type, data);
                 break;
             default:
                 throw parsing_error(parsing_error::partial_error,
@@ -631,9 +639,9 @@ Indexes make_query(const Type_e requested_type,
                         + nt::static_data::get()->captionByType(filter.navitia_type) + "<<");
             }
             if (first_time) {
-                final_indexes = indexes;
+                final_bitset = std::move(indexes);
             } else {
-                final_indexes = get_intersection(final_indexes, indexes);
+                final_bitset &= indexes;
             }
             first_time = false;
         }
@@ -654,28 +662,28 @@ Indexes make_query(const Type_e requested_type,
 
         Filter filter_forbidden(caption_type, "uri", Operator_e::EQ, forbidden_uri);
         filter_forbidden.navitia_type = type_;
-        Indexes forbidden_idx;
+        IndexesBitset forbidden_idx;
         switch(type_){
 #define GET_INDEXES_FORBID(type_name, collection_name)\
         case Type_e::type_name:\
-            forbidden_idx = get_indexes<type_name>(filter_forbidden, requested_type, data);\
+            forbidden_idx = get_indexes_bitset<type_name>(filter_forbidden, requested_type, data);\
             break;
             ITERATE_NAVITIA_PT_TYPES(GET_INDEXES_FORBID)
 #undef GET_INDEXES_FORBID
         case Type_e::JourneyPattern:
-            forbidden_idx = get_indexes<routing::JourneyPattern>(filter_forbidden, requested_type, data);
+            forbidden_idx = get_indexes_bitset<routing::JourneyPattern>(filter_forbidden, requested_type, data);
             break;
         case Type_e::JourneyPatternPoint:
-            forbidden_idx = get_indexes<routing::JourneyPatternPoint>(filter_forbidden, requested_type, data);
+            forbidden_idx = get_indexes_bitset<routing::JourneyPatternPoint>(filter_forbidden, requested_type, data);
             break;
         case Type_e::POI:
-            forbidden_idx = get_indexes<georef::POI>(filter_forbidden, requested_type, data);
+            forbidden_idx = get_indexes_bitset<georef::POI>(filter_forbidden, requested_type, data);
             break;
         case Type_e::POIType:
-            forbidden_idx = get_indexes<georef::POIType>(filter_forbidden, requested_type, data);
+            forbidden_idx = get_indexes_bitset<georef::POIType>(filter_forbidden, requested_type, data);
             break;
         case Type_e::Connection:
-            forbidden_idx = get_indexes<type::StopPointConnection>(filter_forbidden, requested_type, data);
+            forbidden_idx = get_indexes_bitset<type::StopPointConnection>(filter_forbidden, requested_type, data);
             break;
         default:
             throw parsing_error(parsing_error::partial_error,
@@ -683,8 +691,10 @@ Indexes make_query(const Type_e requested_type,
                                 + nt::static_data::get()->captionByType(filter_forbidden.navitia_type)
                                 + "<<");
         }
-        final_indexes = get_difference(final_indexes, forbidden_idx);
+        final_bitset -= forbidden_idx;
     }
+    Indexes final_indexes = make_indexes(final_bitset);
+
     // Manage OdtLevel
     if (odt_level != navitia::type::OdtLevel_e::all) {
         final_indexes = manage_odt_level(final_indexes, requested_type, odt_level, data);
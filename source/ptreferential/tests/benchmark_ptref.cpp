@@ -0,0 +1,140 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "ptreferential/ptreferential.h"
+#include "type/data.h"
+#include "type/pt_data.h"
+#include "tests/benchmark_utils.h"
+#include <functional>
+#include <iostream>
+
+/*
+ * Benchmark of ptref: latency of make_query on filters like the ones of
+ * /lines, /stop_areas or /vehicle_journeys, with random objects of a
+ * data.nav.lz4. The big requests (all the vehicle journeys of a network,
+ * all the lines minus a forbidden one) traverse a lot of objects.
+ */
+
+using namespace navitia;
+
+namespace {
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) { return 0; }
+    const size_t rank = std::min(values.size() - 1, size_t(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+// A kind of request: the requested type, and the filter and the
+// forbidden uris built from random objects
+struct Scenario {
+    std::string name;
+    type::Type_e requested_type;
+    std::function<std::string()> filter;
+    std::function<std::vector<std::string>()> forbidden_uris;
+};
+
+template<typename T>
+std::function<std::string()> random_uri(const std::vector<T*>& objs, std::mt19937& rng) {
+    return [&objs, &rng]() -> std::string {
+        if (objs.empty()) { return ""; }
+        std::uniform_int_distribution<size_t> gen(0, objs.size() - 1);
+        return objs[gen(rng)]->uri;
+    };
+}
+}
+
+int main(int argc, char** argv) {
+    namespace po = boost::program_options;
+    benchmark::CommandLine command_line("Options of the ptref benchmark");
+    int nb_queries;
+    command_line.add_options()
+            ("nb_queries,n", po::value<int>(&nb_queries)->default_value(100),
+                     "Number of queries by scenario");
+    if (! command_line.parse(argc, argv)) {
+        return 1;
+    }
+
+    type::Data data;
+    benchmark::load_data(data, command_line.file);
+
+    const auto& pt_data = *data.pt_data;
+    auto rng = benchmark::make_rng();
+    const auto stop_area = random_uri(pt_data.stop_areas, rng);
+    const auto stop_point = random_uri(pt_data.stop_points, rng);
+    const auto line = random_uri(pt_data.lines, rng);
+    const auto network = random_uri(pt_data.networks, rng);
+    const auto physical_mode = random_uri(pt_data.physical_modes, rng);
+    const auto none = []() { return std::vector<std::string>(); };
+
+    const std::vector<Scenario> scenarios = {
+        {"lines of a stop area", type::Type_e::Line,
+         [&]() { return "stop_area.uri=" + stop_area(); }, none},
+        {"stop points of a line", type::Type_e::StopPoint,
+         [&]() { return "line.uri=" + line(); }, none},
+        {"vehicle journeys of a line", type::Type_e::VehicleJourney,
+         [&]() { return "line.uri=" + line(); }, none},
+        {"vehicle journeys of a network", type::Type_e::VehicleJourney,
+         [&]() { return "network.uri=" + network(); }, none},
+        {"stop areas of a network and a mode", type::Type_e::StopArea,
+         [&]() { return "network.uri=" + network() + " and physical_mode.uri=" + physical_mode(); }, none},
+        {"lines of a stop point without a line", type::Type_e::Line,
+         [&]() { return "stop_point.uri=" + stop_point(); },
+         [&]() { return std::vector<std::string>{line()}; }},
+        {"all the lines without a network", type::Type_e::Line,
+         []() { return std::string(); },
+         [&]() { return std::vector<std::string>{network()}; }},
+        {"all the vehicle journeys without a stop area", type::Type_e::VehicleJourney,
+         []() { return std::string(); },
+         [&]() { return std::vector<std::string>{stop_area()}; }},
+    };
+
+    for (const auto& scenario: scenarios) {
+        if (! data.get_nb_obj(scenario.requested_type)) { continue; }
+        std::vector<double> latencies;
+        size_t nb_objects = 0;
+        for (int i = 0; i < nb_queries; ++i) {
+            const auto filter = scenario.filter();
+            const auto forbidden_uris = scenario.forbidden_uris();
+            const auto begin = benchmark::Clock::now();
+            try {
+                nb_objects += ptref::make_query(scenario.requested_type, filter, forbidden_uris, data).size();
+            } catch (const ptref::ptref_error&) {
+                // nothing found, it is a valid answer
+            }
+            latencies.push_back(benchmark::elapsed_us(begin));
+        }
+        std::cout << scenario.name << ": " << latencies.size() << " queries, "
+                  << double(nb_objects) / latencies.size() << " objects by query, p50 "
+                  << percentile(latencies, 0.5) / 1000 << " ms, p99 "
+                  << percentile(latencies, 0.99) / 1000 << " ms" << std::endl;
+    }
+    return 0;
+}
@@ -43,10 +43,6 @@ www.navitia.io
 #include "kraken/apply_disruption.h"
 #include <boost/range/adaptors.hpp>
 
-namespace navitia{namespace ptref {
-template<typename T> nt::Indexes get_indexes(Filter filter,  Type_e requested_type, const type::Data & d);
-}}
-
 namespace nt = navitia::type;
 using namespace navitia::ptref;
 BOOST_AUTO_TEST_CASE(parser){
@@ -330,21 +326,45 @@ BOOST_AUTO_TEST_CASE(get_indexes_test){
     b.data->pt_data->build_uri();
 
     // On cherche à retrouver la ligne 1, en passant le stoparea en filtre
-    Filter filter;
-    filter.navitia_type = Type_e::StopArea;
-    filter.attribute = "uri";
-    filter.op = EQ;
-    filter.value = "stop1";
-    auto indexes = get_indexes<nt::StopArea>(filter, Type_e::Line, *(b.data));
+    auto indexes = make_query(Type_e::Line, "stop_area.uri=stop1", *(b.data));
     BOOST_CHECK_EQUAL_RANGE(indexes, nt::make_indexes({0}));
 
     // On cherche les stopareas de la ligneA
-    filter.navitia_type = Type_e::Line;
-    filter.value = "A";
-    indexes = get_indexes<nt::Line>(filter, Type_e::StopArea, *(b.data));
+    indexes = make_query(Type_e::StopArea, "line.uri=A", *(b.data));
     BOOST_CHECK_EQUAL_RANGE(indexes, nt::make_indexes({0, 1}));
 }
 
+BOOST_AUTO_TEST_CASE(get_target_by_source_bitset_test){
+    ed::builder b("201303011T1739");
+    b.generate_dummy_basis();
+    b.vj("A")("stop1", 8000,8050)("stop2", 8200,8250);
+    b.vj("B")("stop2", 9000,9050)("stop3", 9200,9250);
+    b.vj("C")("stop4", 9000,9050)("stop5", 9200,9250);
+    b.finish();
+    b.data->pt_data->index();
+    b.data->pt_data->build_uri();
+    const auto& d = *(b.data);
+
+    // the traversal on the dense sets gives the same indexes as on the sorted ones
+    const auto sp_idx = nt::make_indexes({0, 2, 4});
+    const auto sa_idx = d.get_target_by_source(Type_e::StopPoint, Type_e::StopArea, sp_idx);
+    const auto sa_bitset = d.get_target_by_source(Type_e::StopPoint, Type_e::StopArea,
+                                                  nt::make_bitset(sp_idx, d.get_nb_obj(Type_e::StopPoint)));
+    BOOST_CHECK_EQUAL(sa_bitset.size(), d.get_nb_obj(Type_e::StopArea));
+    BOOST_CHECK_EQUAL(sa_idx.size(), 3);
+    BOOST_CHECK_EQUAL_RANGE(nt::make_indexes(sa_bitset), sa_idx);
+
+    // intersection of the filters
+    auto indexes = make_query(Type_e::StopArea, "line.uri=A and line.uri=B", d);
+    BOOST_CHECK_EQUAL_RANGE(get_uris<nt::StopArea>(indexes, d), std::set<std::string>({"stop2"}));
+
+    // forbidden uris
+    indexes = make_query(Type_e::Line, "stop_area.uri=stop2", {"A"}, d);
+    BOOST_CHECK_EQUAL_RANGE(get_uris<nt::Line>(indexes, d), std::set<std::string>({"B"}));
+    indexes = make_query(Type_e::Line, "", {"A", "stop5"}, d);
+    BOOST_CHECK_EQUAL_RANGE(get_uris<nt::Line>(indexes, d), std::set<std::string>({"B"}));
+}
+
 BOOST_AUTO_TEST_CASE(get_impact_indexes_of_line){
     ed::builder b("201303011T1739");
     b.vj("A", "000001", "", true, "vj:A-1")("stop1", "08:00"_t)("stop2", "09:00"_t);
@@ -360,19 +380,13 @@ BOOST_AUTO_TEST_CASE(get_impact_indexes_of_line){
                      .application_periods(btp("20150928T000000"_dt, "20150928T240000"_dt))
                      .get_disruption();
 
-    Filter filter;
-    filter.navitia_type = Type_e::Line;
-    filter.attribute = "uri";
-    filter.op = EQ;
-    filter.value = "A";
-
     navitia::apply_disruption(disrup_1, *b.data->pt_data, *b.data->meta);
-    auto indexes = get_indexes<nt::Line>(filter, Type_e::Impact, *(b.data));
+    auto indexes = make_query(Type_e::Impact, "line.uri=A", *(b.data));
     BOOST_CHECK_EQUAL_RANGE(indexes, std::vector<size_t>{0});
 
+    // no impact found
     navitia::delete_disruption("Disruption 1", *b.data->pt_data, *b.data->meta);
-    indexes = get_indexes<nt::Line>(filter, Type_e::Impact, *(b.data));
-    BOOST_REQUIRE_EQUAL(indexes.size(), 0);
+    BOOST_CHECK_THROW(make_query(Type_e::Impact, "line.uri=A", *(b.data)), ptref_error);
 
     const auto& disrup_2 = b.impact(nt::RTLevel::RealTime, "Disruption 2")
                      .severity(nt::disruption::Effect::NO_SERVICE)
@@ -381,7 +395,7 @@ BOOST_AUTO_TEST_CASE(get_impact_indexes_of_line){
                      .get_disruption();
 
     navitia::apply_disruption(disrup_2, *b.data->pt_data, *b.data->meta);
-    indexes = get_indexes<nt::Line>(filter, Type_e::Impact, *(b.data));
+    indexes = make_query(Type_e::Impact, "line.uri=A", *(b.data));
     BOOST_CHECK_EQUAL_RANGE(indexes, std::vector<size_t>{0});
 
     const auto& disrup_3 = b.impact(nt::RTLevel::RealTime, "Disruption 3")
@@ -391,7 +405,7 @@ BOOST_AUTO_TEST_CASE(get_impact_indexes_of_line){
                      .get_disruption();
 
     navitia::apply_disruption(disrup_3, *b.data->pt_data, *b.data->meta);
-    indexes = get_indexes<nt::Line>(filter, Type_e::Impact, *(b.data));
+    indexes = make_query(Type_e::Impact, "line.uri=A", *(b.data));
     BOOST_CHECK_EQUAL_RANGE(indexes, nt::make_indexes({0, 1}));
 }
 
@@ -410,14 +424,8 @@ BOOST_AUTO_TEST_CASE(get_impact_indexes_of_stop_point){
                      .application_periods(btp("20150928T000000"_dt, "20150928T240000"_dt))
                      .get_disruption();
 
-    Filter filter;
-    filter.navitia_type = Type_e::StopPoint;
-    filter.attribute = "uri";
-    filter.op = EQ;
-    filter.value = "stop1";
-
     navitia::apply_disruption(disrup_1, *b.data->pt_data, *b.data->meta);
-    auto indexes = get_indexes<nt::StopPoint>(filter, Type_e::Impact, *(b.data));
+    auto indexes = make_query(Type_e::Impact, "stop_point.uri=stop1", *(b.data));
     BOOST_CHECK_EQUAL_RANGE(indexes, std::vector<size_t>{0});
 }
 
@@ -649,21 +657,8 @@ BOOST_AUTO_TEST_CASE(mvj_filtering) {
     const auto mvj_idx = navitia::Idx<nt::MetaVehicleJourney>(*indexes.begin());
     BOOST_CHECK_EQUAL(builder.data->pt_data->meta_vjs[mvj_idx]->uri, "vehicle_journey 0");
 
-    // looking for MetaVJ 0 another way
-    Filter filter;
-    filter.navitia_type = Type_e::MetaVehicleJourney;
-    filter.attribute = "uri";
-    filter.op = EQ;
-    filter.value = "vehicle_journey 0";
-    indexes = get_indexes<nt::MetaVehicleJourney>(filter, Type_e::MetaVehicleJourney, *(builder.data));
-    BOOST_CHECK_EQUAL_RANGE(indexes, {0});
-
     // looking for MetaVJ A through VJ A
-    filter.navitia_type = Type_e::VehicleJourney;
-    filter.attribute = "uri";
-    filter.op = EQ;
-    filter.value = "vj:A:0";
-    indexes = get_indexes<nt::VehicleJourney>(filter, Type_e::MetaVehicleJourney, *(builder.data));
+    indexes = make_query(nt::Type_e::MetaVehicleJourney, "vehicle_journey.uri=vj:A:0", *(builder.data));
     BOOST_CHECK_EQUAL_RANGE(indexes, {0})
 
     //not limited, we get 3 vj
@@ -671,11 +666,7 @@ BOOST_AUTO_TEST_CASE(mvj_filtering) {
     BOOST_CHECK_EQUAL_RANGE(indexes, std::vector<size_t>({a, b, c}));
 
     // looking for VJ B through MetaVJ B
-    filter.navitia_type = Type_e::MetaVehicleJourney;
-    filter.attribute = "uri";
-    filter.op = EQ;
-    filter.value = "vehicle_journey 1";
-    indexes = get_indexes<nt::MetaVehicleJourney>(filter, Type_e::VehicleJourney, *(builder.data));
+    indexes = make_query(nt::Type_e::VehicleJourney, R"(trip.uri="vehicle_journey 1")", *(builder.data));
     BOOST_CHECK_EQUAL_RANGE(indexes, {b})
 }
 
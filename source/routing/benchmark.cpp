@@ -87,6 +87,7 @@ int main(int argc, char** argv){
             ("hour,h", po::value<int>(&hour)->default_value(-1),
                     "Begginning hour of a particular journey")
             ("verbose,v", "Verbose debugging output")
+            ("jp_stats", "Print the number of journey patterns explored at each raptor round")
             ("stop_files", po::value<std::string>(&stop_input_file), "File with list of start and target")
             ("output,o", po::value<std::string>(&output)->default_value("benchmark.csv"),
                      "Output file");
@@ -94,6 +95,7 @@ int main(int argc, char** argv){
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
     bool verbose = vm.count("verbose");
+    bool jp_stats = vm.count("jp_stats");
 
     if (vm.count("help")) {
         std::cout << "This is used to benchmark journey computation" << std::endl;
@@ -255,4 +257,16 @@ int main(int argc, char** argv){
 
     std::cout << "Number of requests: " << demands.size() << std::endl;
     std::cout << "Number of results with solution: " << nb_reponses << std::endl;
+
+    if (jp_stats && ! demands.empty()) {
+        // a round used to scan every journey pattern, it now only
+        // explores the ones marked by the previous round
+        const auto nb_jps = data.dataRaptor->jp_container.nb_jps();
+        std::cout << "Explored journey patterns by round (mean by request, out of "
+                  << nb_jps << " journey patterns):" << std::endl;
+        for (size_t round = 1; round < router.nb_explored_jps_by_round.size(); ++round) {
+            std::cout << "  round " << round << ": "
+                      << router.nb_explored_jps_by_round[round] / demands.size() << std::endl;
+        }
+    }
 }
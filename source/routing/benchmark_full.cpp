@@ -78,7 +78,7 @@ static type::GeographicalCoord coord_of_entry_point(const type::EntryPoint& entr
             auto way = data.geo_ref->way_map.find(entry_point.uri);
             if (way != data.geo_ref->way_map.end()){
                 const auto geo_way = data.geo_ref->ways[way->second];
-                return geo_way->nearest_coord(entry_point.house_number, data.geo_ref->graph);
+                return geo_way->nearest_coord(entry_point.house_number, *data.geo_ref->graph);
             }
         }
         break;
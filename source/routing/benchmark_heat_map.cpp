@@ -0,0 +1,97 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "routing/heat_map.h"
+#include "georef/street_network.h"
+#include "type/data.h"
+#include "tests/benchmark_utils.h"
+#include <algorithm>
+#include <iostream>
+
+/*
+ * Benchmark of the grid fill of the heat maps at 100, 500 and 1000 steps,
+ * with one and several threads. The durations of the vertices come from a
+ * walking dijkstra started at a random vertex of a data.nav.lz4.
+ */
+
+using namespace navitia;
+using namespace navitia::routing;
+
+int main(int argc, char** argv) {
+    namespace po = boost::program_options;
+    benchmark::CommandLine command_line("Options of the heat map benchmark");
+    int radius, nb_threads;
+    command_line.add_options()
+            ("radius,r", po::value<int>(&radius)->default_value(3600),
+                     "Max duration in seconds")
+            ("nb_threads,t", po::value<int>(&nb_threads)->default_value(4),
+                     "Number of threads filling the grid");
+    if (! command_line.parse(argc, argv)) {
+        return 1;
+    }
+
+    type::Data data;
+    benchmark::load_data(data, command_line.file);
+    const auto& geo_ref = *data.geo_ref;
+    if (geo_ref.nb_vertex_by_mode == 0) {
+        std::cout << "no street network" << std::endl;
+        return 1;
+    }
+
+    auto rng = benchmark::make_rng();
+    std::uniform_int_distribution<georef::vertex_t> vertex_gen(0, geo_ref.nb_vertex_by_mode - 1);
+    const auto origin = (*geo_ref.graph)[vertex_gen(rng)].coord;
+    const auto speed = georef::default_speed[type::Mode_e::Walking];
+
+    georef::PathFinder path_finder(geo_ref);
+    path_finder.init(origin, type::Mode_e::Walking, 1);
+    path_finder.start_distance_dijkstra(navitia::seconds(radius));
+
+    BoundBox box;
+    box.set_box(origin, radius * speed / type::GeographicalCoord::EARTH_RADIUS_IN_METERS * N_RAD_TO_DEG);
+
+    for (const size_t step: {100, 500, 1000}) {
+        const double width_step = (box.max.lon() - box.min.lon()) / step;
+        const double height_step = (box.max.lat() - box.min.lat()) / step;
+        const double min_dist = std::max({500., width_step * N_DEG_TO_DISTANCE, height_step * N_DEG_TO_DISTANCE});
+        const auto fill_ms = [&](size_t threads) {
+            navitia::ThreadPool pool(threads);
+            const auto start = benchmark::Clock::now();
+            fill_heat_map(box, height_step, width_step, geo_ref, min_dist, radius, speed,
+                          path_finder.distances, step, pool, threads);
+            return benchmark::elapsed_ms(start);
+        };
+        const auto one_thread_ms = fill_ms(1);
+        const auto threads_ms = fill_ms(nb_threads);
+        std::cout << step << "x" << step << " grid, 1 thread: " << one_thread_ms << " ms, "
+                  << nb_threads << " threads: " << threads_ms << " ms" << std::endl;
+    }
+    return 0;
+}
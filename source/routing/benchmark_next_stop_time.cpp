@@ -0,0 +1,131 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "next_stop_time.h"
+#include "dataraptor.h"
+#include "simd_lower_bound.h"
+#include "type/data.h"
+#include "tests/benchmark_utils.h"
+#include <algorithm>
+#include <iostream>
+
+/*
+ * Micro benchmark of the earliest trip lookup:
+ *  - the lower bound kernels (std::lower_bound, branchless scalar and
+ *    simd_lower_bound) on sorted arrays of growing size,
+ *  - NextStopTime::earliest_stop_time on random journey pattern points
+ *    of a data.nav.lz4, if given.
+ */
+
+using namespace navitia;
+using namespace routing;
+
+namespace {
+template<typename F>
+void run(const std::string& name, size_t nb_lookups, F lookup) {
+    size_t res = 0;
+    const auto begin = benchmark::Clock::now();
+    for (size_t i = 0; i < nb_lookups; ++i) {
+        res += lookup(i);
+    }
+    const auto us = benchmark::elapsed_us(begin);
+    std::cout << name << ": " << us * 1000 / nb_lookups << " ns by lookup (" << res << ")" << std::endl;
+}
+
+void bench_kernels(size_t nb_lookups) {
+    auto rng = benchmark::make_rng();
+    std::uniform_int_distribution<DateTime> hour_gen(0, DateTimeUtils::SECONDS_PER_DAY - 1);
+    for (size_t size: {8, 32, 128, 512, 2048}) {
+        std::vector<DateTime> times(size);
+        for (auto& t: times) { t = hour_gen(rng); }
+        std::sort(times.begin(), times.end());
+        std::vector<DateTime> values(nb_lookups);
+        for (auto& v: values) { v = hour_gen(rng); }
+
+        std::cout << "size " << size << std::endl;
+        run("  std::lower_bound", nb_lookups, [&](size_t i) {
+            return size_t(std::lower_bound(times.begin(), times.end(), values[i]) - times.begin());
+        });
+        run("  scalar_lower_bound", nb_lookups, [&](size_t i) {
+            return scalar_lower_bound(times.data(), times.size(), values[i]);
+        });
+        run("  simd_lower_bound", nb_lookups, [&](size_t i) {
+            return simd_lower_bound(times.data(), times.size(), values[i]);
+        });
+    }
+}
+
+void bench_next_stop_time(const type::Data& data, size_t nb_lookups) {
+    const auto& jp_container = data.dataRaptor->jp_container;
+    if (jp_container.nb_jpps() == 0) {
+        std::cout << "no journey pattern point" << std::endl;
+        return;
+    }
+    auto rng = benchmark::make_rng();
+    std::uniform_int_distribution<size_t> jpp_gen(0, jp_container.nb_jpps() - 1);
+    std::uniform_int_distribution<DateTime> dt_gen(DateTimeUtils::set(1, 0), DateTimeUtils::set(2, 0));
+    std::vector<std::pair<JppIdx, DateTime>> lookups;
+    lookups.reserve(nb_lookups);
+    for (size_t i = 0; i < nb_lookups; ++i) {
+        lookups.push_back({JppIdx(jpp_gen(rng)), dt_gen(rng)});
+    }
+
+    const NextStopTime next_st(data);
+    run("earliest_stop_time", nb_lookups, [&](size_t i) {
+        const auto res = next_st.earliest_stop_time(StopEvent::pick_up, lookups[i].first, lookups[i].second,
+                                                    type::RTLevel::Base, type::VehicleProperties(), false);
+        return size_t(res.first != nullptr);
+    });
+}
+}
+
+int main(int argc, char** argv) {
+    namespace po = boost::program_options;
+    benchmark::CommandLine command_line("Options of the earliest trip lookup benchmark");
+    int nb_lookups;
+    command_line.add_options()
+            ("nb_lookups,n", po::value<int>(&nb_lookups)->default_value(1000000),
+                     "Number of lookups");
+    command_line.optional_file = true;
+    command_line.file_help = "Path to data.nav.lz4, the next stop time lookups are skipped if not given";
+    if (! command_line.parse(argc, argv)) {
+        return 1;
+    }
+
+    bench_kernels(nb_lookups);
+
+    if (! command_line.file.empty()) {
+        type::Data data;
+        benchmark::load_data(data, command_line.file);
+        bench_next_stop_time(data, nb_lookups);
+    }
+
+    return 0;
+}
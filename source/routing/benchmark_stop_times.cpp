@@ -0,0 +1,187 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "raptor.h"
+#include "raptor_visitors.h"
+#include "type/data.h"
+#include "tests/benchmark_utils.h"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <cstring>
+#include <iostream>
+
+/*
+ * Micro benchmark of the stop time scan of the raptor loop: for random
+ * vehicle journeys of random journey patterns, the stop times are read
+ * as the raptor loop does, from the type::StopTime and from the
+ * compact dataRAPTOR::StopTimeTable.
+ *
+ * The cache misses are read from the hardware counters (perf_event_open),
+ * they are only available on linux, and not on every host (virtual
+ * machines, perf_event_paranoid).
+ */
+
+using namespace navitia;
+using namespace routing;
+
+namespace {
+#ifdef __linux__
+struct CacheMissCounter {
+    int fd = -1;
+    CacheMissCounter() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    ~CacheMissCounter() { if (fd != -1) { close(fd); } }
+    bool available() const { return fd != -1; }
+    void start() {
+        if (fd == -1) { return; }
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    long long stop() {
+        if (fd == -1) { return -1; }
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) { return -1; }
+        return count;
+    }
+};
+#else
+struct CacheMissCounter {
+    bool available() const { return false; }
+    void start() {}
+    long long stop() { return -1; }
+};
+#endif
+
+struct Scan {
+    const type::StopTime* st;
+    DateTime base_dt;
+};
+
+// what the raptor loop reads on each stop time
+template<typename ST>
+inline DateTime scan_one(const ST& st, DateTime base_dt, DateTime best) {
+    if (st.valid_end(true) && st.local_traffic_zone != 42) {
+        return std::min(best, st.section_end(base_dt, true));
+    }
+    return best;
+}
+
+template<typename F>
+void run(const std::string& name, const std::vector<Scan>& scans, F scan_vj) {
+    CacheMissCounter counter;
+    DateTime res = DateTimeUtils::inf;
+    size_t nb_st = 0;
+    const auto begin = benchmark::Clock::now();
+    counter.start();
+    for (const auto& scan: scans) {
+        res = std::min(res, scan_vj(scan, nb_st));
+    }
+    const auto nb_misses = counter.stop();
+    const auto us = benchmark::elapsed_us(begin);
+
+    std::cout << name << ": " << us * 1000 / nb_st << " ns by stop time, ";
+    if (counter.available()) {
+        std::cout << double(nb_misses) / scans.size() << " cache misses by vj scan";
+    } else {
+        std::cout << "cache misses not available";
+    }
+    std::cout << " (" << res << ")" << std::endl;
+}
+}
+
+int main(int argc, char** argv) {
+    namespace po = boost::program_options;
+    benchmark::CommandLine command_line("Options of the stop time scan benchmark");
+    int nb_scans;
+    command_line.add_options()
+            ("nb_scans,n", po::value<int>(&nb_scans)->default_value(1000000),
+                     "Number of vehicle journey scans");
+    if (! command_line.parse(argc, argv)) {
+        return 1;
+    }
+
+    type::Data data;
+    benchmark::load_data(data, command_line.file);
+    const auto& jp_container = data.dataRaptor->jp_container;
+    if (jp_container.nb_jps() == 0) {
+        std::cout << "no journey pattern" << std::endl;
+        return 1;
+    }
+
+    // random boarding in random vjs, as the raptor loop does
+    auto rng = benchmark::make_rng();
+    std::uniform_int_distribution<size_t> jp_gen(0, jp_container.nb_jps() - 1);
+    std::vector<Scan> scans;
+    scans.reserve(nb_scans);
+    while (scans.size() < size_t(nb_scans)) {
+        const auto& jp = jp_container.get(JpIdx(jp_gen(rng)));
+        if (jp.discrete_vjs.empty()) { continue; }
+        const auto* vj = jp.discrete_vjs[rng() % jp.discrete_vjs.size()];
+        if (vj->stop_time_list.empty()) { continue; }
+        scans.push_back({&vj->stop_time_list.front(), DateTimeUtils::set(1, 0)});
+    }
+
+    run("StopTime", scans, [&](const Scan& scan, size_t& nb_st) {
+        DateTime best = DateTimeUtils::inf;
+        for (const auto& st: raptor_visitor().st_range(*scan.st)) {
+            best = scan_one(st, scan.base_dt, best);
+            ++nb_st;
+        }
+        return best;
+    });
+
+    const auto& table = data.dataRaptor->stop_time_table;
+    run("StopTimeTable", scans, [&](const Scan& scan, size_t& nb_st) {
+        DateTime best = DateTimeUtils::inf;
+        const auto nb = scan.st->vehicle_journey->stop_time_list.size();
+        const auto* it = raptor_visitor().compact_st(table, *scan.st);
+        for (size_t i = 0; i < nb; ++i, ++it) {
+            best = scan_one(*it, scan.base_dt, best);
+            ++nb_st;
+        }
+        return best;
+    });
+
+    return 0;
+}
@@ -31,9 +31,14 @@ www.navitia.io
 #include "dataraptor.h"
 #include "routing.h"
 #include "routing/raptor_utils.h"
+#include "utils/logger.h"
 
 #include <boost/range/algorithm_ext.hpp>
 
+#include <chrono>
+#include <functional>
+#include <future>
+
 namespace navitia { namespace routing {
 
 void dataRAPTOR::Connections::load(const type::PT_Data& data) {
@@ -61,6 +66,55 @@ void dataRAPTOR::JppsFromSp::load(const type::PT_Data& data,
     for (auto& jpps: jpps_from_sp.values()) { jpps.shrink_to_fit(); }
 }
 
+void dataRAPTOR::JppsFromSp::update(const JppsFromSp& prev,
+                                    const JourneyPatternContainer& jp_container,
+                                    const size_t nb_prev_jps) {
+    jpps_from_sp = prev.jpps_from_sp;
+    for (const auto& jp: jp_container.get_jps()) {
+        if (jp.first.val < nb_prev_jps) { continue; }
+        for (const auto& jpp_idx: jp.second.jpps) {
+            const auto& jpp = jp_container.get(jpp_idx);
+            jpps_from_sp[jpp.sp_idx].push_back({jpp_idx, jp.first, jpp.order});
+        }
+    }
+}
+
+void dataRAPTOR::StopTimeTable::add_vj(const type::VehicleJourney& vj) {
+    if (first_entry_by_vj[vj.idx] != std::numeric_limits<uint32_t>::max()) { return; }
+    first_entry_by_vj[vj.idx] = entries.size();
+    for (const auto& st: vj.stop_time_list) {
+        entries.push_back({st.boarding_time, st.alighting_time, st.local_traffic_zone,
+                           st.pick_up_allowed(), st.drop_off_allowed()});
+    }
+}
+
+void dataRAPTOR::StopTimeTable::load(const type::PT_Data& data,
+                                     const JourneyPatternContainer& jp_container) {
+    entries.clear();
+    entries.reserve(data.nb_stop_times());
+    first_entry_by_vj.assign(data.vehicle_journeys.size(), std::numeric_limits<uint32_t>::max());
+    // the vjs are stored by journey pattern, as they are scanned
+    for (const auto& jp: jp_container.get_jps()) {
+        jp.second.for_each_vehicle_journey([&](const type::VehicleJourney& vj) {
+            add_vj(vj);
+            return true;
+        });
+    }
+    // the vjs without journey pattern are only used by the extensions,
+    // but let's have all of them for consistency
+    for (const auto* vj: data.vehicle_journeys) { add_vj(*vj); }
+}
+
+void dataRAPTOR::StopTimeTable::update(const StopTimeTable& prev, const type::PT_Data& data) {
+    // the stop times of the existing vjs are not modified by the realtime
+    entries = prev.entries;
+    first_entry_by_vj = prev.first_entry_by_vj;
+    first_entry_by_vj.resize(data.vehicle_journeys.size(), std::numeric_limits<uint32_t>::max());
+    for (size_t idx = prev.first_entry_by_vj.size(); idx < data.vehicle_journeys.size(); ++idx) {
+        add_vj(*data.vehicle_journeys[idx]);
+    }
+}
+
 void dataRAPTOR::JppsFromSp::filter_jpps(const boost::dynamic_bitset<>& valid_jpps) {
     for (auto& jpps: jpps_from_sp.values()) {
         boost::remove_erase_if(jpps, [&](const Jpp& jpp) {
@@ -81,41 +135,164 @@ void dataRAPTOR::JppsFromJp::load(const JourneyPatternContainer& jp_container) {
     for (auto& jpps: jpps_from_jp.values()) { jpps.shrink_to_fit(); }
 }
 
+// jp_vp[date][jp_idx] = any(vj.validity_pattern->check2(date) for vj in jp)
+static void fill_jp_validity_patterns(std::vector<boost::dynamic_bitset<>>& jp_vp,
+                                      const type::RTLevel rt_level,
+                                      const JpIdx& jp_idx,
+                                      const JourneyPattern& jp) {
+    for (int i = 0; i <= 365; ++i) {
+        bool is_valid = false;
+        jp.for_each_vehicle_journey([&](const nt::VehicleJourney& vj) {
+            if (vj.validity_patterns[rt_level]->check2(i)) {
+                is_valid = true;
+                return false;
+            }
+            return true;
+        });
+        jp_vp[i][jp_idx.val] = is_valid;
+    }
+}
+
+static bool same_validity_patterns(const nt::VehicleJourney& vj1, const nt::VehicleJourney& vj2) {
+    for (const auto l: enum_range<type::RTLevel>()) {
+        const auto* vp1 = vj1.validity_patterns[l];
+        const auto* vp2 = vj2.validity_patterns[l];
+        if (vp1 == nullptr || vp2 == nullptr) {
+            if (vp1 != vp2) { return false; }
+            continue;
+        }
+        if (vp1->days != vp2->days) { return false; }
+    }
+    return true;
+}
+
+// Returns true if a vj of jp does not have the same validity patterns
+// as the corresponding one in prev_jp
+static bool validity_patterns_modified(const JourneyPattern& jp, const JourneyPattern& prev_jp) {
+    for (size_t i = 0; i < prev_jp.discrete_vjs.size(); ++i) {
+        if (! same_validity_patterns(*jp.discrete_vjs[i], *prev_jp.discrete_vjs[i])) { return true; }
+    }
+    for (size_t i = 0; i < prev_jp.freq_vjs.size(); ++i) {
+        if (! same_validity_patterns(*jp.freq_vjs[i], *prev_jp.freq_vjs[i])) { return true; }
+    }
+    return false;
+}
+
+using Stage = std::pair<std::string, std::function<void()>>;
+
+// Runs the stages concurrently, each in its own thread, and appends
+// their durations to durations.  The first exception raised by a
+// stage is rethrown once they are all finished.
+static void run_concurrently(const std::vector<Stage>& stages,
+                             std::vector<std::pair<std::string, uint64_t>>& durations) {
+    std::vector<std::future<uint64_t>> futures;
+    for (const auto& stage: stages) {
+        futures.push_back(std::async(std::launch::async, [&stage]() {
+            const auto begin = std::chrono::steady_clock::now();
+            stage.second();
+            return uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - begin).count());
+        }));
+    }
+    for (auto& future: futures) { future.wait(); }
+    auto logger = log4cplus::Logger::getInstance("log");
+    for (size_t i = 0; i < stages.size(); ++i) {
+        const auto duration = futures[i].get();
+        LOG4CPLUS_DEBUG(logger, "dataRAPTOR " << stages[i].first << " built in " << duration << "ms");
+        durations.emplace_back(stages[i].first, duration);
+    }
+}
 
 void dataRAPTOR::load(const type::PT_Data& data, size_t cache_size)
 {
-    jp_container.load(data);
+    load_durations.clear();
+
+    // the stages only depending on the PT_Data
+    run_concurrently({
+        {"jp_container", [&]() { jp_container.load(data); }},
+        {"labels", [&]() {
+            labels_const.init_inf(data.stop_points);
+            labels_const_reverse.init_min(data.stop_points);
+        }},
+        {"connections", [&]() {
+            connections.load(data);
+            min_connection_time = std::numeric_limits<uint32_t>::max();
+            for (const auto& conns : connections.forward_connections) {
+                for (const auto& conn : conns.second) {
+                    min_connection_time = std::min(min_connection_time, conn.duration);
+                }
+            }
+        }},
+    }, load_durations);
+
+    // the stages depending on the journey patterns, each one filling
+    // its own member
+    std::vector<Stage> stages = {
+        {"jpps_from_sp", [&]() { jpps_from_sp.load(data, jp_container); }},
+        {"jpps_from_jp", [&]() { jpps_from_jp.load(jp_container); }},
+        {"stop_time_table", [&]() { stop_time_table.load(data, jp_container); }},
+        {"next_stop_time_data", [&]() { next_stop_time_data.load(jp_container); }},
+    };
+    for (const auto rt_level: {type::RTLevel::Base, type::RTLevel::Adapted, type::RTLevel::RealTime}) {
+        stages.push_back({"jp_validity_patterns_" + type::get_string_from_rt_level(rt_level), [this, rt_level]() {
+            auto& jp_vp = jp_validity_patterns[rt_level];
+            jp_vp.assign(366, boost::dynamic_bitset<>(jp_container.nb_jps()));
+            for (const auto& jp: jp_container.get_jps()) {
+                fill_jp_validity_patterns(jp_vp, rt_level, jp.first, jp.second);
+            }
+        }});
+    }
+    run_concurrently(stages, load_durations);
+
+    cached_next_st_manager = std::make_unique<CachedNextStopTimeManager>(*this, cache_size);
+}
+
+void dataRAPTOR::update(const type::PT_Data& data, const dataRAPTOR& prev, size_t cache_size) {
+    auto logger = log4cplus::Logger::getInstance("log");
+    const auto& prev_jp_container = prev.jp_container;
+    if (data.vehicle_journeys.size() < prev_jp_container.get_jp_from_vj().size()
+        || data.routes.size() != prev_jp_container.get_jps_from_route().size()
+        || data.physical_modes.size() != prev_jp_container.get_jps_from_phy_mode().size()
+        || data.stop_points.size() != prev.connections.forward_connections.size()) {
+        LOG4CPLUS_WARN(logger, "dataRAPTOR can't be updated, loading it from scratch");
+        load(data, cache_size);
+        return;
+    }
+
+    const auto nb_prev_jps = prev_jp_container.nb_jps();
+    const auto jps_to_load = jp_container.update(data, prev_jp_container);
     labels_const.init_inf(data.stop_points);
     labels_const_reverse.init_min(data.stop_points);
 
-    connections.load(data);
-    jpps_from_sp.load(data, jp_container);
+    // the connections are not modified by the realtime
+    connections = prev.connections;
+    min_connection_time = prev.min_connection_time;
+    jpps_from_sp.update(prev.jpps_from_sp, jp_container, nb_prev_jps);
     jpps_from_jp.load(jp_container);
-    next_stop_time_data.load(jp_container);
+    stop_time_table.update(prev.stop_time_table, data);
+    next_stop_time_data.update(jp_container, prev.next_stop_time_data, data, jps_to_load);
 
+    // the jps with new vjs and the ones with vjs whose validity
+    // patterns have been modified must be recomputed
+    auto jps_to_check = jps_to_load;
+    for (const auto& jp: jp_container.get_jps()) {
+        if (jp.first.val >= nb_prev_jps || jps_to_check[jp.first.val]) { continue; }
+        if (validity_patterns_modified(jp.second, prev_jp_container.get(jp.first))) {
+            jps_to_check.set(jp.first.val);
+        }
+    }
     for (auto level_cont: jp_validity_patterns) {
         const auto rt_level = level_cont.first;
         auto& jp_vp = level_cont.second;
-        jp_vp.assign(366, boost::dynamic_bitset<>(jp_container.nb_jps()));
-        for (const auto& jp: jp_container.get_jps()) {
-            for (int i = 0; i <= 365; ++i) {
-                jp.second.for_each_vehicle_journey([&](const nt::VehicleJourney& vj) {
-                    if (vj.validity_patterns[rt_level]->check2(i)) {
-                        jp_vp[i].set(jp.first.val);
-                        return false;
-                    }
-                    return true;
-                });
-            }
+        jp_vp = prev.jp_validity_patterns[rt_level];
+        for (auto& bitset: jp_vp) { bitset.resize(jp_container.nb_jps()); }
+        for (auto idx = jps_to_check.find_first(); idx != jps_to_check.npos; idx = jps_to_check.find_next(idx)) {
+            fill_jp_validity_patterns(jp_vp, rt_level, JpIdx(idx), jp_container.get(JpIdx(idx)));
         }
     }
 
-    min_connection_time = std::numeric_limits<uint32_t>::max();
-    for (const auto& conns : connections.forward_connections) {
-        for (const auto& conn : conns.second) {
-            min_connection_time = std::min(min_connection_time, conn.duration);
-        }
-    }
+    LOG4CPLUS_DEBUG(logger, "dataRAPTOR updated: " << jps_to_load.count() << "/" << jp_container.nb_jps()
+                    << " jps reloaded, " << jps_to_check.count() << " jps validity patterns recomputed");
 
     cached_next_st_manager = std::make_unique<CachedNextStopTimeManager>(*this, cache_size);
 }
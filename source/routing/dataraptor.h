@@ -72,6 +72,8 @@ struct dataRAPTOR {
             return jpps_from_sp[sp];
         }
         void load(const type::PT_Data&, const JourneyPatternContainer&);
+        // copy prev, adding the jpps of the jps created since (of index >= nb_prev_jps)
+        void update(const JppsFromSp& prev, const JourneyPatternContainer&, size_t nb_prev_jps);
         void filter_jpps(const boost::dynamic_bitset<>& valid_jpps);
 
         inline IdxMap<type::StopPoint, std::vector<Jpp>>::const_iterator
@@ -100,6 +102,42 @@ struct dataRAPTOR {
     };
     JppsFromJp jpps_from_jp;
 
+    // Compact copy of the stop times, with only what is read by the
+    // raptor loop.  The stop times of a vj are contiguous, and the vjs
+    // of a journey pattern are contiguous, thus scanning a vj only
+    // reads a few cache lines.  The full StopTime is only needed to
+    // board and to build the response.
+    struct StopTimeTable {
+        struct Entry {
+            uint32_t boarding_time;
+            uint32_t alighting_time;
+            uint16_t local_traffic_zone;
+            bool pick_up_allowed;
+            bool drop_off_allowed;
+
+            inline bool valid_end(bool clockwise) const {
+                return clockwise ? drop_off_allowed : pick_up_allowed;
+            }
+            inline DateTime section_end(DateTime base_dt, bool clockwise) const {
+                return base_dt + (clockwise ? alighting_time : boarding_time);
+            }
+        };
+        // the entry corresponding to the given stop time
+        inline const Entry* get(const type::StopTime& st) const {
+            return &entries[first_entry_by_vj[st.vehicle_journey->idx] + st.order()];
+        }
+        void load(const type::PT_Data&, const JourneyPatternContainer&);
+        // copy prev, adding the stop times of the vjs created since
+        void update(const StopTimeTable& prev, const type::PT_Data&);
+    private:
+        void add_vj(const type::VehicleJourney&);
+
+        std::vector<Entry> entries;
+        // index in entries of the first stop time of a vj, by vj idx
+        std::vector<uint32_t> first_entry_by_vj;
+    };
+    StopTimeTable stop_time_table;
+
     NextStopTimeData next_stop_time_data;
     std::unique_ptr<CachedNextStopTimeManager> cached_next_st_manager;
 
@@ -112,8 +150,18 @@ struct dataRAPTOR {
     // jp_validity_patterns[date][jp_idx] == any(vj.validity_pattern->check2(date) for vj in jp)
     flat_enum_map<type::RTLevel, std::vector<boost::dynamic_bitset<>>> jp_validity_patterns;
 
+    // duration in milliseconds of each stage of the last load
+    std::vector<std::pair<std::string, uint64_t>> load_durations;
+
     dataRAPTOR() {}
     void load(const navitia::type::PT_Data&, size_t cache_size = 10);
+
+    // Load the data from the dataRAPTOR of the previous version of
+    // the data, only recomputing what has been modified by the
+    // realtime (see JourneyPatternContainer::update for the
+    // requirements on the PT_Data).  Fall back to load if the
+    // PT_Data is not compatible.
+    void update(const navitia::type::PT_Data&, const dataRAPTOR& prev, size_t cache_size = 10);
 };
 
 }}
@@ -34,6 +34,7 @@ www.navitia.io
 #include "isochrone.h"
 #include "raptor_api.h"
 
+#include <atomic>
 #include <vector>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 
@@ -137,59 +138,57 @@ static Boundary find_boundary(const std::pair <int, int>& rank_source,
     return Boundary(end_lon_box, end_lat_box, begin_lon_box, begin_lat_box);
 }
 
-static std::vector<std::vector<Projection>> find_projection(BoundBox box,
-                                                      const double height_step,
-                                                       const double width_step,
-                                                       const georef::GeoRef& worker,
-                                                       const double min_dist,
-                                                       const HeatMap& heat_map,
-                                                       const size_t step) {
-    std::vector<std::vector<Projection>> dist_pixel = {step,{step, Projection()}};
+namespace {
+/// A street network edge, with the cells it can be projected on
+struct EdgeCells {
+    georef::vertex_t source;
+    georef::vertex_t target;
+    Boundary boundary;
+    EdgeCells(georef::vertex_t source,
+              georef::vertex_t target,
+              const Boundary& boundary): source(source), target(target), boundary(boundary) {}
+};
+}
+
+/*
+ * The grid is cut in bands of band_size lon ranks. The edges of the box are
+ * read once from the proximity list, and each edge is given to every band
+ * its cells intersect, in the order of the scan. The bands thus find the
+ * same nearest edges as a scan of the whole grid would.
+ */
+static std::vector<std::vector<EdgeCells>> find_edges_by_band(const BoundBox& box,
+                                                              const double height_step,
+                                                              const double width_step,
+                                                              const georef::GeoRef& worker,
+                                                              const double min_dist,
+                                                              const size_t step,
+                                                              const size_t band_size) {
+    std::vector<std::vector<EdgeCells>> edges_by_band((step + band_size - 1) / band_size);
     const size_t offset_lon = floor(min_dist / (width_step * N_DEG_TO_DISTANCE)) + 1;
     const size_t offset_lat = floor(min_dist / (height_step * N_DEG_TO_DISTANCE)) + 1;
-    auto begin = std::lower_bound(worker.pl.items.begin(), worker.pl.items.end(), box.min.lon(),
-                                  [](const proximitylist::ProximityList<georef::vertex_t>::Item & i, double min){
-        return i.coord.lon() < min;
-    });
-
-    if (begin == worker.pl.items.end()) { return dist_pixel; }
-
-    auto end = std::upper_bound(begin, worker.pl.items.end(), box.max.lon(),
-                                [](double max, const proximitylist::ProximityList<georef::vertex_t>::Item & i){
-        return max <= i.coord.lon();
-    });
-
-    const auto coslat = cos(begin->coord.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
-    for(auto it = begin; it != end; ++it) {
-        const auto& source = it->coord;
-        if (!box.contains(source)) {continue;}
+    worker.pl->for_each_in_box(box.min, box.max,
+                              [&](const proximitylist::ProximityList<georef::vertex_t>::Item& item) {
+        const auto& source = item.coord;
+        if (!box.contains(source)) {return;}
         const auto rank_source = find_rank(box, source, height_step, width_step);
-        BOOST_FOREACH (georef::edge_t e, boost::out_edges(it->element, worker.graph)) {
-            const auto v = target(e, worker.graph);
-            const auto& target = worker.graph[v].coord;
-            const auto rank_target = find_rank(box, target, height_step, width_step);
+        BOOST_FOREACH (georef::edge_t e, boost::out_edges(item.element, *worker.graph)) {
+            const auto v = target(e, *worker.graph);
+            const auto rank_target = find_rank(box, (*worker.graph)[v].coord, height_step, width_step);
             const auto boundary = find_boundary(rank_source, rank_target, offset_lon, offset_lat, step);
-            for (uint lon_rank = boundary.min_lon; lon_rank <= boundary.max_lon; lon_rank++) {
-                for (uint lat_rank = boundary.min_lat; lat_rank <= boundary.max_lat; lat_rank++) {
-                    auto center = type::GeographicalCoord(heat_map.body[lon_rank].first.min_coord + width_step/2,
-                                                          heat_map.header[lat_rank].min_coord + height_step / 2);
-                    auto proj = center.approx_project(source, target, coslat);
-                    if (proj.second < min_dist &&
-                        (!dist_pixel[lon_rank][lat_rank].distance ||
-                         proj.second < *dist_pixel[lon_rank][lat_rank].distance))
-                    {
-                        dist_pixel[lon_rank][lat_rank].distance = proj.second;
-                        dist_pixel[lon_rank][lat_rank].source = it->element;
-                        dist_pixel[lon_rank][lat_rank].target = v;
-                    }
-                }
+            for (size_t band = boundary.min_lon / band_size; band <= boundary.max_lon / band_size; ++band) {
+                edges_by_band[band].emplace_back(item.element, v, boundary);
             }
         }
-    }
-    return dist_pixel;
+    });
+    return edges_by_band;
 }
 
-HeatMap fill_heat_map(const BoundBox& box,
+/// Fill the durations of the lon ranks [lon_begin, lon_end) from the edges of their band
+static void fill_band(HeatMap& heat_map,
+                      const std::vector<EdgeCells>& edges,
+                      const size_t lon_begin,
+                      const size_t lon_end,
+                      const BoundBox& box,
                       const double height_step,
                       const double width_step,
                       const georef::GeoRef& worker,
@@ -198,20 +197,43 @@ HeatMap fill_heat_map(const BoundBox& box,
                       const double speed,
                       const std::vector<navitia::time_duration>& distances,
                       const size_t step) {
-    auto heat_map = HeatMap(step, box, height_step, width_step);
-    auto projection = find_projection(box, height_step, width_step, worker, min_dist, heat_map, step);
-    for (size_t i = 0; i < step; i++){
+    std::vector<std::vector<Projection>> dist_pixel(lon_end - lon_begin, std::vector<Projection>(step));
+    const auto coslat = cos((box.min.lat() + box.max.lat()) / 2 * type::GeographicalCoord::N_DEG_TO_RAD);
+    for (const auto& edge: edges) {
+        const auto& source = (*worker.graph)[edge.source].coord;
+        const auto& target = (*worker.graph)[edge.target].coord;
+        const auto min_lon = std::max(edge.boundary.min_lon, lon_begin);
+        const auto max_lon = std::min(edge.boundary.max_lon, lon_end - 1);
+        for (size_t lon_rank = min_lon; lon_rank <= max_lon; lon_rank++) {
+            auto& pixels = dist_pixel[lon_rank - lon_begin];
+            for (size_t lat_rank = edge.boundary.min_lat; lat_rank <= edge.boundary.max_lat; lat_rank++) {
+                auto center = type::GeographicalCoord(heat_map.body[lon_rank].first.min_coord + width_step/2,
+                                                      heat_map.header[lat_rank].min_coord + height_step / 2);
+                auto proj = center.approx_project(source, target, coslat);
+                if (proj.second < min_dist &&
+                    (!pixels[lat_rank].distance || proj.second < *pixels[lat_rank].distance))
+                {
+                    pixels[lat_rank].distance = proj.second;
+                    pixels[lat_rank].source = edge.source;
+                    pixels[lat_rank].target = edge.target;
+                }
+            }
+        }
+    }
+
+    for (size_t i = lon_begin; i < lon_end; i++){
         for (size_t j = 0; j < step; j++){
             auto& duration = heat_map.body[i].second[j];
-            if (projection[i][j].distance) {
+            const auto& projection = dist_pixel[i - lon_begin][j];
+            if (projection.distance) {
                 auto center = type::GeographicalCoord(heat_map.body[i].first.min_coord + width_step/2,
                                                       heat_map.header[j].min_coord + height_step / 2);
-                const auto source = worker.graph[projection[i][j].source].coord;
-                const auto target = worker.graph[projection[i][j].target].coord;
+                const auto source = (*worker.graph)[projection.source].coord;
+                const auto target = (*worker.graph)[projection.target].coord;
                 const auto coslat = cos(center.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
-                const auto duration_to_source = distances[projection[i][j].source] +
+                const auto duration_to_source = distances[projection.source] +
                         navitia::milliseconds(sqrt(center.approx_sqr_distance(source, coslat)) / speed * 1e3);
-                const auto duration_to_target = distances[projection[i][j].target] +
+                const auto duration_to_target = distances[projection.target] +
                         navitia::milliseconds(sqrt(center.approx_sqr_distance(target, coslat)) / speed * 1e3);
                 const auto new_duration = std::min(duration_to_source, duration_to_target);
                 if (new_duration.total_seconds() < max_duration) {
@@ -224,6 +246,35 @@ HeatMap fill_heat_map(const BoundBox& box,
             }
         }
     }
+}
+
+HeatMap fill_heat_map(const BoundBox& box,
+                      const double height_step,
+                      const double width_step,
+                      const georef::GeoRef& worker,
+                      const double min_dist,
+                      const double max_duration,
+                      const double speed,
+                      const std::vector<navitia::time_duration>& distances,
+                      const size_t step,
+                      ThreadPool& pool,
+                      const size_t nb_threads) {
+    auto heat_map = HeatMap(step, box, height_step, width_step);
+    if (step == 0) { return heat_map; }
+    // several bands by thread, as the street network is denser in some parts of the grid
+    const size_t nb_workers = std::max(std::min({nb_threads, pool.nb_threads(), step}), size_t(1));
+    const size_t band_size = std::max(step / (4 * nb_workers), size_t(1));
+    const auto edges_by_band = find_edges_by_band(box, height_step, width_step, worker, min_dist, step, band_size);
+
+    std::atomic<size_t> next_band{0};
+    const auto fill_bands = [&]() {
+        for (size_t band = next_band++; band < edges_by_band.size(); band = next_band++) {
+            const auto lon_begin = band * band_size;
+            fill_band(heat_map, edges_by_band[band], lon_begin, std::min(lon_begin + band_size, step),
+                      box, height_step, width_step, worker, min_dist, max_duration, speed, distances, step);
+        }
+    };
+    pool.run(nb_workers, [&](size_t) { fill_bands(); });
     return heat_map;
 }
 
@@ -232,13 +283,15 @@ static std::string build_grid(const georef::GeoRef& worker,
                               const std::vector<navitia::time_duration>& distances,
                               const double speed,
                               const double max_duration,
-                              const uint resolution) {
+                              const uint resolution,
+                              ThreadPool& pool,
+                              const size_t nb_threads) {
     double width_step = (box.max.lon() - box.min.lon()) / resolution;
     double height_step = (box.max.lat() - box.min.lat()) / resolution;
     auto min_dist = std::max(500., width_step * N_DEG_TO_DISTANCE);
     min_dist = std::max(min_dist, height_step * N_DEG_TO_DISTANCE);
     auto heat_map = fill_heat_map(box, height_step, width_step, worker, min_dist, max_duration,
-                                  speed, distances, resolution);
+                                  speed, distances, resolution, pool, nb_threads);
     return print_grid(heat_map);
 }
 
@@ -259,10 +312,10 @@ init_distance(const georef::GeoRef & worker,
               const DateTime& bound,
               const double speed) {
     std::vector<navitia::time_duration> distances;
-    size_t n = boost::num_vertices(worker.graph);
+    size_t n = boost::num_vertices(*worker.graph);
     distances.assign(n, bt::pos_infin);
     nt::idx_t offset = worker.offsets[mode];
-    auto proj = georef::ProjectionData(coord_origin, worker, offset, worker.pl);
+    auto proj = georef::ProjectionData(coord_origin, worker, offset, *worker.pl);
     if (proj.found) {
         distances[proj[source_e]] = std::min(
             distances[proj[source_e]],
@@ -275,7 +328,7 @@ init_distance(const georef::GeoRef & worker,
         SpIdx sp_idx(*sp);
         const auto& best_lbl = raptor.best_labels_pts[sp_idx];
         if (in_bound(best_lbl, bound, clockwise)) {
-            const auto& projections = worker.projected_stop_points[sp->idx];
+            const auto& projections = (*worker.projected_stop_points)[sp->idx];
             const auto& proj = projections[mode];
             if(proj.found) {
                 const double duration = clockwise ? best_lbl - init_dt : init_dt - best_lbl;
@@ -300,7 +353,7 @@ static std::vector<georef::vertex_t> init_vertex(const georef::GeoRef & worker,
                                                  const DateTime& bound) {
     std::vector<georef::vertex_t> initialized_points;
     nt::idx_t offset = worker.offsets[mode];
-    auto proj = georef::ProjectionData(coord_origin, worker, offset, worker.pl);
+    auto proj = georef::ProjectionData(coord_origin, worker, offset, *worker.pl);
     if (proj.found) {
         initialized_points.push_back(proj[source_e]);
         initialized_points.push_back(proj[target_e]);
@@ -309,7 +362,7 @@ static std::vector<georef::vertex_t> init_vertex(const georef::GeoRef & worker,
         SpIdx sp_idx(*sp);
         const auto& best_lbl = raptor.best_labels_pts[sp_idx];
         if (in_bound(best_lbl, bound, clockwise)) {
-            const auto& projections = worker.projected_stop_points[sp->idx];
+            const auto& projections = (*worker.projected_stop_points)[sp->idx];
             const auto& proj = projections[mode];
             if(proj.found) {
                 initialized_points.push_back(proj[source_e]);
@@ -333,7 +386,7 @@ static BoundBox find_boundary_box(const georef::GeoRef & worker,
     auto box = BoundBox();
     const auto distance_500m = (500 / type::GeographicalCoord::EARTH_RADIUS_IN_METERS) * N_RAD_TO_DEG;
     nt::idx_t offset = worker.offsets[mode];
-    auto proj = georef::ProjectionData(coord_origin, worker, offset, worker.pl);
+    auto proj = georef::ProjectionData(coord_origin, worker, offset, *worker.pl);
     if (proj.found) {
         box.set_box(coord_origin, walking_distance(max_duration, 0, speed) + distance_500m);
     }
@@ -341,7 +394,7 @@ static BoundBox find_boundary_box(const georef::GeoRef & worker,
         SpIdx sp_idx(*sp);
         const auto& best_lbl = raptor.best_labels_pts[sp_idx];
         if (in_bound(best_lbl, bound, clockwise)) {
-            const auto& projections = worker.projected_stop_points[sp->idx];
+            const auto& projections = (*worker.projected_stop_points)[sp->idx];
             const auto& proj = projections[mode];
             if(proj.found) {
                 const double duration = clockwise ? best_lbl - init_dt : init_dt - best_lbl;
@@ -362,10 +415,12 @@ std::string build_raster_isochrone(const georef::GeoRef& worker,
                                    const DateTime duration,
                                    const bool clockwise,
                                    const DateTime bound,
-                                   const uint resolution) {
+                                   const uint resolution,
+                                   ThreadPool& pool,
+                                   const size_t nb_threads) {
     const auto& stop_points = raptor.data.pt_data->stop_points;
     std::vector<georef::vertex_t> predecessors;
-    size_t n = boost::num_vertices(worker.graph);
+    size_t n = boost::num_vertices(*worker.graph);
     predecessors.resize(n);
     auto box = find_boundary_box(worker, stop_points, init_dt, raptor, mode, coord_origin,
                                  clockwise, bound, duration, speed);
@@ -380,17 +435,17 @@ std::string build_raster_isochrone(const georef::GeoRef& worker,
     auto index_map = boost::identity_property_map();
     using filtered_graph = boost::filtered_graph<georef::Graph, boost::keep_all, georef::TransportationModeFilter>;
     try {
-        boost::dijkstra_shortest_paths_no_init(filtered_graph(worker.graph, {},
+        boost::dijkstra_shortest_paths_no_init(filtered_graph(*worker.graph, {},
                                                               georef::TransportationModeFilter(mode, worker)),
                                                start, end, &predecessors[0], &distances[0],
-                                               boost::get(&georef::Edge::duration, worker.graph),
+                                               boost::get(&georef::Edge::duration, *worker.graph),
                                                index_map,
                                                std::less<navitia::time_duration>(),
                                                georef::SpeedDistanceCombiner(speed_factor),
                                                navitia::seconds(0),
                                                visitor);
     } catch (georef::DestinationFound) {}
-    return build_grid(worker, box, distances, speed, duration, resolution);
+    return build_grid(worker, box, distances, speed, duration, resolution, pool, nb_threads);
 }
 
 }} //namespace navitia::routing
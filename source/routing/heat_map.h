@@ -32,6 +32,7 @@ www.navitia.io
 
 #include "isochrone.h"
 #include "raptor.h"
+#include "type/thread_pool.h"
 
 namespace navitia { namespace routing {
 
@@ -67,7 +68,7 @@ struct BoundBox {
         this->min = type::GeographicalCoord(lon_min, lat_min);
     }
 
-    bool contains(const type::GeographicalCoord& coord) {
+    bool contains(const type::GeographicalCoord& coord) const {
         return this->max.lon() >= coord.lon() && this->max.lat() >= coord.lat() &&
                this->min.lon() <= coord.lon() && this->min.lat() <= coord.lat();
     }
@@ -118,7 +119,9 @@ HeatMap fill_heat_map(const BoundBox& box,
                       const double max_duration,
                       const double speed,
                       const std::vector<navitia::time_duration>& distances,
-                      const size_t step);
+                      const size_t step,
+                      ThreadPool& pool,
+                      const size_t nb_threads);
 
 std::string print_grid(const HeatMap& heat_map);
 
@@ -131,6 +134,8 @@ std::string build_raster_isochrone(const georef::GeoRef& worker,
                                    const DateTime duration,
                                    const bool clockwise,
                                    const DateTime bound,
-                                   const uint resolution);
+                                   const uint resolution,
+                                   ThreadPool& pool,
+                                   const size_t nb_threads);
 
 }} //namespace navitia::routing
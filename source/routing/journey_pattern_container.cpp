@@ -65,6 +65,50 @@ void JourneyPatternContainer::load(const nt::PT_Data& pt_data) {
     }
 }
 
+// Returns the vj of pt_data corresponding to the vj of the previous version of the data
+template<typename VJ>
+static const VJ* get_updated_vj(const nt::PT_Data& pt_data, const VJ* prev_vj) {
+    return static_cast<const VJ*>(pt_data.vehicle_journeys.at(prev_vj->idx));
+}
+
+boost::dynamic_bitset<>
+JourneyPatternContainer::update(const nt::PT_Data& pt_data, const JourneyPatternContainer& prev) {
+    map = prev.map;
+    jps = prev.jps;
+    jpps = prev.jpps;
+    jps_from_route = prev.jps_from_route;
+    jps_from_phy_mode = prev.jps_from_phy_mode;
+    jp_from_vj.assign(pt_data.vehicle_journeys);
+    for (const auto& vj_jp: prev.jp_from_vj) {
+        jp_from_vj[vj_jp.first] = vj_jp.second;
+    }
+
+    // the vjs of the previous data are replaced by the ones of pt_data
+    for (auto& jp: jps) {
+        for (auto& vj: jp.discrete_vjs) { vj = get_updated_vj(pt_data, vj); }
+        for (auto& vj: jp.freq_vjs) { vj = get_updated_vj(pt_data, vj); }
+    }
+
+    // the vjs created since then are added, as in load
+    std::vector<JpIdx> touched_jps;
+    for (size_t idx = prev.jp_from_vj.size(); idx < pt_data.vehicle_journeys.size(); ++idx) {
+        const auto* vj = pt_data.vehicle_journeys[idx];
+        if (! vj->route) { continue; }
+        if (const auto* discrete_vj = dynamic_cast<const nt::DiscreteVehicleJourney*>(vj)) {
+            add_vj(*discrete_vj);
+        } else if (const auto* freq_vj = dynamic_cast<const nt::FrequencyVehicleJourney*>(vj)) {
+            add_vj(*freq_vj);
+        } else {
+            continue;
+        }
+        touched_jps.push_back(jp_from_vj[VjIdx(*vj)]);
+    }
+
+    boost::dynamic_bitset<> res(jps.size());
+    for (const auto& jp_idx: touched_jps) { res.set(jp_idx.val); }
+    return res;
+}
+
 const JppIdx& JourneyPatternContainer::get_jpp(const type::StopTime& st) const {
     const auto& jp = get(jp_from_vj[VjIdx(*st.vehicle_journey)]);
     return jp.jpps.at(st.order());
@@ -32,6 +32,7 @@ www.navitia.io
 
 #include "raptor_utils.h"
 #include <boost/optional.hpp>
+#include <boost/dynamic_bitset.hpp>
 
 namespace navitia { namespace type {
 
@@ -88,6 +89,15 @@ struct JourneyPatternContainer {
     using JppRange = boost::iterator_range<JppIterator>;
 
     void load(const navitia::type::PT_Data&);
+
+    // Load the container from the one of the previous version of the
+    // data.  The given PT_Data must be a realtime update of the
+    // previous one: the vjs are only added (with indexes following
+    // the existing ones), and the existing vjs keep their stop times.
+    //
+    // Returns the jps that have been created or that have new vjs.
+    boost::dynamic_bitset<> update(const navitia::type::PT_Data&, const JourneyPatternContainer& prev);
+
     size_t nb_jps() const { return jps.size(); }
     size_t nb_jpps() const { return jpps.size(); }
     const JourneyPattern& get(const JpIdx& idx) const {
@@ -35,10 +35,14 @@ www.navitia.io
 #include "type/pt_data.h"
 #include "type/meta_data.h"
 #include "type/type_utils.h"
+#include "type/thread_pool.h"
 
 #include <boost/range/algorithm/sort.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
 
+#include <algorithm>
+#include <chrono>
+
 namespace navitia { namespace routing {
 
 DateTime NextStopTimeData::Departure::get_time(const type::StopTime& st) const {
@@ -87,6 +91,40 @@ void NextStopTimeData::TimesStopTimes<Getter>::init(const JourneyPattern& jp,
     }
 }
 
+template<typename Getter>
+void NextStopTimeData::TimesStopTimes<Getter>::update(const TimesStopTimes& prev,
+                                                      const type::PT_Data& pt_data) {
+    // the order is the same, only the stop times have moved
+    times = prev.times;
+    stop_times.reserve(prev.stop_times.size());
+    for (const auto* st: prev.stop_times) {
+        const auto* vj = pt_data.vehicle_journeys[st->vehicle_journey->idx];
+        stop_times.push_back(&vj->stop_time_list[st->order()]);
+    }
+}
+
+void NextStopTimeData::update(const JourneyPatternContainer& jp_container,
+                              const NextStopTimeData& prev,
+                              const type::PT_Data& pt_data,
+                              const boost::dynamic_bitset<>& jps_to_load) {
+    departure.assign(jp_container.get_jpps_values());
+    arrival.assign(jp_container.get_jpps_values());
+
+    for (const auto& jp: jp_container.get_jps()) {
+        const bool to_load = jps_to_load[jp.first.val];
+        for (const auto& jpp_idx: jp.second.jpps) {
+            if (to_load) {
+                const auto& jpp = jp_container.get(jpp_idx);
+                departure[jpp_idx].init(jp.second, jpp);
+                arrival[jpp_idx].init(jp.second, jpp);
+            } else {
+                departure[jpp_idx].update(prev.departure[jpp_idx], pt_data);
+                arrival[jpp_idx].update(prev.arrival[jpp_idx], pt_data);
+            }
+        }
+    }
+}
+
 void NextStopTimeData::load(const JourneyPatternContainer& jp_container) {
     departure.assign(jp_container.get_jpps_values());
     arrival.assign(jp_container.get_jpps_values());
@@ -430,6 +468,7 @@ bool CachedNextStopTimeKey::operator<(const CachedNextStopTimeKey& other) const
 }
 
 CachedNextStopTime CachedNextStopTimeManager::CacheCreator::operator()(const CachedNextStopTimeKey& key) const {
+    const auto begin = std::chrono::steady_clock::now();
     CachedNextStopTime::vDtStByJpp departure, arrival;
     const auto& jp_container = dataRaptor.jp_container;
 
@@ -453,7 +492,10 @@ CachedNextStopTime CachedNextStopTimeManager::CacheCreator::operator()(const Cac
     for (const auto& jpp_dtst : departure) {
         boost::sort(jpp_dtst.second, compare);
     }
-    return {departure, arrival};
+    CachedNextStopTime res(departure, arrival);
+    build_duration_us += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - begin).count();
+    return res;
 }
 
 CachedNextStopTime::DtStFromJpp::DtStFromJpp(const vDtStByJpp& map) {
@@ -502,7 +544,20 @@ CachedNextStopTime::next_stop_time(const StopEvent stop_event,
 
 CachedNextStopTimeManager::~CachedNextStopTimeManager() {
     auto logger = log4cplus::Logger::getInstance("log");
-    LOG4CPLUS_INFO(logger, "Cache miss : " << lru.get_nb_cache_miss() << " / " << lru.get_nb_calls());
+    LOG4CPLUS_INFO(logger, "Cache miss : " << lru.get_nb_cache_miss() << " / " << lru.get_nb_calls()
+                   << ", build time: " << build_duration_us.load() / 1000 << "ms");
+}
+
+void CachedNextStopTimeManager::warmup(std::vector<CachedNextStopTimeKey> keys, const size_t nb_threads) {
+    if (keys.size() > max_cache) {
+        keys.resize(max_cache, keys.front());
+    }
+    ThreadPool pool(std::min(nb_threads, keys.size()));
+    pool.run(keys.size(), [&](size_t i) { lru(keys[i]); });
+}
+
+CachedNextStopTimeManager::Stats CachedNextStopTimeManager::get_stats() const {
+    return {lru.get_nb_calls(), lru.get_nb_cache_miss(), build_duration_us.load() / 1000};
 }
 
 std::shared_ptr<const CachedNextStopTime>
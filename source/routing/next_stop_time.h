@@ -32,6 +32,7 @@ www.navitia.io
 
 #include "routing/stop_event.h"
 #include "routing/raptor_utils.h"
+#include "routing/simd_lower_bound.h"
 #include "utils/idx_map.h"
 #include "utils/lru.h"
 #include "type/rt_level.h"
@@ -42,6 +43,8 @@ www.navitia.io
 #include <boost/optional.hpp>
 #include <boost/dynamic_bitset.hpp>
 
+#include <atomic>
+
 namespace navitia {
 
 namespace type {
@@ -63,6 +66,14 @@ struct NextStopTimeData {
 
     void load(const JourneyPatternContainer&);
 
+    // Same as load, but only the jpps of jps_to_load are loaded, the
+    // others are taken from prev, the NextStopTimeData of the
+    // previous version of the data (see JourneyPatternContainer::update)
+    void update(const JourneyPatternContainer&,
+                const NextStopTimeData& prev,
+                const type::PT_Data&,
+                const boost::dynamic_bitset<>& jps_to_load);
+
     // Returns the range of the stop times in increasing time order
     inline StopTimeIter stop_time_range_forward(const JppIdx jpp_idx,
                                                 const StopEvent stop_event) const {
@@ -127,17 +138,17 @@ private:
         }
         // Returns the range of stop times next to hour(dt)
         inline StopTimeIter next_stop_time_range(const DateTime dt) const {
-            const auto it = boost::lower_bound(times, DateTimeUtils::hour(dt));
-            const auto idx = it - times.begin();
+            const auto idx = simd_lower_bound(times.data(), times.size(), DateTimeUtils::hour(dt));
             return boost::make_iterator_range(stop_times.begin() + idx, stop_times.end());
         }
         // Returns the range of stop times previous to hour(dt)
         inline StopTimeReverseIter prev_stop_time_range(const DateTime dt) const {
-            const auto it = boost::upper_bound(times, DateTimeUtils::hour(dt));
-            const auto idx = it - times.begin();
+            const auto idx = simd_upper_bound(times.data(), times.size(), DateTimeUtils::hour(dt));
             return boost::make_iterator_range(stop_times.rend() - idx, stop_times.rend());
         }
         void init(const JourneyPattern& jp, const JourneyPatternPoint& jpp);
+        // copy prev, pointing to the stop times of pt_data
+        void update(const TimesStopTimes& prev, const type::PT_Data& pt_data);
     };
     IdxMap<JourneyPatternPoint, TimesStopTimes<Departure>> departure;
     IdxMap<JourneyPatternPoint, TimesStopTimes<Arrival>> arrival;
@@ -267,9 +278,15 @@ private:
 };
 
 struct CachedNextStopTimeManager {
+    struct Stats {
+        size_t nb_calls;
+        size_t nb_cache_miss;
+        // cumulated time spent building the caches, warmup included
+        uint64_t build_duration_ms;
+    };
+
     explicit CachedNextStopTimeManager(const dataRAPTOR& dataRaptor, size_t max_cache) :
-            lru({dataRaptor}, max_cache) {}
-    CachedNextStopTimeManager& operator=(CachedNextStopTimeManager&&) = default;
+            max_cache(max_cache), lru({dataRaptor, build_duration_us}, max_cache) {}
     ~CachedNextStopTimeManager();
 
     std::shared_ptr<const CachedNextStopTime>
@@ -277,15 +294,25 @@ struct CachedNextStopTimeManager {
          const type::RTLevel rt_level,
          const type::AccessibiliteParams& accessibilite_params);
 
+    // Builds the caches of the given keys concurrently, on at most
+    // nb_threads threads. The keys after the max_cache first ones are
+    // ignored as they would evict the first ones.
+    void warmup(std::vector<CachedNextStopTimeKey> keys, const size_t nb_threads);
+
+    Stats get_stats() const;
+
 private:
     struct CacheCreator {
         typedef CachedNextStopTimeKey const& argument_type;
         typedef CachedNextStopTime result_type;
         const dataRAPTOR& dataRaptor;
-        CacheCreator(const dataRAPTOR& d): dataRaptor(d) {}
+        std::atomic<uint64_t>& build_duration_us;
+        CacheCreator(const dataRAPTOR& d, std::atomic<uint64_t>& b): dataRaptor(d), build_duration_us(b) {}
         CachedNextStopTime operator()(const CachedNextStopTimeKey& key) const;
     };
 
+    size_t max_cache;
+    std::atomic<uint64_t> build_duration_us{0};
     ConcurrentLru<CacheCreator> lru;
 };
 
@@ -35,6 +35,7 @@ www.navitia.io
 #include <boost/range/adaptor/filtered.hpp>
 #include <boost/range/algorithm/find_if.hpp>
 #include <boost/range/algorithm/fill.hpp>
+#include <boost/range/algorithm/sort.hpp>
 #include <chrono>
 
 namespace bt = boost::posix_time;
@@ -91,6 +92,7 @@ bool RAPTOR::apply_vj_extension(const Visitor& v,
 
             working_labels.mut_dt_pt(sp_idx) = workingDt;
             best_labels_pts[sp_idx] = workingDt;
+            marked_sps_pt.set(sp_idx.val);
             result = true;
         }
         vj = v.get_extension_vj(vj);
@@ -107,15 +109,12 @@ bool RAPTOR::foot_path(const Visitor& v) {
                 data.dataRaptor->connections.forward_connections :
                 data.dataRaptor->connections.backward_connections;
 
-    for (const auto sp_cnx: cnx_list) {
-        // for all stop point, we check if we can improve the stop points they are in connection with
-        const auto& sp_idx = sp_cnx.first;
-
-        if (! working_labels.pt_is_initialized(sp_idx)) { continue; }
-
+    // only the stop points reached in this round can improve their connections
+    for (auto sp = marked_sps_pt.find_first(); sp != marked_sps_pt.npos; sp = marked_sps_pt.find_next(sp)) {
+        const SpIdx sp_idx = SpIdx(sp);
         const DateTime previous = working_labels.dt_pt(sp_idx);
 
-        for (const auto& conn: sp_cnx.second) {
+        for (const auto& conn: cnx_list[sp_idx]) {
             const SpIdx destination_sp_idx = conn.sp_idx;
             const DateTime next = v.combine(previous, conn.duration);
 
@@ -124,20 +123,23 @@ bool RAPTOR::foot_path(const Visitor& v) {
             //if we can improve the best label, we mark it
             working_labels.mut_dt_transfer(destination_sp_idx) = next;
             best_labels_transfers[destination_sp_idx] = next;
+            marked_sps_transfer.set(destination_sp_idx.val);
             result = true;
         }
     }
+    marked_sps_pt.reset();
 
-    for (const auto sp_jpps: jpps_from_sp) {
-        if (! working_labels.transfer_is_initialized(sp_jpps.first)) { continue; }
-
+    for (auto sp = marked_sps_transfer.find_first(); sp != marked_sps_transfer.npos;
+         sp = marked_sps_transfer.find_next(sp)) {
         // we mark the jpp order
-        for (const auto& jpp: sp_jpps.second) {
+        for (const auto& jpp: filters->jpps_from_sp[SpIdx(sp)]) {
             if (v.comp(jpp.order, Q[jpp.jp_idx])) {
                 Q[jpp.jp_idx] = jpp.order;
+                marked_jps.set(jpp.jp_idx.val);
             }
         }
     }
+    marked_sps_transfer.reset();
 
     return result;
 }
@@ -146,6 +148,9 @@ bool RAPTOR::foot_path(const Visitor& v) {
 void RAPTOR::clear(const bool clockwise, const DateTime bound) {
     const int queue_value = clockwise ?  std::numeric_limits<int>::max() : -1;
     Q.assign(data.dataRaptor->jp_container.get_jps_values(), queue_value);
+    marked_jps.reset();
+    marked_sps_pt.reset();
+    marked_sps_transfer.reset();
     if (labels.empty()) {
         labels.resize(5);
     }
@@ -169,11 +174,13 @@ void RAPTOR::init(const map_stop_point_duration& dep,
         const DateTime begin_dt = bound + (clockwise ? sn_dur : -sn_dur);
         labels[0].mut_dt_transfer(sp_dt.first) = begin_dt;
         best_labels_transfers[sp_dt.first] = begin_dt;
-        for (const auto jpp: jpps_from_sp[sp_dt.first]) {
+        for (const auto jpp: filters->jpps_from_sp[sp_dt.first]) {
             if (clockwise && Q[jpp.jp_idx] > jpp.order) {
                 Q[jpp.jp_idx] = jpp.order;
+                marked_jps.set(jpp.jp_idx.val);
             } else if (! clockwise && Q[jpp.jp_idx] < jpp.order) {
                 Q[jpp.jp_idx] = jpp.order;
+                marked_jps.set(jpp.jp_idx.val);
             }
         }
     }
@@ -374,6 +381,18 @@ static void init_best_pts_snd_pass(const routing::map_stop_point_duration& depar
     }
 }
 
+void RAPTOR::prepare_snd_pass_workers(const size_t nb_workers) {
+    while (snd_pass_workers.size() < nb_workers) {
+        snd_pass_workers.push_back(std::make_unique<RAPTOR>(data));
+    }
+    // the workers share the filters and the cache computed by the first pass
+    for (size_t i = 0; i < nb_workers; ++i) {
+        auto& worker = *snd_pass_workers[i];
+        worker.next_st = next_st;
+        worker.filters = filters;
+    }
+}
+
 std::vector<Path>
 RAPTOR::compute_all(const map_stop_point_duration& departures,
                     const map_stop_point_duration& destinations,
@@ -438,36 +457,21 @@ RAPTOR::compute_all(const map_stop_point_duration& departures,
         lower_bound_fb = std::min(lower_bound_fb, unsigned(pair_sp_dt.second.seconds()));
     }
 
-    size_t nb_snd_pass = 0, nb_useless= 0, last_usefull_2nd_pass = 0, supplementary_2nd_pass = 0;
-    for (const auto& start: starting_points) {
-        Journey fake_journey = convert_to_bound(start,
-                                                lower_bound_fb,
-                                                data.dataRaptor->min_connection_time,
-                                                transfer_penalty,
-                                                clockwise);
-        if (solutions.contains_better_than(fake_journey)) {
-            continue;
-        }
-
-        if (!start.has_priority) {
-            ++supplementary_2nd_pass;
-        }
-        if (supplementary_2nd_pass > max_extra_second_pass) {
-            break;
-        }
-
+    // run a second pass on the given raptor (this one or a worker)
+    // and add its journeys to sols
+    const auto run_snd_pass = [&](RAPTOR& raptor, const StartingPointSndPhase& start, Solutions& sols) {
         const auto& working_labels = first_pass_labels[start.count];
 
-        clear(!clockwise, departure_datetime + (clockwise ? -1 : 1));
+        raptor.clear(!clockwise, departure_datetime + (clockwise ? -1 : 1));
         map_stop_point_duration init_map;
         init_map[start.sp_idx] = 0_s;
-        best_labels_pts = best_labels_pts_for_snd_pass;
-        best_labels_transfers = best_labels_transfers_for_snd_pass;
-        init(init_map, working_labels.dt_pt(start.sp_idx),
-             !clockwise, accessibilite_params.properties);
-        boucleRAPTOR(!clockwise, rt_level, max_transfers);
-        read_solutions(*this,
-                       solutions,
+        raptor.best_labels_pts = best_labels_pts_for_snd_pass;
+        raptor.best_labels_transfers = best_labels_transfers_for_snd_pass;
+        raptor.init(init_map, working_labels.dt_pt(start.sp_idx),
+                    !clockwise, accessibilite_params.properties);
+        raptor.boucleRAPTOR(!clockwise, rt_level, max_transfers);
+        read_solutions(raptor,
+                       sols,
                        !clockwise,
                        departure_datetime,
                        departures,
@@ -476,8 +480,60 @@ RAPTOR::compute_all(const map_stop_point_duration& departures,
                        accessibilite_params,
                        transfer_penalty,
                        start);
+    };
+
+    // The second passes are launched by batch of nb_snd_pass_threads
+    // starting points, on the threads of snd_pass_pool.  The solutions
+    // found by a batch are used to prune the starting points of the
+    // next ones.  With only one thread, it's exactly the sequential
+    // algorithm.
+    const size_t batch_size = snd_pass_pool.nb_threads();
+    if (batch_size > 1 && starting_points.size() > 1) {
+        prepare_snd_pass_workers(batch_size - 1);
+    }
+    size_t nb_snd_pass = 0, nb_useless= 0, last_usefull_2nd_pass = 0, supplementary_2nd_pass = 0;
+    std::vector<const StartingPointSndPhase*> batch;
+    auto it_start = starting_points.begin();
+    bool stop = false;
+    while (! stop && it_start != starting_points.end()) {
+        batch.clear();
+        for (; it_start != starting_points.end() && batch.size() < batch_size; ++it_start) {
+            const auto& start = *it_start;
+            Journey fake_journey = convert_to_bound(start,
+                                                    lower_bound_fb,
+                                                    data.dataRaptor->min_connection_time,
+                                                    transfer_penalty,
+                                                    clockwise);
+            if (solutions.contains_better_than(fake_journey)) {
+                continue;
+            }
 
-        ++nb_snd_pass;
+            if (!start.has_priority) {
+                ++supplementary_2nd_pass;
+            }
+            if (supplementary_2nd_pass > max_extra_second_pass) {
+                stop = true;
+                break;
+            }
+            batch.push_back(&start);
+        }
+
+        if (batch.size() == 1) {
+            run_snd_pass(*this, *batch.front(), solutions);
+        } else if (batch.size() > 1) {
+            // each worker gets its own copy of the solutions for the
+            // pruning of the solution reader, they are merged afterward
+            std::vector<Solutions> batch_solutions(batch.size(), solutions);
+            snd_pass_pool.run(batch.size(), [&](size_t i) {
+                auto& raptor = i == 0 ? *this : *snd_pass_workers[i - 1];
+                run_snd_pass(raptor, *batch[i], batch_solutions[i]);
+            });
+
+            for (const auto& sols: batch_solutions) {
+                for (const auto& journey: sols) { solutions.add(journey); }
+            }
+        }
+        nb_snd_pass += batch.size();
     }
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     LOG4CPLUS_DEBUG(logger, "[2nd pass] lower bound fallback duration = " << lower_bound_fb
@@ -498,6 +554,175 @@ RAPTOR::compute_all(const map_stop_point_duration& departures,
     return result;
 }
 
+namespace {
+// a journey found by the profile query, before its second pass
+struct ProfileEntry {
+    DateTime departure_dt; // departure of the journey, including the fallback
+    unsigned count;
+    SpIdx sp_idx;
+    DateTime arrival_dt; // arrival at sp_idx, without the fallback
+    unsigned fallback_dur;
+};
+}
+
+std::vector<Path>
+RAPTOR::compute_profile(const map_stop_point_duration& departures,
+                        const map_stop_point_duration& destinations,
+                        const DateTime& window_begin,
+                        const DateTime& window_end,
+                        const nt::RTLevel rt_level,
+                        const navitia::time_duration& transfer_penalty,
+                        const uint32_t max_transfers,
+                        const type::AccessibiliteParams& accessibilite_params,
+                        const std::vector<std::string>& forbidden_uri,
+                        const std::vector<std::string>& allowed_ids,
+                        const uint32_t max_duration,
+                        const boost::optional<navitia::time_duration>& direct_path_dur) {
+    // the next stop time cache and the validity of the journey
+    // patterns are computed for the day of window_begin
+    const DateTime end = std::min(window_end, window_begin + DateTimeUtils::SECONDS_PER_DAY);
+    // the journeys leave at the latest at end, thus they arrive before end + max_duration
+    const DateTime bound = limit_bound(true, end, max_duration == std::numeric_limits<uint32_t>::max() ?
+                                                  DateTimeUtils::inf : end + max_duration);
+
+    set_valid_jp_and_jpp(DateTimeUtils::date(window_begin),
+                         accessibilite_params,
+                         forbidden_uri,
+                         allowed_ids,
+                         rt_level);
+    assert(data.dataRaptor->cached_next_st_manager);
+    next_st = data.dataRaptor->cached_next_st_manager->load(window_begin, rt_level, accessibilite_params);
+
+    // the interesting departure datetimes are the ones where we can
+    // catch a vehicle at a departure stop point
+    std::vector<DateTime> departure_dts;
+    for (const auto& sp_dur: departures) {
+        if (! get_sp(sp_dur.first)->accessible(accessibilite_params.properties)) { continue; }
+        const DateTime fallback_dur = sp_dur.second.total_seconds();
+        for (const auto& jpp: filters->jpps_from_sp[sp_dur.first]) {
+            DateTime dt = window_begin + fallback_dur;
+            while (true) {
+                const auto st_dt = next_st->next_stop_time(StopEvent::pick_up, jpp.idx, dt, true);
+                if (st_dt.first == nullptr || st_dt.second > end + fallback_dur) { break; }
+                departure_dts.push_back(st_dt.second - fallback_dur);
+                dt = st_dt.second + 1;
+            }
+        }
+    }
+    boost::sort(departure_dts);
+    departure_dts.erase(std::unique(departure_dts.begin(), departure_dts.end()), departure_dts.end());
+
+    // rRAPTOR: the departure datetimes are explored from the latest
+    // to the earliest without clearing the labels, as a journey
+    // leaving later can also be taken when leaving earlier.  Thus,
+    // each run only explores what is improved by leaving earlier.
+    //
+    // Note that, as the labels are pruned on all the rounds, a
+    // journey arriving at the same time than a later one, but with
+    // less transfers, is not found.
+    clear(true, bound);
+    std::vector<ProfileEntry> entries;
+    // best arrival (with fallback) at the destinations for each round,
+    // for the departure datetimes already explored
+    std::vector<DateTime> best_arrivals;
+    for (auto it = departure_dts.rbegin(); it != departure_dts.rend(); ++it) {
+        const DateTime departure_dt = *it;
+        init(departures, departure_dt, true, accessibilite_params.properties);
+        boucleRAPTOR(true, rt_level, max_transfers);
+
+        if (best_arrivals.size() < labels.size()) {
+            best_arrivals.resize(labels.size(), DateTimeUtils::inf);
+        }
+        DateTime best_with_less_transfers = DateTimeUtils::inf;
+        for (unsigned round = 1; round < labels.size(); ++round) {
+            boost::optional<ProfileEntry> best_entry;
+            for (const auto& sp_dur: destinations) {
+                if (! labels[round].pt_is_initialized(sp_dur.first)) { continue; }
+                if (! get_sp(sp_dur.first)->accessible(accessibilite_params.properties)) { continue; }
+                const unsigned fallback_dur = sp_dur.second.total_seconds();
+                const DateTime arrival_dt = labels[round].dt_pt(sp_dur.first);
+                if (best_entry && arrival_dt + fallback_dur >= best_entry->arrival_dt + best_entry->fallback_dur) {
+                    continue;
+                }
+                best_entry = ProfileEntry{departure_dt, round, sp_dur.first, arrival_dt, fallback_dur};
+            }
+            if (! best_entry) { continue; }
+            const DateTime arrival_dt = best_entry->arrival_dt + best_entry->fallback_dur;
+            // the bound is for the latest departure, it's checked for each one
+            if (arrival_dt - departure_dt > max_duration) { continue; }
+            // only the journeys arriving sooner than the ones leaving
+            // later with less or the same number of transfers are interesting
+            if (arrival_dt < std::min(best_with_less_transfers, best_arrivals[round])) {
+                entries.push_back(*best_entry);
+            }
+            best_with_less_transfers = std::min({best_with_less_transfers, best_arrivals[round], arrival_dt});
+            best_arrivals[round] = std::min(best_arrivals[round], arrival_dt);
+        }
+    }
+
+    // The journeys are then built by a backward pass from their
+    // arrival, as the second pass of compute_all.
+    std::vector<Path> result;
+    for (const auto& entry: entries) {
+        clear(false, entry.departure_dt - 1);
+        for (const auto& sp_dur: departures) {
+            best_labels_pts[sp_dur.first] = std::max(best_labels_pts[sp_dur.first],
+                                                     entry.departure_dt + sp_dur.second.total_seconds() - 1);
+        }
+        map_stop_point_duration init_map;
+        init_map[entry.sp_idx] = 0_s;
+        init(init_map, entry.arrival_dt, false, accessibilite_params.properties);
+        boucleRAPTOR(false, rt_level, max_transfers);
+
+        const StartingPointSndPhase start = {
+            entry.sp_idx,
+            entry.count,
+            entry.arrival_dt + entry.fallback_dur,
+            entry.fallback_dur,
+            true
+        };
+        auto solutions = ParetoFront<Journey, Dominates>(Dominates(true));
+        read_solutions(*this,
+                       solutions,
+                       false,
+                       entry.departure_dt,
+                       departures,
+                       destinations,
+                       rt_level,
+                       accessibilite_params,
+                       transfer_penalty,
+                       start);
+
+        // as in compute_all, the direct path leaving at the same time
+        // is in the solutions, it removes the journeys it dominates
+        if (direct_path_dur) {
+            Journey j;
+            j.sn_dur = *direct_path_dur;
+            j.departure_dt = entry.departure_dt;
+            j.arrival_dt = j.departure_dt + j.sn_dur;
+            solutions.add(j);
+        }
+
+        // we keep the latest departure, with the least transfers
+        const Journey* best = nullptr;
+        for (const auto& j: solutions) {
+            if (j.sections.empty()) { continue; }
+            if (best == nullptr
+                    || j.departure_dt > best->departure_dt
+                    || (j.departure_dt == best->departure_dt && j.sections.size() < best->sections.size())) {
+                best = &j;
+            }
+        }
+        if (best == nullptr) { continue; }
+        result.push_back(make_path(*best, data));
+    }
+
+    std::sort(result.begin(), result.end(), [](const Path& lhs, const Path& rhs) {
+        return lhs.items.front().departure < rhs.items.front().departure;
+    });
+    return result;
+}
+
 void
 RAPTOR::isochrone(const map_stop_point_duration& departures,
                   const DateTime& departure_datetime,
@@ -617,9 +842,14 @@ void RAPTOR::set_valid_jp_and_jpp(
     const nt::RTLevel rt_level)
 {
     const auto& jp_container = data.dataRaptor->jp_container;
+    // a new object, the previous one can still be shared with the workers
+    auto new_filters = std::make_shared<RaptorFilters>();
+    auto& valid_journey_patterns = new_filters->valid_journey_patterns;
+    auto& valid_stop_points = new_filters->valid_stop_points;
     valid_journey_patterns = data.dataRaptor->jp_validity_patterns[rt_level][date];
     boost::dynamic_bitset<> valid_journey_pattern_points(jp_container.nb_jpps());
     valid_journey_pattern_points.set();
+    valid_stop_points.resize(data.pt_data->stop_points.size());
     valid_stop_points.set();
 
     auto forbidden_objs = ObjsFromIds(forbidden, jp_container, data);
@@ -666,8 +896,9 @@ void RAPTOR::set_valid_jp_and_jpp(
     // jpps.  Thanks to that, we don't need to check
     // valid_journey_pattern[_point]s as we iterate only on the
     // feasible ones.
-    jpps_from_sp = data.dataRaptor->jpps_from_sp;
-    jpps_from_sp.filter_jpps(valid_journey_pattern_points);
+    new_filters->jpps_from_sp = data.dataRaptor->jpps_from_sp;
+    new_filters->jpps_from_sp.filter_jpps(valid_journey_pattern_points);
+    filters = std::move(new_filters);
 }
 
 template<typename Visitor>
@@ -689,86 +920,101 @@ void RAPTOR::raptor_loop(Visitor visitor,
         }
         const auto& prec_labels = labels[count -1];
         auto& working_labels = labels[this->count];
+        if (nb_explored_jps_by_round.size() <= count) {
+            nb_explored_jps_by_round.resize(count + 1, 0);
+        }
+        nb_explored_jps_by_round[count] += marked_jps.count();
         /*
          * We need to store it so we can apply stay_in after applying normal vjs
          * We want to do it, to favoritize normal vj against stay_in vjs
          */
-        for (auto q_elt: Q) {
-            const JpIdx jp_idx = q_elt.first;
-            if(q_elt.second != visitor.init_queue_item()) {
-                bool is_onboard = false;
-                DateTime workingDt = visitor.worst_datetime();
-                DateTime base_dt = workingDt;
-                typename Visitor::stop_time_iterator it_st;
-                uint16_t l_zone = std::numeric_limits<uint16_t>::max();
-                const auto& jpps_to_explore = visitor.jpps_from_order(data.dataRaptor->jpps_from_jp,
-                                                                      jp_idx,
-                                                                      q_elt.second);
-                for (const auto& jpp: jpps_to_explore) {
-                    if (is_onboard) {
-                        ++it_st;
-                        // We update workingDt with the new arrival time
-                        // We need at each journey pattern point when we have a st
-                        // If we don't it might cause problem with overmidnight vj
-                        const type::StopTime& st = *it_st;
-                        workingDt = st.section_end(base_dt, visitor.clockwise());
-                        // We check if there are no drop_off_only and if the local_zone is okay
-                        if (st.valid_end(visitor.clockwise())
-                            && (l_zone == std::numeric_limits<uint16_t>::max() ||
-                                l_zone != st.local_traffic_zone)
-                            && visitor.comp(workingDt, best_labels_pts[jpp.sp_idx])
-                            && valid_stop_points[jpp.sp_idx.val]) // we need to check the accessibility
-                        {
-                            working_labels.mut_dt_pt(jpp.sp_idx) = workingDt;
-                            best_labels_pts[jpp.sp_idx] = working_labels.dt_pt(jpp.sp_idx);
-                            continue_algorithm = true;
-                        }
+        // Only the marked journey patterns are explored: the cost of a
+        // round is proportional to the number of improved stop points,
+        // not to the number of journey patterns
+        for (auto jp = marked_jps.find_first(); jp != marked_jps.npos; jp = marked_jps.find_next(jp)) {
+            const JpIdx jp_idx = JpIdx(jp);
+            auto& q_elt = Q[jp_idx];
+            assert(q_elt != visitor.init_queue_item());
+            bool is_onboard = false;
+            DateTime workingDt = visitor.worst_datetime();
+            DateTime base_dt = workingDt;
+            // it_st is only used to know on which stop time we are,
+            // the times are read from the compact stop times it_cst
+            typename Visitor::stop_time_iterator it_st;
+            typename Visitor::compact_st_iterator it_cst;
+            const auto& stop_time_table = data.dataRaptor->stop_time_table;
+            uint16_t l_zone = std::numeric_limits<uint16_t>::max();
+            const auto& jpps_to_explore = visitor.jpps_from_order(data.dataRaptor->jpps_from_jp,
+                                                                  jp_idx,
+                                                                  q_elt);
+            for (const auto& jpp: jpps_to_explore) {
+                if (is_onboard) {
+                    ++it_st;
+                    ++it_cst;
+                    // We update workingDt with the new arrival time
+                    // We need at each journey pattern point when we have a st
+                    // If we don't it might cause problem with overmidnight vj
+                    const auto& st = *it_cst;
+                    workingDt = st.section_end(base_dt, visitor.clockwise());
+                    // We check if there are no drop_off_only and if the local_zone is okay
+                    if (st.valid_end(visitor.clockwise())
+                        && (l_zone == std::numeric_limits<uint16_t>::max() ||
+                            l_zone != st.local_traffic_zone)
+                        && visitor.comp(workingDt, best_labels_pts[jpp.sp_idx])
+                        && filters->valid_stop_points[jpp.sp_idx.val]) // we need to check the accessibility
+                    {
+                        working_labels.mut_dt_pt(jpp.sp_idx) = workingDt;
+                        best_labels_pts[jpp.sp_idx] = working_labels.dt_pt(jpp.sp_idx);
+                        marked_sps_pt.set(jpp.sp_idx.val);
+                        continue_algorithm = true;
                     }
+                }
 
-                    // We try to get on a vehicle, if we were already on a vehicle, but we arrived
-                    // before on the previous via a connection, we try to catch a vehicle leaving this
-                    // journey pattern point before
-                    const DateTime previous_dt = prec_labels.dt_transfer(jpp.sp_idx);
-                    if (prec_labels.transfer_is_initialized(jpp.sp_idx) && valid_stop_points[jpp.sp_idx.val] &&
-                        (!is_onboard || visitor.better_or_equal(previous_dt, base_dt, *it_st))) {
-                        const auto tmp_st_dt = next_st->next_stop_time(
-                            visitor.stop_event(), jpp.idx, previous_dt, visitor.clockwise());
-                        if (tmp_st_dt.first != nullptr) {
-                            if (! is_onboard || &*it_st != tmp_st_dt.first) {
-                                // st_range is quite cache
-                                // unfriendly, so avoid using it if
-                                // not really needed.
-                                it_st = visitor.st_range(*tmp_st_dt.first).begin();
-                                is_onboard = true;
-                                l_zone = it_st->local_traffic_zone;
-                                // note that if we have found a better
-                                // pickup, and that this pickup does
-                                // not have the same local traffic
-                                // zone, we may miss some interesting
-                                // solutions.
-                            } else if (l_zone != it_st->local_traffic_zone) {
-                                // if we can pick up in this vj with 2
-                                // different zones, we can drop off
-                                // anywhere (we'll chose later at
-                                // which stop we pickup)
-                                l_zone = std::numeric_limits<uint16_t>::max();
-                            }
-                            workingDt = tmp_st_dt.second;
-                            base_dt = tmp_st_dt.first->base_dt(workingDt, visitor.clockwise());
-                            BOOST_ASSERT(! visitor.comp(workingDt, previous_dt));
+                // We try to get on a vehicle, if we were already on a vehicle, but we arrived
+                // before on the previous via a connection, we try to catch a vehicle leaving this
+                // journey pattern point before
+                const DateTime previous_dt = prec_labels.dt_transfer(jpp.sp_idx);
+                if (prec_labels.transfer_is_initialized(jpp.sp_idx) && filters->valid_stop_points[jpp.sp_idx.val] &&
+                    (!is_onboard || visitor.better_or_equal(previous_dt, base_dt, *it_cst))) {
+                    const auto tmp_st_dt = next_st->next_stop_time(
+                        visitor.stop_event(), jpp.idx, previous_dt, visitor.clockwise());
+                    if (tmp_st_dt.first != nullptr) {
+                        if (! is_onboard || &*it_st != tmp_st_dt.first) {
+                            // st_range is quite cache
+                            // unfriendly, so avoid using it if
+                            // not really needed.
+                            it_st = visitor.st_range(*tmp_st_dt.first).begin();
+                            it_cst = visitor.compact_st(stop_time_table, *tmp_st_dt.first);
+                            is_onboard = true;
+                            l_zone = it_cst->local_traffic_zone;
+                            // note that if we have found a better
+                            // pickup, and that this pickup does
+                            // not have the same local traffic
+                            // zone, we may miss some interesting
+                            // solutions.
+                        } else if (l_zone != it_cst->local_traffic_zone) {
+                            // if we can pick up in this vj with 2
+                            // different zones, we can drop off
+                            // anywhere (we'll chose later at
+                            // which stop we pickup)
+                            l_zone = std::numeric_limits<uint16_t>::max();
                         }
+                        workingDt = tmp_st_dt.second;
+                        base_dt = tmp_st_dt.first->base_dt(workingDt, visitor.clockwise());
+                        BOOST_ASSERT(! visitor.comp(workingDt, previous_dt));
                     }
                 }
-                if (is_onboard) {
-                    const type::VehicleJourney* vj_stay_in = visitor.get_extension_vj(it_st->vehicle_journey);
-                    if (vj_stay_in) {
-                        bool applied = apply_vj_extension(visitor, rt_level, vj_stay_in, l_zone, base_dt);
-                        continue_algorithm = continue_algorithm || applied;
-                    }
+            }
+            if (is_onboard) {
+                const type::VehicleJourney* vj_stay_in = visitor.get_extension_vj(it_st->vehicle_journey);
+                if (vj_stay_in) {
+                    bool applied = apply_vj_extension(visitor, rt_level, vj_stay_in, l_zone, base_dt);
+                    continue_algorithm = continue_algorithm || applied;
                 }
             }
-            q_elt.second = visitor.init_queue_item();
+            q_elt = visitor.init_queue_item();
         }
+        marked_jps.reset();
         continue_algorithm = continue_algorithm && this->foot_path(visitor);
     }
 }
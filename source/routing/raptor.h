@@ -42,6 +42,7 @@ www.navitia.io
 #include "dataraptor.h"
 #include "raptor_utils.h"
 #include "type/time_duration.h"
+#include "type/thread_pool.h"
 
 namespace navitia { namespace routing {
 
@@ -55,6 +56,17 @@ struct StartingPointSndPhase {
     bool has_priority;
 };
 
+/// What a request can use, computed by set_valid_jp_and_jpp.  Read only
+/// during the search, thus shared by a raptor and its second pass workers.
+struct RaptorFilters {
+    /// Are the journey pattern valid
+    boost::dynamic_bitset<> valid_journey_patterns;
+    /// The valid journey pattern points of each stop point
+    dataRAPTOR::JppsFromSp jpps_from_sp;
+    // set to store if the stop_point is valid
+    boost::dynamic_bitset<> valid_stop_points;
+};
+
 /** Worker Raptor : une instance par thread, les données sont modifiées par le calcul */
 struct RAPTOR
 {
@@ -72,23 +84,40 @@ struct RAPTOR
 
     /// Number of transfers done for the moment
     unsigned int count;
-    /// Are the journey pattern valid
-    boost::dynamic_bitset<> valid_journey_patterns;
-    dataRAPTOR::JppsFromSp jpps_from_sp;
+    std::shared_ptr<const RaptorFilters> filters;
     /// Order of the first journey_pattern point of each journey_pattern
     IdxMap<JourneyPattern, int> Q;
+    /// Journey patterns having a value in Q, i.e. to explore in the next round.
+    /// Only these ones are visited by raptor_loop.
+    boost::dynamic_bitset<> marked_jps;
+    /// Stop points whose dt_pt label has been improved in the current round
+    boost::dynamic_bitset<> marked_sps_pt;
+    /// Stop points whose dt_transfer label has been improved in the current round
+    boost::dynamic_bitset<> marked_sps_transfer;
+    /// Number of explored journey patterns for each round, summed over
+    /// all the raptor_loop (only used for statistics)
+    std::vector<size_t> nb_explored_jps_by_round;
 
-    // set to store if the stop_point is valid
-    boost::dynamic_bitset<> valid_stop_points;
+    /// Number of second passes of compute_all run concurrently (1 means sequential)
+    size_t nb_snd_pass_threads;
+    /// Raptors used by the concurrent second passes, with their own labels.
+    /// They are created on demand, and kept to avoid reallocating the labels.
+    std::vector<std::unique_ptr<RAPTOR>> snd_pass_workers;
+    /// Threads running the concurrent second passes, kept between the requests
+    ThreadPool snd_pass_pool;
 
-    explicit RAPTOR(const navitia::type::Data& data) :
+    explicit RAPTOR(const navitia::type::Data& data, size_t nb_snd_pass_threads = 1) :
         data(data),
         best_labels_pts(data.pt_data->stop_points),
         best_labels_transfers(data.pt_data->stop_points),
         count(0),
-        valid_journey_patterns(data.dataRaptor->jp_container.nb_jps()),
+        filters(std::make_shared<RaptorFilters>()),
         Q(data.dataRaptor->jp_container.get_jps_values()),
-        valid_stop_points(data.pt_data->stop_points.size())
+        marked_jps(data.dataRaptor->jp_container.nb_jps()),
+        marked_sps_pt(data.pt_data->stop_points.size()),
+        marked_sps_transfer(data.pt_data->stop_points.size()),
+        nb_snd_pass_threads(nb_snd_pass_threads),
+        snd_pass_pool(nb_snd_pass_threads)
     {
         labels.assign(10, data.dataRaptor->labels_const);
         first_pass_labels.assign(10, data.dataRaptor->labels_const);
@@ -143,6 +172,32 @@ struct RAPTOR
                 const size_t max_extra_second_pass = 0);
 
 
+    /** Profile query: computes the journeys leaving between window_begin
+     *  and window_end that are Pareto optimal on the departure, the
+     *  arrival and the number of transfers (clockwise only).
+     *
+     *  The departure datetimes are explored from the latest to the
+     *  earliest, reusing the labels (rRAPTOR), instead of a
+     *  compute_all for each one. The window is limited to one day.
+     *  As in compute_all, the journeys lasting more than max_duration
+     *  and the ones dominated by the direct path are dropped.
+     *  The paths are sorted by departure.
+     */
+    std::vector<Path>
+    compute_profile(const map_stop_point_duration& departures,
+                    const map_stop_point_duration& destinations,
+                    const DateTime& window_begin,
+                    const DateTime& window_end,
+                    const nt::RTLevel rt_level,
+                    const navitia::time_duration& transfer_penalty,
+                    const uint32_t max_transfers = 10,
+                    const type::AccessibiliteParams& accessibilite_params = type::AccessibiliteParams(),
+                    const std::vector<std::string>& forbidden = std::vector<std::string>(),
+                    const std::vector<std::string>& allowed = std::vector<std::string>(),
+                    const uint32_t max_duration = std::numeric_limits<uint32_t>::max(),
+                    const boost::optional<navitia::time_duration>& direct_path_dur = boost::none);
+
+
     /** Calcul l'isochrone à partir de tous les points contenus dans departs,
      *  vers tous les autres points.
      *  Renvoie toutes les arrivées vers tous les stop points.
@@ -172,7 +227,7 @@ struct RAPTOR
                       const nt::RTLevel rt_level,
                       const uint32_t max_transfers);
 
-    /// Apply foot pathes to labels
+    /// Apply foot pathes to labels, from the stop points marked in the current round
     /// Return true if it improves at least one label, false otherwise
     template<typename Visitor> bool foot_path(const Visitor& v);
 
@@ -190,6 +245,10 @@ struct RAPTOR
                      const nt::RTLevel rt_level,
                      uint32_t max_transfers=std::numeric_limits<uint32_t>::max());
 
+    /// Create the second pass workers if needed and share with them the
+    /// filters and the next stop time cache of the first pass
+    void prepare_snd_pass_workers(size_t nb_workers);
+
     /// Return the round that has found the best solution for this stop point
     /// Return -1 if no solution found
     int best_round(SpIdx sp_idx);
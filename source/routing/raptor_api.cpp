@@ -42,6 +42,7 @@ www.navitia.io
 #include <boost/range/algorithm/count.hpp>
 #include <unordered_set>
 #include <chrono>
+#include <future>
 #include <string>
 
 
@@ -1038,7 +1039,8 @@ void make_response(navitia::PbCreator& pb_creator,
                    const navitia::time_duration& transfer_penalty,
                    uint32_t max_duration,
                    uint32_t max_transfers,
-                   uint32_t max_extra_second_pass) {
+                   uint32_t max_extra_second_pass,
+                   bool profile) {
 
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     std::vector<Path> pathes;
@@ -1049,8 +1051,15 @@ void make_response(navitia::PbCreator& pb_creator,
         return;
     }
     worker.init(origin, {destination});
-    auto departures = get_stop_points(origin, raptor.data, worker);
-    auto destinations = get_stop_points(destination, raptor.data, worker, true);
+    routing::map_stop_point_duration departures, destinations;
+    // the departure and the arrival have their own path finder
+    worker.fallbacks_pool->run(2, [&](size_t i) {
+        if (i == 0) {
+            departures = get_stop_points(origin, raptor.data, worker);
+        } else {
+            destinations = get_stop_points(destination, raptor.data, worker, true);
+        }
+    });
     const auto direct_path = get_direct_path(worker, origin, destination);
 
     if(departures.size() == 0 && destinations.size() == 0){
@@ -1090,6 +1099,28 @@ void make_response(navitia::PbCreator& pb_creator,
         OptTimeDur() :
         OptTimeDur(direct_path.duration / origin.streetnetwork_params.speed_factor);
 
+    // In profile mode, all the interesting journeys leaving between
+    // the first and the last datetime are computed at once.  The
+    // profile query is limited to one day, a larger window is
+    // computed datetime by datetime.
+    // datetimes are sorted from the latest for clockwise requests
+    if (profile && clockwise && datetimes.front() - datetimes.back() <= bt::hours(24)) {
+        const auto to_dt = [&](const bt::ptime& datetime) {
+            return DateTimeUtils::set((datetime.date() - raptor.data.meta->production_date.begin()).days(),
+                                      datetime.time_of_day().total_seconds());
+        };
+        pathes = raptor.compute_profile(departures, destinations, to_dt(datetimes.back()),
+                                        to_dt(datetimes.front()), rt_level, transfer_penalty,
+                                        max_transfers, accessibilite_params, forbidden, allowed,
+                                        max_duration, direct_path_dur);
+        LOG4CPLUS_DEBUG(logger, "raptor profile found " << pathes.size() << " solutions");
+        for (auto& path: pathes) {
+            path.request_time = datetimes.back();
+        }
+        make_pathes(pb_creator, pathes, worker, direct_path, origin, destination, datetimes, clockwise);
+        return;
+    }
+
     for(bt::ptime datetime : datetimes) {
         int day = (datetime.date() - raptor.data.meta->production_date.begin()).days();
         int time = datetime.time_of_day().total_seconds();
@@ -1348,7 +1379,9 @@ void make_heat_map(navitia::PbCreator& pb_creator,
                    georef::StreetNetwork & worker,
                    const double& speed,
                    const navitia::type::Mode_e mode,
-                   const uint32_t resolution) {
+                   const uint32_t resolution,
+                   ThreadPool& pool,
+                   const size_t nb_threads) {
 
     IsochroneCommon isochrone_common;
     auto has_error = fill_isochrone_common(isochrone_common, raptor, center, departure_datetime, max_duration,
@@ -1366,7 +1399,7 @@ void make_heat_map(navitia::PbCreator& pb_creator,
 
     auto heat_map = build_raster_isochrone(worker.geo_ref, speed, mode, isochrone_common.init_dt, raptor,
                                            isochrone_common.coord_origin, max_duration, clockwise,
-                                           isochrone_common.bound, resolution);
+                                           isochrone_common.bound, resolution, pool, nb_threads);
     add_heat_map(heat_map, pb_creator, center, clockwise, isochrone_common.datetime);
 }
 
@@ -48,6 +48,7 @@ namespace navitia{
     }
     class time_duration;
     struct PbCreator;
+    class ThreadPool;
 }
 
 namespace navitia { namespace routing {
@@ -75,7 +76,8 @@ void make_response(navitia::PbCreator& pb_creator,
                    const navitia::time_duration& transfer_penalty,
                    uint32_t max_duration=std::numeric_limits<uint32_t>::max(),
                    uint32_t max_transfers=std::numeric_limits<uint32_t>::max(),
-                   uint32_t max_extra_second_pass = 0);
+                   uint32_t max_extra_second_pass = 0,
+                   bool profile = false);
 
 void make_isochrone(navitia::PbCreator& pb_creator,
                     RAPTOR &raptor,
@@ -136,6 +138,8 @@ void make_heat_map(navitia::PbCreator& pb_creator,
                    georef::StreetNetwork & worker,
                    const double& speed,
                    const navitia::type::Mode_e mode,
-                   const uint32_t resolution);
+                   const uint32_t resolution,
+                   ThreadPool& pool,
+                   const size_t nb_threads);
 
 }}
@@ -455,7 +455,7 @@ struct RaptorSolutionReader {
             const SpIdx end_sp_idx = SpIdx(*end_st.stop_point);
             const DateTime end_limit = raptor.labels[count - 1].dt_transfer(end_sp_idx);
             if (v.comp(end_limit, cur_dt)) { continue; }
-            if (! raptor.valid_stop_points[end_sp_idx.val]) { continue; }
+            if (! raptor.filters->valid_stop_points[end_sp_idx.val]) { continue; }
 
             // great, we can end
             if (count == 1) {
@@ -510,13 +510,13 @@ struct RaptorSolutionReader {
         const unsigned transfer_t =
             v.clockwise() ? begin_dt - end_st_dt.second : end_st_dt.second - begin_dt;
         const DateTime begin_limit = raptor.labels[count].dt_pt(begin_sp_idx);
-        for (const auto jpp: raptor.jpps_from_sp[begin_sp_idx]) {
+        for (const auto jpp: raptor.filters->jpps_from_sp[begin_sp_idx]) {
             // trying to begin
             const auto begin_st_dt = raptor.next_st->next_stop_time(
                         v.stop_event(), jpp.idx, begin_dt, v.clockwise());
             if (begin_st_dt.first == nullptr) { continue; }
             if (v.comp(begin_limit, begin_st_dt.second)) { continue; }
-            if (! raptor.valid_stop_points[begin_sp_idx.val]) { continue; }
+            if (! raptor.filters->valid_stop_points[begin_sp_idx.val]) { continue; }
 
             // great, we can begin
             const Transfer tr = {
@@ -549,7 +549,7 @@ struct RaptorSolutionReader {
                   const SpIdx begin_sp_idx,
                   const DateTime begin_dt) {
         const DateTime begin_limit = raptor.labels[count].dt_pt(begin_sp_idx);
-        for (const auto jpp: raptor.jpps_from_sp[begin_sp_idx]) {
+        for (const auto jpp: raptor.filters->jpps_from_sp[begin_sp_idx]) {
             // trying to begin
             const auto begin_st_dt = raptor.next_st->next_stop_time(
                                 v.stop_event(), jpp.idx, begin_dt, v.clockwise());
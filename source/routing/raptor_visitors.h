@@ -8,8 +8,11 @@ struct raptor_visitor {
 
     typedef std::vector<type::StopTime>::const_iterator stop_time_iterator;
     typedef boost::iterator_range<stop_time_iterator> stop_time_range;
+    typedef const dataRAPTOR::StopTimeTable::Entry* compact_st_iterator;
 
-    inline bool better_or_equal(const DateTime& a, const DateTime& current_dt, const type::StopTime& st) const {
+    // ST is a StopTime or a StopTimeTable::Entry
+    template<typename ST>
+    inline bool better_or_equal(const DateTime& a, const DateTime& current_dt, const ST& st) const {
         return a <= st.section_end(current_dt, clockwise());
     }
 
@@ -25,6 +28,12 @@ struct raptor_visitor {
                                           vj->stop_time_list.end());
     }
 
+    // the compact stop times of st's vj, beginning at st
+    inline compact_st_iterator compact_st(const dataRAPTOR::StopTimeTable& table,
+                                          const type::StopTime& st) const {
+        return table.get(st);
+    }
+
     template<typename T1, typename T2> inline bool comp(const T1& a, const T2& b) const {
         return a < b;
     }
@@ -67,8 +76,11 @@ struct raptor_reverse_visitor {
 
     typedef std::vector<type::StopTime>::const_reverse_iterator stop_time_iterator;
     typedef boost::iterator_range<stop_time_iterator> stop_time_range;
+    typedef std::reverse_iterator<const dataRAPTOR::StopTimeTable::Entry*> compact_st_iterator;
 
-    inline bool better_or_equal(const DateTime &a, const DateTime &current_dt, const type::StopTime& st) const {
+    // ST is a StopTime or a StopTimeTable::Entry
+    template<typename ST>
+    inline bool better_or_equal(const DateTime &a, const DateTime &current_dt, const ST& st) const {
         return a >= st.section_end(current_dt, clockwise());
     }
 
@@ -85,6 +97,12 @@ struct raptor_reverse_visitor {
             vj->stop_time_list.rend());
     }
 
+    // the compact stop times of st's vj, beginning at st, in reverse order
+    inline compact_st_iterator compact_st(const dataRAPTOR::StopTimeTable& table,
+                                          const type::StopTime& st) const {
+        return compact_st_iterator(table.get(st) + 1);
+    }
+
     template<typename T1, typename T2> inline bool comp(const T1& a, const T2& b) const {
         return a > b;
     }
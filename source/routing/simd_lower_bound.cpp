@@ -0,0 +1,129 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "simd_lower_bound.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <cstdint>
+
+namespace navitia { namespace routing {
+
+namespace {
+
+// the binary search stops on blocks of this size, counted with SIMD
+const size_t block_size = 32;
+
+// number of elements of [times, times + size) less than value
+size_t count_less_scalar(const DateTime* times, size_t size, DateTime value) {
+    size_t res = 0;
+    for (size_t i = 0; i < size; ++i) {
+        res += times[i] < value;
+    }
+    return res;
+}
+
+#if defined(__x86_64__)
+// There is no unsigned 32 bits compare in SSE2/AVX2: the values are
+// shifted by 2^31 to use the signed one.
+size_t count_less_sse2(const DateTime* times, size_t size, DateTime value) {
+    const __m128i bias = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+    const __m128i v = _mm_xor_si128(_mm_set1_epi32(int32_t(value)), bias);
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(times + i)), bias);
+        // the compare gives -1 for true
+        acc = _mm_sub_epi32(acc, _mm_cmplt_epi32(x, v));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return size_t(_mm_cvtsi128_si32(acc)) + count_less_scalar(times + i, size - i, value);
+}
+
+__attribute__((target("avx2")))
+size_t count_less_avx2(const DateTime* times, size_t size, DateTime value) {
+    const __m256i bias = _mm256_set1_epi32(std::numeric_limits<int32_t>::min());
+    const __m256i v = _mm256_xor_si256(_mm256_set1_epi32(int32_t(value)), bias);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256i x = _mm256_xor_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(times + i)), bias);
+        acc = _mm256_sub_epi32(acc, _mm256_cmpgt_epi32(v, x));
+    }
+    __m128i acc128 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, _MM_SHUFFLE(2, 3, 0, 1)));
+    return size_t(_mm_cvtsi128_si32(acc128)) + count_less_scalar(times + i, size - i, value);
+}
+#endif
+
+using CountLess = size_t (*)(const DateTime*, size_t, DateTime);
+
+CountLess select_count_less() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { return count_less_avx2; }
+    return count_less_sse2;
+#else
+    return count_less_scalar;
+#endif
+}
+
+const CountLess count_less = select_count_less();
+
+// Branchless binary search: returns the beginning of a block of at
+// most max_size elements, all the elements before being less than
+// value and all the elements after being not less than value.
+inline const DateTime* narrow(const DateTime* base, size_t& size, DateTime value, size_t max_size) {
+    while (size > max_size) {
+        const size_t half = size / 2;
+        base = (base[half] < value) ? base + half : base;
+        size -= half;
+    }
+    return base;
+}
+
+} // anonymous namespace
+
+size_t simd_lower_bound(const DateTime* times, size_t size, DateTime value) {
+    const DateTime* base = narrow(times, size, value, block_size);
+    return size_t(base - times) + count_less(base, size, value);
+}
+
+size_t scalar_lower_bound(const DateTime* times, size_t size, DateTime value) {
+    const DateTime* base = narrow(times, size, value, 1);
+    return size_t(base - times) + count_less_scalar(base, size, value);
+}
+
+}} // namespace navitia::routing
@@ -0,0 +1,61 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/datetime.h"
+
+#include <cstddef>
+#include <limits>
+
+namespace navitia { namespace routing {
+
+/** Vectorized lower bound on a sorted array of DateTime.
+ *
+ * Returns the index of the first element of [times, times + size)
+ * that is not less than value (as std::lower_bound).
+ *
+ * A branchless binary search narrows the range to a small block,
+ * whose elements less than value are then counted with SIMD
+ * compares (AVX2 or SSE2 on x86_64, chosen at runtime, scalar
+ * elsewhere).
+ */
+size_t simd_lower_bound(const DateTime* times, size_t size, DateTime value);
+
+/// Same as simd_lower_bound, but for the first element greater than value
+inline size_t simd_upper_bound(const DateTime* times, size_t size, DateTime value) {
+    if (value == std::numeric_limits<DateTime>::max()) { return size; }
+    return simd_lower_bound(times, size, value + 1);
+}
+
+/// Scalar implementation, exposed for testing and benchmarking
+size_t scalar_lower_bound(const DateTime* times, size_t size, DateTime value);
+
+}} // namespace navitia::routing
@@ -82,6 +82,12 @@ BOOST_AUTO_TEST_CASE(ok_before_and_after_disruption) {
 
     // a clone and set
     auto data_cloned = data_manager.get_data_clone();
+    // the fare, the street network and its indexes are shared
+    BOOST_CHECK_EQUAL(data_cloned->fare, data_manager.get_data()->fare);
+    BOOST_CHECK_EQUAL(data_cloned->geo_ref->graph, data_manager.get_data()->geo_ref->graph);
+    BOOST_CHECK_EQUAL(data_cloned->geo_ref->pl, data_manager.get_data()->geo_ref->pl);
+    BOOST_CHECK_EQUAL(data_cloned->geo_ref->projected_stop_points,
+                      data_manager.get_data()->geo_ref->projected_stop_points);
     data_cloned->build_raptor();
     data_manager.set_data(data_cloned);
 
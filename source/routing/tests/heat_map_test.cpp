@@ -122,10 +122,11 @@ BOOST_AUTO_TEST_CASE(heat_map_test) {
 
     ed::builder b = {"20120614"};
 
-    boost::add_vertex(ng::Vertex(A),b.data->geo_ref->graph);
-    boost::add_vertex(ng::Vertex(B),b.data->geo_ref->graph);
-    boost::add_vertex(ng::Vertex(C),b.data->geo_ref->graph);
-    boost::add_vertex(ng::Vertex(D),b.data->geo_ref->graph);
+    auto& graph = ng::mutable_part(b.data->geo_ref->graph);
+    boost::add_vertex(ng::Vertex(A), graph);
+    boost::add_vertex(ng::Vertex(B), graph);
+    boost::add_vertex(ng::Vertex(C), graph);
+    boost::add_vertex(ng::Vertex(D), graph);
     b.data->geo_ref->init();
 
     size_t way_idx = 0;
@@ -139,11 +140,11 @@ BOOST_AUTO_TEST_CASE(heat_map_test) {
 
     size_t e_idx(0);
     //we add each edge as a one way street
-    boost::add_edge(BB, AA, ng::Edge(e_idx++, navitia::seconds(10)), b.data->geo_ref->graph);
+    boost::add_edge(BB, AA, ng::Edge(e_idx++, navitia::seconds(10)), graph);
     //B->C is very cheap but will not be used
-    boost::add_edge(BB, CC, ng::Edge(e_idx++, navitia::seconds(1)), b.data->geo_ref->graph);
-    boost::add_edge(AA, CC, ng::Edge(e_idx++, navitia::seconds(1000)), b.data->geo_ref->graph);
-    boost::add_edge(CC, DD, ng::Edge(e_idx++, navitia::seconds(10)), b.data->geo_ref->graph);
+    boost::add_edge(BB, CC, ng::Edge(e_idx++, navitia::seconds(1)), graph);
+    boost::add_edge(AA, CC, ng::Edge(e_idx++, navitia::seconds(1000)), graph);
+    boost::add_edge(CC, DD, ng::Edge(e_idx++, navitia::seconds(10)), graph);
 
     b.data->geo_ref->ways[0]->edges.push_back(std::make_pair(AA, BB));
     b.data->geo_ref->ways[1]->edges.push_back(std::make_pair(BB, CC));
@@ -190,9 +191,10 @@ BOOST_AUTO_TEST_CASE(heat_map_test) {
     auto mode = navitia::type::Mode_e::Walking;
     const auto bound = navitia::DateTimeUtils::set(0, "09:00"_t);
     const auto init_dt = navitia::DateTimeUtils::set(0, "07:00"_t);
+    navitia::ThreadPool pool(4);
     const auto isochrone= build_raster_isochrone(*b.data->geo_ref, speed, mode,
                                                  init_dt,raptor, A, max_duration,
-                                                 true, bound, resolution);
+                                                 true, bound, resolution, pool, 1);
     BOOST_CHECK(isochrone.size() > 0);
     const auto header = R"({"line_headers":[{"cell_lat":)";
     std::size_t found_header = isochrone.find(header);
@@ -203,7 +205,7 @@ BOOST_AUTO_TEST_CASE(heat_map_test) {
     auto distances = init_distance(*b.data->geo_ref, stop_points, init_dt, raptor,
                                    mode, E, true, bound, speed);
     auto heat_map = fill_heat_map(box,  height_step, width_step, *b.data->geo_ref,
-                                  min_dist,  max_duration, speed, distances, step);
+                                  min_dist,  max_duration, speed, distances, step, pool, 1);
     std::vector<navitia::time_duration> result;
     for (size_t i = 0; i < step; i++){
         for (size_t j = 0; j < step; j++){
@@ -216,4 +218,17 @@ BOOST_AUTO_TEST_CASE(heat_map_test) {
     for (size_t i = 3; i < result.size(); i++){
         BOOST_CHECK(result[i].is_pos_infinity());
     }
+
+    // the grid filled by bands on several threads is the same
+    const auto isochrone_threads = build_raster_isochrone(*b.data->geo_ref, speed, mode,
+                                                          init_dt, raptor, A, max_duration,
+                                                          true, bound, resolution, pool, 4);
+    BOOST_CHECK_EQUAL(isochrone_threads, isochrone);
+    auto heat_map_threads = fill_heat_map(box, height_step, width_step, *b.data->geo_ref,
+                                          min_dist, max_duration, speed, distances, step, pool, 2);
+    for (size_t i = 0; i < step; i++){
+        for (size_t j = 0; j < step; j++){
+            BOOST_CHECK_EQUAL(heat_map_threads.body[i].second[j], heat_map.body[i].second[j]);
+        }
+    }
 }
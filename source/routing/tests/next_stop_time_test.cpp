@@ -31,9 +31,12 @@ www.navitia.io
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE next_stop_time_test
 #include <boost/test/unit_test.hpp>
+#include <random>
+#include <algorithm>
 
 #include "routing/next_stop_time.h"
 #include "routing/dataraptor.h"
+#include "routing/simd_lower_bound.h"
 #include "ed/build_helper.h"
 #include "type/type.h"
 #include "type/pt_data.h"
@@ -2206,3 +2209,68 @@ BOOST_FIXTURE_TEST_CASE(test_get_next_dep_overnight_midnight_case, midnight_freq
 
     BOOST_REQUIRE_EQUAL(next_dt, DateTimeUtils::set(1, 17 * 60 * 60 + 30));
 }
+
+/*
+ * simd_lower_bound and scalar_lower_bound must give the same results
+ * as std::lower_bound, around the block size of the SIMD count,
+ * with duplicates and with values over 2^31 (unsigned compare)
+ */
+BOOST_AUTO_TEST_CASE(simd_lower_bound_test) {
+    std::mt19937 rng(42);
+    for (size_t size: {0, 1, 3, 4, 7, 8, 31, 32, 33, 64, 65, 100, 1000}) {
+        for (const DateTime max: {DateTime(50), DateTimeUtils::inf}) {
+            std::uniform_int_distribution<DateTime> gen(0, max);
+            std::vector<DateTime> times(size);
+            for (auto& t: times) { t = gen(rng); }
+            std::sort(times.begin(), times.end());
+            std::vector<DateTime> values = {0, max};
+            for (const auto t: times) {
+                values.push_back(t);
+                if (t > 0) { values.push_back(t - 1); }
+                if (t < max) { values.push_back(t + 1); }
+            }
+            for (const auto v: values) {
+                const size_t expected = std::lower_bound(times.begin(), times.end(), v) - times.begin();
+                BOOST_CHECK_EQUAL(simd_lower_bound(times.data(), times.size(), v), expected);
+                BOOST_CHECK_EQUAL(scalar_lower_bound(times.data(), times.size(), v), expected);
+                const size_t expected_upper = std::upper_bound(times.begin(), times.end(), v) - times.begin();
+                BOOST_CHECK_EQUAL(simd_upper_bound(times.data(), times.size(), v), expected_upper);
+            }
+        }
+    }
+}
+
+/*
+ * the raptor cache warmup builds the caches of today and tomorrow, for
+ * the base schedule and the realtime, the next requests on those days
+ * are cache hits (the caches being built on 2 threads)
+ */
+BOOST_AUTO_TEST_CASE(cached_next_stop_time_warmup) {
+    ed::builder b("20120614");
+    b.vj("A")("stop1", 8000, 8050)("stop2", 8100, 8150);
+    b.finish();
+    b.data->pt_data->index();
+    b.data->build_uri();
+    b.data->build_raptor();
+
+    auto& manager = *b.data->dataRaptor->cached_next_st_manager;
+    b.data->warmup_raptor_cache("20120615T080000"_dt, 2);
+    auto stats = manager.get_stats();
+    BOOST_CHECK_EQUAL(stats.nb_calls, 4);
+    BOOST_CHECK_EQUAL(stats.nb_cache_miss, 4);
+
+    manager.load(DateTimeUtils::set(1, 9 * 3600), type::RTLevel::Base, type::AccessibiliteParams());
+    manager.load(DateTimeUtils::set(2, 9 * 3600), type::RTLevel::RealTime, type::AccessibiliteParams());
+    stats = manager.get_stats();
+    BOOST_CHECK_EQUAL(stats.nb_calls, 6);
+    BOOST_CHECK_EQUAL(stats.nb_cache_miss, 4);
+
+    manager.load(DateTimeUtils::set(0, 9 * 3600), type::RTLevel::Base, type::AccessibiliteParams());
+    stats = manager.get_stats();
+    BOOST_CHECK_EQUAL(stats.nb_calls, 7);
+    BOOST_CHECK_EQUAL(stats.nb_cache_miss, 5);
+
+    // nothing to warm up outside of the production period
+    b.data->warmup_raptor_cache("20100615T080000"_dt);
+    BOOST_CHECK_EQUAL(manager.get_stats().nb_calls, 7);
+}
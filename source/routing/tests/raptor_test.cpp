@@ -3674,3 +3674,180 @@ BOOST_AUTO_TEST_CASE(allowed_id_line) {
     BOOST_CHECK_EQUAL(res.at(0).items.front().departure, time_from_string("2015-01-03 09:00:00"));
     BOOST_CHECK_EQUAL(res.at(0).items.back().arrival, time_from_string("2015-01-03 13:00:00"));
 }
+
+/*
+ * Only the journey patterns reachable from the improved stop points are
+ * explored in a round, the ones on another part of the network are never visited
+ *
+ *    A ----- B ----- C            D ----- E
+ */
+BOOST_AUTO_TEST_CASE(only_marked_journey_patterns_are_explored) {
+    ed::builder b("20120614");
+    b.vj("l1")("A", 8000, 8000)("B", 8100, 8100);
+    b.vj("l2")("B", 8200, 8200)("C", 8300, 8300);
+    b.vj("l3")("D", 8000, 8000)("E", 8100, 8100);
+
+    b.connection("B", "B", 10);
+    b.data->pt_data->index();
+    b.data->build_uri();
+    b.data->build_raptor();
+    RAPTOR raptor(*(b.data));
+    type::PT_Data& d = *b.data->pt_data;
+    BOOST_REQUIRE_EQUAL(b.data->dataRaptor->jp_container.nb_jps(), 3);
+
+    routing::map_stop_point_duration departs;
+    departs[routing::SpIdx(*d.stop_points_map["A"])] = {};
+
+    raptor.first_raptor_loop(departs, DateTimeUtils::set(0, 7900), nt::RTLevel::Base, DateTimeUtils::inf,
+                             std::numeric_limits<uint32_t>::max(), {}, {}, {}, true);
+
+    BOOST_CHECK_EQUAL(raptor.labels[2].dt_pt(routing::SpIdx(*d.stop_points_map["C"])),
+                      DateTimeUtils::set(0, 8300));
+    // only l1 is explored in the first round
+    BOOST_REQUIRE_GE(raptor.nb_explored_jps_by_round.size(), 2);
+    BOOST_CHECK_EQUAL(raptor.nb_explored_jps_by_round[1], 1);
+    // l3 is never explored
+    for (const auto nb_jps: raptor.nb_explored_jps_by_round) {
+        BOOST_CHECK_LE(nb_jps, 2);
+    }
+}
+
+/*
+ * The second passes run concurrently must give the same journeys as the
+ * sequential ones
+ */
+BOOST_AUTO_TEST_CASE(parallel_second_passes) {
+    ed::builder b("20120614");
+    b.vj("A")("stop1",  8000)("stop3", 11000);
+    b.vj("B")("stop3", 12000)("stop5", 17000);
+    b.vj("C")("stop1",  8000)("stop2", 10000);
+    b.vj("D")("stop2", 11000)("stop4", 13000);
+    b.vj("E")("stop4", 14000)("stop5", 16000);
+    b.vj("F")("stop1",  7000)("stop4", 13000);
+    b.vj("G")("stop1",  9000)("stop6", 15000);
+    b.vj("H")("stop2", 10500)("stop6", 14500);
+    b.connection("stop1", "stop1", 100);
+    b.connection("stop2", "stop2", 100);
+    b.connection("stop3", "stop3", 100);
+    b.connection("stop4", "stop4", 100);
+    b.connection("stop5", "stop5", 100);
+    b.connection("stop6", "stop6", 100);
+
+    b.data->pt_data->index();
+    b.finish();
+    b.data->build_raptor();
+    b.data->build_uri();
+    RAPTOR sequential_raptor(*(b.data));
+    RAPTOR parallel_raptor(*(b.data), 3);
+
+    routing::map_stop_point_duration departures, arrivals;
+    departures[SpIdx(*b.sps["stop1"])] = 0_s;
+    arrivals[SpIdx(*b.sps["stop5"])] = 0_s;
+    arrivals[SpIdx(*b.sps["stop6"])] = 300_s;
+
+    for (const bool clockwise: {true, false}) {
+        const auto dt = clockwise ? DateTimeUtils::set(0, 6000) : DateTimeUtils::set(0, 18000);
+        const auto bound = clockwise ? DateTimeUtils::inf : DateTimeUtils::min;
+        auto expected = sequential_raptor.compute_all(departures, arrivals, dt, type::RTLevel::Base, 2_min,
+                                                      bound, 10, {}, {}, {}, clockwise, boost::none, 10);
+        auto results = parallel_raptor.compute_all(departures, arrivals, dt, type::RTLevel::Base, 2_min,
+                                                   bound, 10, {}, {}, {}, clockwise, boost::none, 10);
+
+        BOOST_REQUIRE(! expected.empty());
+        BOOST_REQUIRE_EQUAL(results.size(), expected.size());
+        const auto to_tuple = [](const Path& p) {
+            return std::make_tuple(p.items.front().departure, p.items.back().arrival, p.nb_changes);
+        };
+        std::vector<std::tuple<bt::ptime, bt::ptime, uint32_t>> expected_tuples, result_tuples;
+        for (const auto& p: expected) { expected_tuples.push_back(to_tuple(p)); }
+        for (const auto& p: results) { result_tuples.push_back(to_tuple(p)); }
+        std::sort(expected_tuples.begin(), expected_tuples.end());
+        std::sort(result_tuples.begin(), result_tuples.end());
+        BOOST_CHECK(expected_tuples == result_tuples);
+    }
+}
+
+/*
+ * The profile query returns all the interesting journeys of the window
+ *
+ * A leaves stop1 at 8000, 9000 and 10000 and arrives 1000s later at stop2
+ * B leaves stop1 at 8500 and arrives at stop2 at 12000: it is never interesting
+ * C leaves stop1 at 9500, and arrives at stop3 at 9600,
+ * D leaves stop3 at 9700 and arrives at stop2 at 9800: C+D leaves after A at 9000
+ * and arrives before it, but with a transfer
+ */
+BOOST_AUTO_TEST_CASE(profile_query) {
+    ed::builder b("20120614");
+    b.vj("A")("stop1", 8000, 8000)("stop2", 9000, 9000);
+    b.vj("A")("stop1", 9000, 9000)("stop2", 10000, 10000);
+    b.vj("A")("stop1", 10000, 10000)("stop2", 11000, 11000);
+    b.vj("B")("stop1", 8500, 8500)("stop2", 12000, 12000);
+    b.vj("C")("stop1", 9500, 9500)("stop3", 9600, 9600);
+    b.vj("D")("stop3", 9700, 9700)("stop2", 9800, 9800);
+    b.connection("stop1", "stop1", 10);
+    b.connection("stop2", "stop2", 10);
+    b.connection("stop3", "stop3", 10);
+    b.data->pt_data->index();
+    b.finish();
+    b.data->build_raptor();
+    b.data->build_uri();
+    RAPTOR raptor(*(b.data));
+
+    routing::map_stop_point_duration departures, arrivals;
+    departures[SpIdx(*b.sps["stop1"])] = 0_s;
+    arrivals[SpIdx(*b.sps["stop2"])] = 0_s;
+
+    auto res = raptor.compute_profile(departures, arrivals, DateTimeUtils::set(0, 7900),
+                                      DateTimeUtils::set(0, 9600), type::RTLevel::Base, 2_min);
+
+    BOOST_REQUIRE_EQUAL(res.size(), 3);
+    BOOST_CHECK_EQUAL(res[0].items.front().departure, to_posix_time(8000, *b.data));
+    BOOST_CHECK_EQUAL(res[0].items.back().arrival, to_posix_time(9000, *b.data));
+    BOOST_CHECK_EQUAL(res[0].nb_changes, 0);
+    BOOST_CHECK_EQUAL(res[1].items.front().departure, to_posix_time(9000, *b.data));
+    BOOST_CHECK_EQUAL(res[1].items.back().arrival, to_posix_time(10000, *b.data));
+    BOOST_CHECK_EQUAL(res[1].nb_changes, 0);
+    BOOST_CHECK_EQUAL(res[2].items.front().departure, to_posix_time(9500, *b.data));
+    BOOST_CHECK_EQUAL(res[2].items.back().arrival, to_posix_time(9800, *b.data));
+    BOOST_CHECK_EQUAL(res[2].nb_changes, 1);
+}
+
+/*
+ * The profile query drops the journeys lasting more than max_duration
+ * and the ones dominated by the direct path, as compute_all does
+ *
+ * A leaves stop1 at 8000 and 9000 and arrives 1000s later at stop2
+ * C leaves stop1 at 9500 and arrives at stop2 at 9800
+ */
+BOOST_AUTO_TEST_CASE(profile_query_pruning) {
+    ed::builder b("20120614");
+    b.vj("A")("stop1", 8000, 8000)("stop2", 9000, 9000);
+    b.vj("A")("stop1", 9000, 9000)("stop2", 10000, 10000);
+    b.vj("C")("stop1", 9500, 9500)("stop2", 9800, 9800);
+    b.connection("stop1", "stop1", 10);
+    b.connection("stop2", "stop2", 10);
+    b.data->pt_data->index();
+    b.finish();
+    b.data->build_raptor();
+    b.data->build_uri();
+    RAPTOR raptor(*(b.data));
+
+    routing::map_stop_point_duration departures, arrivals;
+    departures[SpIdx(*b.sps["stop1"])] = 0_s;
+    arrivals[SpIdx(*b.sps["stop2"])] = 0_s;
+
+    // the journeys with A last 1000s
+    auto res = raptor.compute_profile(departures, arrivals, DateTimeUtils::set(0, 7900),
+                                      DateTimeUtils::set(0, 9600), type::RTLevel::Base, 2_min,
+                                      10, type::AccessibiliteParams(), {}, {}, 500);
+    BOOST_REQUIRE_EQUAL(res.size(), 1);
+    BOOST_CHECK_EQUAL(res[0].items.front().departure, to_posix_time(9500, *b.data));
+    BOOST_CHECK_EQUAL(res[0].items.back().arrival, to_posix_time(9800, *b.data));
+
+    // walking 200s is better than the journeys with A and C
+    res = raptor.compute_profile(departures, arrivals, DateTimeUtils::set(0, 7900),
+                                 DateTimeUtils::set(0, 9600), type::RTLevel::Base, 2_min,
+                                 10, type::AccessibiliteParams(), {}, {},
+                                 std::numeric_limits<uint32_t>::max(), 200_s);
+    BOOST_CHECK_EQUAL(res.size(), 0);
+}
@@ -960,6 +960,43 @@ BOOST_FIXTURE_TEST_CASE(walking_test, streetnetworkmode_fixture<test_speed_provi
 
 }
 
+/*
+ * the journeys are the same when the stop points around the departure and
+ * the arrival are searched on two threads
+ */
+BOOST_FIXTURE_TEST_CASE(concurrent_fallbacks, streetnetworkmode_fixture<test_speed_provider>) {
+    for (auto* ep: {&origin, &destination}) {
+        ep->streetnetwork_params.mode = navitia::type::Mode_e::Walking;
+        ep->streetnetwork_params.offset = 0;
+        ep->streetnetwork_params.speed_factor = 1;
+        ep->streetnetwork_params.max_duration = navitia::seconds(15*60);
+    }
+
+    const pbnavitia::Response resp = make_response();
+    BOOST_REQUIRE_EQUAL(resp.journeys_size(), 2);
+
+    ng::StreetNetwork concurrent_sn_worker(*b.data->geo_ref, nullptr, true);
+    nr::RAPTOR raptor(*b.data);
+    navitia::PbCreator pb_creator(b.data.get(), boost::gregorian::not_a_date_time, null_time_period);
+    nr::make_response(pb_creator, raptor, origin, destination, datetimes,
+                      true, navitia::type::AccessibiliteParams(),
+                      forbidden, {}, concurrent_sn_worker, nt::RTLevel::Base, 2_min);
+    const auto concurrent_resp = pb_creator.get_response();
+
+    BOOST_REQUIRE_EQUAL(concurrent_resp.journeys_size(), resp.journeys_size());
+    for (int i = 0; i < resp.journeys_size(); ++i) {
+        const auto& journey = resp.journeys(i);
+        const auto& concurrent_journey = concurrent_resp.journeys(i);
+        BOOST_CHECK_EQUAL(concurrent_journey.departure_date_time(), journey.departure_date_time());
+        BOOST_CHECK_EQUAL(concurrent_journey.arrival_date_time(), journey.arrival_date_time());
+        BOOST_REQUIRE_EQUAL(concurrent_journey.sections_size(), journey.sections_size());
+        for (int s = 0; s < journey.sections_size(); ++s) {
+            BOOST_CHECK_EQUAL(concurrent_journey.sections(s).type(), journey.sections(s).type());
+            BOOST_CHECK_EQUAL(concurrent_journey.sections(s).duration(), journey.sections(s).duration());
+        }
+    }
+}
+
 //biking
 BOOST_FIXTURE_TEST_CASE(biking, streetnetworkmode_fixture<test_speed_provider>) {
     origin.streetnetwork_params.mode = navitia::type::Mode_e::Bike;
@@ -1710,10 +1747,11 @@ BOOST_AUTO_TEST_CASE(projection_on_one_way) {
 
     ed::builder b = {"20120614"};
 
-    boost::add_vertex(ng::Vertex(A),b.data->geo_ref->graph);
-    boost::add_vertex(ng::Vertex(B),b.data->geo_ref->graph);
-    boost::add_vertex(ng::Vertex(C),b.data->geo_ref->graph);
-    boost::add_vertex(ng::Vertex(D),b.data->geo_ref->graph);
+    auto& graph = ng::mutable_part(b.data->geo_ref->graph);
+    boost::add_vertex(ng::Vertex(A), graph);
+    boost::add_vertex(ng::Vertex(B), graph);
+    boost::add_vertex(ng::Vertex(C), graph);
+    boost::add_vertex(ng::Vertex(D), graph);
     b.data->geo_ref->init();
 
     size_t way_idx = 0;
@@ -1727,11 +1765,11 @@ BOOST_AUTO_TEST_CASE(projection_on_one_way) {
 
     size_t e_idx(0);
     //we add each edge as a one way street
-    boost::add_edge(BB, AA, ng::Edge(e_idx++, navitia::seconds(10)), b.data->geo_ref->graph);
+    boost::add_edge(BB, AA, ng::Edge(e_idx++, navitia::seconds(10)), graph);
     //B->C is very cheap but will not be used
-    boost::add_edge(BB, CC, ng::Edge(e_idx++, navitia::seconds(1)), b.data->geo_ref->graph);
-    boost::add_edge(AA, CC, ng::Edge(e_idx++, navitia::seconds(1000)), b.data->geo_ref->graph);
-    boost::add_edge(CC, DD, ng::Edge(e_idx++, navitia::seconds(10)), b.data->geo_ref->graph);
+    boost::add_edge(BB, CC, ng::Edge(e_idx++, navitia::seconds(1)), graph);
+    boost::add_edge(AA, CC, ng::Edge(e_idx++, navitia::seconds(1000)), graph);
+    boost::add_edge(CC, DD, ng::Edge(e_idx++, navitia::seconds(10)), graph);
 
     b.data->geo_ref->ways[0]->edges.push_back(std::make_pair(BB, AA));
     b.data->geo_ref->ways[1]->edges.push_back(std::make_pair(BB, CC));
@@ -1759,7 +1797,7 @@ BOOST_AUTO_TEST_CASE(projection_on_one_way) {
                                                                   7_days);
 
     //first we want to check that the projection is done on A->B (the whole point of this test)
-    auto starting_edge = ng::ProjectionData(start, *b.data->geo_ref, 0, b.data->geo_ref->pl);
+    auto starting_edge = ng::ProjectionData(start, *b.data->geo_ref, 0, *b.data->geo_ref->pl);
     BOOST_REQUIRE(starting_edge.found);
 
     BOOST_CHECK_EQUAL(starting_edge.vertices[ng::ProjectionData::Direction::Target], AA);
@@ -142,19 +142,20 @@ struct routing_api_data {
                                 D(  0,  30)   12
         */
 
-        boost::add_vertex(navitia::georef::Vertex(A),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(G),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(H),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(I),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(J),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(K),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(B),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(C),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(F),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(E),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(R),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(S),b.data->geo_ref->graph);
-        boost::add_vertex(navitia::georef::Vertex(D),b.data->geo_ref->graph);
+        auto& graph = navitia::georef::mutable_part(b.data->geo_ref->graph);
+        boost::add_vertex(navitia::georef::Vertex(A), graph);
+        boost::add_vertex(navitia::georef::Vertex(G), graph);
+        boost::add_vertex(navitia::georef::Vertex(H), graph);
+        boost::add_vertex(navitia::georef::Vertex(I), graph);
+        boost::add_vertex(navitia::georef::Vertex(J), graph);
+        boost::add_vertex(navitia::georef::Vertex(K), graph);
+        boost::add_vertex(navitia::georef::Vertex(B), graph);
+        boost::add_vertex(navitia::georef::Vertex(C), graph);
+        boost::add_vertex(navitia::georef::Vertex(F), graph);
+        boost::add_vertex(navitia::georef::Vertex(E), graph);
+        boost::add_vertex(navitia::georef::Vertex(R), graph);
+        boost::add_vertex(navitia::georef::Vertex(S), graph);
+        boost::add_vertex(navitia::georef::Vertex(D), graph);
 
         b.data->geo_ref->init();
 
@@ -502,14 +503,15 @@ struct routing_api_data {
     }
 
     void add_edges(int edge_idx, navitia::georef::GeoRef& geo_ref, int idx_from, int idx_to, float dist, navitia::type::Mode_e mode) {
+        auto& graph = navitia::georef::mutable_part(geo_ref.graph);
         boost::add_edge(idx_from + geo_ref.offsets[mode],
                         idx_to + geo_ref.offsets[mode],
                         navitia::georef::Edge(edge_idx, to_duration(dist, mode)),
-                        geo_ref.graph);
+                        graph);
         boost::add_edge(idx_to + geo_ref.offsets[mode],
                         idx_from + geo_ref.offsets[mode],
                         navitia::georef::Edge(edge_idx, to_duration(dist, mode)),
-                        geo_ref.graph);
+                        graph);
     }
     void add_edges(int edge_idx, navitia::georef::GeoRef& geo_ref, int idx_from, int idx_to,
                    const navitia::type::GeographicalCoord& a, const navitia::type::GeographicalCoord& b, navitia::type::Mode_e mode) {
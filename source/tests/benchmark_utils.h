@@ -0,0 +1,110 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+  
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+ 
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+  
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+   
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+   
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+  
+Stay tuned using
+twitter @navitia 
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/data.h"
+#include "utils/timer.h"
+#include "utils/init.h"
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <string>
+
+/*
+ * What the benchmarks share: the command line, the load of the data and
+ * the measure of the time
+ */
+namespace navitia { namespace benchmark {
+
+using Clock = std::chrono::steady_clock;
+
+inline double elapsed_us(const Clock::time_point& begin) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count() / 1000.;
+}
+
+inline double elapsed_ms(const Clock::time_point& begin) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count() / 1000.;
+}
+
+/// always the same seed: two runs of a benchmark do the same requests
+inline std::mt19937 make_rng() {
+    return std::mt19937(31442);
+}
+
+/*
+ * Command line of a benchmark: --help, the options of the benchmark, added
+ * with add_options(), and --file, the path of the data
+ */
+struct CommandLine {
+    boost::program_options::options_description desc;
+    std::string file;
+    std::string file_help = "Path to data.nav.lz4";
+    /// if true, file has no default and is empty if not given
+    bool optional_file = false;
+
+    explicit CommandLine(const std::string& caption): desc(caption) {
+        desc.add_options()("help", "Show this message");
+    }
+
+    boost::program_options::options_description_easy_init add_options() {
+        return desc.add_options();
+    }
+
+    /// Initialize the logs and parse the command line, false if the help
+    /// has been asked: it is printed and the benchmark has to stop
+    bool parse(int argc, char** argv) {
+        namespace po = boost::program_options;
+        navitia::init_app();
+        if (optional_file) {
+            desc.add_options()("file,f", po::value<std::string>(&file), file_help.c_str());
+        } else {
+            desc.add_options()("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"),
+                               file_help.c_str());
+        }
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+inline void load_data(type::Data& data, const std::string& file) {
+    Timer t("Chargement des données : " + file);
+    data.load(file);
+}
+
+}} // namespace navitia::benchmark
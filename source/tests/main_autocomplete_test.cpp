@@ -73,16 +73,17 @@ int main(int argc, const char* const argv[]) {
     b.sa("MPT kerfeunteun", 0, 0);
     b.data->pt_data->index();
 
-    boost::add_vertex(navitia::georef::Vertex(100, 80, false), b.data->geo_ref->graph);
-    boost::add_vertex(navitia::georef::Vertex(110, 80, false), b.data->geo_ref->graph);
-    boost::add_vertex(navitia::georef::Vertex(120, 80, false), b.data->geo_ref->graph);
-    boost::add_vertex(navitia::georef::Vertex(130, 80, false), b.data->geo_ref->graph);
+    auto& graph = navitia::georef::mutable_part(b.data->geo_ref->graph);
+    boost::add_vertex(navitia::georef::Vertex(100, 80, false), graph);
+    boost::add_vertex(navitia::georef::Vertex(110, 80, false), graph);
+    boost::add_vertex(navitia::georef::Vertex(120, 80, false), graph);
+    boost::add_vertex(navitia::georef::Vertex(130, 80, false), graph);
 
     size_t e_idx = 0;
-    boost::add_edge(0, 1, navitia::georef::Edge(e_idx++, 1_s), b.data->geo_ref->graph);
-    boost::add_edge(1, 2, navitia::georef::Edge(e_idx++, 1_s), b.data->geo_ref->graph);
-    boost::add_edge(2, 3, navitia::georef::Edge(e_idx++, 1_s), b.data->geo_ref->graph);
-    boost::add_edge(3, 4, navitia::georef::Edge(e_idx++, 1_s), b.data->geo_ref->graph);
+    boost::add_edge(0, 1, navitia::georef::Edge(e_idx++, 1_s), graph);
+    boost::add_edge(1, 2, navitia::georef::Edge(e_idx++, 1_s), graph);
+    boost::add_edge(2, 3, navitia::georef::Edge(e_idx++, 1_s), graph);
+    boost::add_edge(3, 4, navitia::georef::Edge(e_idx++, 1_s), graph);
 
     auto* w = new Way;
     w->idx = 0;
@@ -34,6 +34,9 @@ www.navitia.io
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/counter.hpp>
+#include <boost/iostreams/copy.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
@@ -43,6 +46,9 @@ www.navitia.io
 #include <boost/range/algorithm/find.hpp>
 #include <boost/container/container_fwd.hpp>
 #include <thread>
+#include <algorithm>
+#include <functional>
+#include <exception>
 
 #include "third_party/eos_portable_archive/portable_iarchive.hpp"
 #include "third_party/eos_portable_archive/portable_oarchive.hpp"
@@ -54,8 +60,10 @@ www.navitia.io
 #include "pt_data.h"
 #include "routing/dataraptor.h"
 #include "georef/georef.h"
+#include "georef/street_network.h"
 #include "fare/fare.h"
 #include "type/meta_data.h"
+#include "type/thread_pool.h"
 #include "kraken/fill_disruption_from_database.h"
 
 namespace pt = boost::posix_time;
@@ -64,7 +72,7 @@ namespace navitia { namespace type {
 
 wrong_version::~wrong_version() noexcept {}
 
-const unsigned int Data::data_version = 64; //< *INCREMENT* every time serialized data are modified
+const unsigned int Data::data_version = 71; //< *INCREMENT* every time serialized data are modified
 
 Data::Data(size_t data_identifier) :
     data_identifier(data_identifier),
@@ -72,7 +80,7 @@ Data::Data(size_t data_identifier) :
     pt_data(std::make_unique<PT_Data>()),
     geo_ref(std::make_unique<navitia::georef::GeoRef>()),
     dataRaptor(std::make_unique<navitia::routing::dataRAPTOR>()),
-    fare(std::make_unique<navitia::fare::Fare>()),
+    fare(boost::make_shared<navitia::fare::Fare>()),
     find_admins(
             [&](const GeographicalCoord &c){
             return geo_ref->find_admins(c);
@@ -87,13 +95,24 @@ Data::~Data(){}
 
 bool Data::load(const std::string& filename,
         const boost::optional<std::string>& chaos_database,
-        const std::vector<std::string>& contributors) {
+        const LoadOptions& options) {
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     loading = true;
     try {
         std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
         ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        this->load(ifs);
+        load_durations.clear();
+        const auto run_stage = [&](const std::string& name, const std::function<void()>& stage) {
+            const auto begin = pt::microsec_clock::universal_time();
+            stage();
+            const auto duration = (pt::microsec_clock::universal_time() - begin).total_milliseconds();
+            LOG4CPLUS_INFO(logger, "load stage " << name << " done in " << duration << "ms");
+            load_durations.emplace_back(name, duration);
+        };
+        run_stage("deserialize", [&]() { this->load(ifs); });
+        run_stage("build_goal_directed_search", [&]() {
+            geo_ref->build_goal_directed_search(options.direct_path_params);
+        });
         last_load_at = pt::microsec_clock::universal_time();
         last_load = true;
         loaded = true;
@@ -103,9 +122,24 @@ bool Data::load(const std::string& filename,
                        % pt_data->stop_points.size()
             );
         if (chaos_database) {
-            fill_disruption_from_database(*chaos_database, *pt_data, *meta, contributors);
+            run_stage("fill_disruptions", [&]() {
+                fill_disruption_from_database(*chaos_database, *pt_data, *meta, options.contributors);
+            });
+        }
+        run_stage("build_raptor", [&]() { build_raptor(); });
+        for (const auto& stage: dataRaptor->load_durations) {
+            LOG4CPLUS_INFO(logger, "load stage raptor_" << stage.first << " done in " << stage.second << "ms");
+            load_durations.emplace_back("raptor_" + stage.first, stage.second);
         }
-        build_raptor();
+        run_stage("warmup_raptor_cache", [&]() {
+            warmup_raptor_cache(pt::microsec_clock::universal_time(), options.nb_threads);
+        });
+        run_stage("build_stop_point_duration_cache", [&]() {
+            build_stop_point_duration_cache(options.stop_point_duration_cache_size);
+        });
+        run_stage("warmup_stop_point_duration_cache", [&]() {
+            warmup_stop_point_duration_cache(options.stop_point_duration_cache_warmup, options.nb_threads);
+        });
     } catch(const wrong_version& ex) {
         LOG4CPLUS_ERROR(logger, "Cannot load data: " << ex.what());
         last_load = false;
@@ -120,12 +154,49 @@ bool Data::load(const std::string& filename,
     return this->last_load;
 }
 
+namespace {
+struct Pipe {
+    threadbuf sbuf;
+    std::ostream out;
+    std::istream in;
+    Pipe(): out(&sbuf), in(&sbuf) {}
+    Pipe(const Pipe&) = delete;
+    Pipe& operator=(const Pipe&) = delete;
+    ~Pipe() {sbuf.close();}
+};
+} // anonymous namespace
+
+// The lz4 decompression and the deserialization are done in 2
+// threads connected by a pipe, the deserialization being the longest
+// one, the decompression is almost free.
 void Data::load(std::istream& ifs) {
-    boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
-    in.push(LZ4Decompressor(2048*500),8192*500, 8192*500);
-    in.push(ifs);
-    eos::portable_iarchive ia(in);
-    ia >> *this;
+    Pipe p;
+    std::exception_ptr decompression_error;
+    std::thread decompress([&]() {
+        try {
+            boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
+            in.push(LZ4Decompressor(2048*500), 8192*500, 8192*500);
+            in.push(ifs);
+            boost::iostreams::copy(in, p.out, 8192*500);
+        } catch (...) {
+            decompression_error = std::current_exception();
+        }
+        p.sbuf.close();
+    });
+    try {
+        eos::portable_iarchive ia(p.in);
+        ia >> *this;
+    } catch (...) {
+        // unblocks the decompression if it is waiting on a full pipe
+        p.sbuf.close();
+        decompress.join();
+        // an error of the decompression is the cause of the
+        // deserialization one
+        if (decompression_error) { std::rethrow_exception(decompression_error); }
+        throw;
+    }
+    decompress.join();
+    if (decompression_error) { std::rethrow_exception(decompression_error); }
 }
 
 
@@ -242,9 +313,9 @@ void  Data::build_administrative_regions() {
                 admin->main_stop_areas.push_back(sa);
 }
 
-void Data::build_autocomplete(){
-    pt_data->build_autocomplete(*geo_ref);
-    geo_ref->build_autocomplete_list();
+void Data::build_autocomplete(size_t nb_threads){
+    pt_data->build_autocomplete(*geo_ref, nb_threads);
+    geo_ref->build_autocomplete_list(nb_threads);
     pt_data->compute_score_autocomplete(*geo_ref);
 }
 
@@ -256,6 +327,74 @@ void Data::build_raptor(size_t cache_size) {
                     "Finished to build dataRaptor");
 }
 
+void Data::build_raptor(const Data& cloned_from, size_t cache_size) {
+    LOG4CPLUS_DEBUG(log4cplus::Logger::getInstance("log"),
+                    "Start to update dataRaptor");
+    dataRaptor->update(*this->pt_data, *cloned_from.dataRaptor, cache_size);
+    LOG4CPLUS_DEBUG(log4cplus::Logger::getInstance("log"),
+                    "Finished to update dataRaptor");
+}
+
+void Data::warmup_raptor_cache(const pt::ptime& now, size_t nb_threads) {
+    const auto& production_date = meta->production_date;
+    if (now.date() < production_date.begin() || now.date() > production_date.last()) {
+        return;
+    }
+    const auto today = DateTimeUtils::date(to_datetime(now, *this));
+    const auto nb_days = size_t(production_date.length().days());
+    std::vector<routing::CachedNextStopTimeKey> keys;
+    for (const auto day: {today, today + 1}) {
+        if (day >= nb_days) { continue; }
+        for (const auto rt_level: {RTLevel::Base, RTLevel::RealTime}) {
+            keys.emplace_back(day, rt_level, AccessibiliteParams());
+        }
+    }
+    auto logger = log4cplus::Logger::getInstance("log");
+    LOG4CPLUS_DEBUG(logger, "Start to warm up the raptor cache");
+    dataRaptor->cached_next_st_manager->warmup(keys, nb_threads);
+    LOG4CPLUS_DEBUG(logger, "Finished to warm up the raptor cache");
+}
+
+void Data::build_stop_point_duration_cache(size_t max_nb_durations) {
+    if (max_nb_durations == 0) {
+        stop_point_duration_cache.reset();
+        return;
+    }
+    stop_point_duration_cache = std::make_unique<georef::StopPointDurationCache>(max_nb_durations);
+}
+
+void Data::warmup_stop_point_duration_cache(const navitia::time_duration& radius, size_t nb_threads) const {
+    if (! stop_point_duration_cache || radius <= navitia::seconds(0)) {
+        return;
+    }
+    std::vector<GeographicalCoord> coords;
+    for (const auto* stop_area: pt_data->stop_areas) {
+        coords.push_back(stop_area->coord);
+    }
+    for (const auto* poi: geo_ref->pois) {
+        coords.push_back(poi->coord);
+    }
+
+    // the entry points are shared between the threads, the stop areas first
+    std::atomic<size_t> next_coord{0};
+    const auto warmup = [&](size_t) {
+        georef::PathFinder path_finder(*geo_ref, stop_point_duration_cache.get());
+        for (size_t i = next_coord++; i < coords.size(); i = next_coord++) {
+            // once full, warming up would only drop what has been warmed up
+            if (stop_point_duration_cache->get_stats().nb_dropped > 0) {
+                return;
+            }
+            path_finder.init(coords[i], Mode_e::Walking, 1.);
+            path_finder.find_nearest_stop_points(radius, pt_data->stop_point_proximity_list);
+        }
+    };
+    ThreadPool pool(nb_threads);
+    pool.run(pool.nb_threads(), warmup);
+    const auto stats = stop_point_duration_cache->get_stats();
+    LOG4CPLUS_INFO(log4cplus::Logger::getInstance("log"), "stop point duration cache warmed up with "
+                   << stats.nb_durations << " durations in " << stats.nb_cache_miss << " searches");
+}
+
 ValidityPattern* Data::get_similar_validity_pattern(ValidityPattern* vp) const{
     auto find_vp_predicate = [&](ValidityPattern* vp1) { return ((*vp) == (*vp1));};
     auto it = std::find_if(this->pt_data->validity_patterns.begin(),
@@ -303,7 +442,7 @@ find_matching_calendar(const Data&, const std::string& name, const ValidityPatte
     return res;
 }
 
-void Data::complete(){
+void Data::complete(size_t nb_autocomplete_threads){
     auto logger = log4cplus::Logger::getInstance("log");
     pt::ptime start;
     int admin, sort, autocomplete;
@@ -332,7 +471,7 @@ void Data::complete(){
     LOG4CPLUS_INFO(logger, "Building uri maps");
     build_uri();
     LOG4CPLUS_INFO(logger, "Building autocomplete");
-    build_autocomplete();
+    build_autocomplete(nb_autocomplete_threads);
     autocomplete = (pt::microsec_clock::local_time() - start).total_milliseconds();
 
     LOG4CPLUS_INFO(logger, "\t Building admins: " << admin << "ms");
@@ -643,13 +782,29 @@ Indexes Data::get_all_index(Type_e type) const {
 Indexes
 Data::get_target_by_source(Type_e source, Type_e target,
                            Indexes source_idx) const {
-    Indexes result;
-    result.reserve(source_idx.size());
+    // merging each target list in the flat_set is quadratic, thus we
+    // collect all the targets and sort them only once
+    std::vector<idx_t> targets;
+    targets.reserve(source_idx.size());
     for(idx_t idx : source_idx) {
-        Indexes tmp = get_target_by_one_source(source, target, idx);
-        // TODO: Use flat_set's merge when we pass to boost 1.62
-        result.insert(boost::container::ordered_unique_range_t(),
-                      tmp.begin(), tmp.end());
+        const Indexes tmp = get_target_by_one_source(source, target, idx);
+        targets.insert(targets.end(), tmp.begin(), tmp.end());
+    }
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    Indexes result;
+    result.insert(boost::container::ordered_unique_range_t(), targets.begin(), targets.end());
+    return result;
+}
+
+IndexesBitset
+Data::get_target_by_source(Type_e source, Type_e target,
+                           const IndexesBitset& source_idx) const {
+    IndexesBitset result(get_nb_obj(target));
+    for (auto idx = source_idx.find_first(); idx != IndexesBitset::npos; idx = source_idx.find_next(idx)) {
+        for (const idx_t target_idx: get_target_by_one_source(source, target, idx)) {
+            if (target_idx < result.size()) { result.set(target_idx); }
+        }
     }
     return result;
 }
@@ -765,20 +920,18 @@ Type_e Data::get_type_of_id(const std::string & id) const {
     return Type_e::Unknown;
 }
 
-namespace {
-struct Pipe {
-    threadbuf sbuf;
-    std::ostream out;
-    std::istream in;
-    Pipe(): out(&sbuf), in(&sbuf) {}
-    Pipe(const Pipe&) = delete;
-    Pipe& operator=(const Pipe&) = delete;
-    ~Pipe() {sbuf.close();}
-};
-} // anonymous namespace
+// The members of the Data that have to go through the same archive to
+// keep the pointers between them consistent.  Templated on the Data to
+// be used for both the const source and the cloned Data.
+template<typename Archive, typename D>
+static void serialize_for_clone(Archive& ar, D& data) {
+    ar & data.pt_data & data.meta & data.last_load_at & data.loaded & data.last_load
+       & data.is_connected_to_rabbitmq & data.is_realtime_loaded;
+    data.geo_ref->serialize_linked(ar);
+}
 
-// We want to do a deep clone of a Data.  The problem is that there is a
-// lot of pointers that point to each other, and thus writing a copy
+// We want to clone a Data.  The problem is that there is a lot of
+// pointers that point to each other, and thus writing a copy
 // assignment operator is really tricky.
 //
 // But we already have a framework that allow this deep clone: boost
@@ -787,11 +940,36 @@ struct Pipe {
 // stream the source object in a binary_oarchive, and then stream it
 // in our object.  To avoid having the whole binary_oarchive in
 // memory, we construct a pipe between 2 threads.
-void Data::clone_from(const Data& from) {
+//
+// Only the objects linked by pointers to the public transport objects
+// go through this pipe: the street network graph and the indexes are
+// plain values that are directly copied, and the fare, never modified
+// by the realtime, is shared between the generations of Data.
+size_t Data::clone_from(const Data& from) {
     Pipe p;
-    std::thread write([&]() {boost::archive::binary_oarchive oa(p.out); oa << from;});
-    { boost::archive::binary_iarchive ia(p.in); ia >> *this; }
+    size_t nb_bytes = 0;
+    std::thread write([&]() {
+        boost::iostreams::filtering_ostream out;
+        out.push(boost::iostreams::counter());
+        out.push(p.out);
+        {
+            boost::archive::binary_oarchive oa(out);
+            serialize_for_clone(oa, from);
+        }
+        out.flush();
+        nb_bytes = out.component<boost::iostreams::counter>(0)->characters();
+    });
+    {
+        boost::archive::binary_iarchive ia(p.in);
+        serialize_for_clone(ia, *this);
+    }
+    geo_ref->copy_unlinked_from(*from.geo_ref);
+    fare = from.fare;
+    load_durations = from.load_durations;
     write.join();
+    LOG4CPLUS_INFO(log4cplus::Logger::getInstance("log"),
+                   "Data cloned: " << nb_bytes << " bytes serialized");
+    return nb_bytes;
 }
 
 }} //namespace navitia::type
@@ -34,12 +34,15 @@ www.navitia.io
 #include <boost/serialization/version.hpp>
 #include <boost/format.hpp>
 #include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/serialization/shared_ptr.hpp>
 #include <atomic>
 #include "type/type.h"
 #include "utils/serialization_unique_ptr.h"
 #include "utils/serialization_atomic.h"
 #include "utils/exception.h"
 #include "utils/obj_factory.h"
+#include "georef/goal_directed_search.h"
 
 //forward declare
 namespace navitia {
@@ -47,6 +50,7 @@ namespace navitia {
         struct GeoRef;
         struct POI;
         struct POIType;
+        class StopPointDurationCache;
     }
     namespace fare {
         struct Fare;
@@ -120,6 +124,19 @@ struct ContainerTrait<type::MetaVehicleJourney> {
     typedef vect_type associative_type;
 };
 
+/// What Data::load builds besides the deserialized data
+struct LoadOptions {
+    /// only the disruptions of those contributors are read from the chaos database
+    std::vector<std::string> contributors;
+    /// 0 to not build the stop point duration cache
+    size_t stop_point_duration_cache_size = 0;
+    /// radius of the durations put in the stop point duration cache at load
+    navitia::time_duration stop_point_duration_cache_warmup;
+    georef::DirectPathParams direct_path_params;
+    /// number of threads warming up the caches
+    size_t nb_threads = 1;
+};
+
 /** Contient toutes les données théoriques du référentiel transport en communs
   *
   * Il existe trois formats de stockage : texte, binaire, binaire compressé
@@ -128,6 +145,8 @@ struct ContainerTrait<type::MetaVehicleJourney> {
   */
 class Data : boost::noncopyable{
 public:
+    /// the options of load, named for the DataManager
+    typedef navitia::type::LoadOptions LoadOptions;
 
     static const unsigned int data_version; //< Data version number. *INCREMENT* in cpp file
     unsigned int version = 0; //< Version of loaded data
@@ -147,8 +166,14 @@ public:
     /// precomputed data for raptor (public transport routing algorithm)
     std::unique_ptr<navitia::routing::dataRAPTOR> dataRaptor;
 
+    /// durations from the street network to the stop points, shared by the
+    /// workers, built by load unless its size is 0 (the default size of
+    /// kraken's GENERAL.sp_duration_cache_size is 2000000 durations)
+    std::unique_ptr<navitia::georef::StopPointDurationCache> stop_point_duration_cache;
+
     /// Fare data
-    std::unique_ptr<navitia::fare::Fare> fare;
+    /// it is never modified by the realtime, so it is shared between a Data and its clones
+    boost::shared_ptr<navitia::fare::Fare> fare;
 
     // functor to find admins
     std::function<std::vector<georef::Admin*>(const GeographicalCoord&)> find_admins;
@@ -180,6 +205,11 @@ public:
       */
     Indexes get_target_by_source(Type_e source, Type_e target, Indexes source_idx) const;
 
+    /** Même chose avec des ensembles denses d'indexes : le résultat a autant
+      * de bits qu'il y a d'objets de type target
+      */
+    IndexesBitset get_target_by_source(Type_e source, Type_e target, const IndexesBitset& source_idx) const;
+
     /** Étant donné un index pointant vers source,
       * retourne une liste d'indexes pointant vers target
       */
@@ -189,6 +219,8 @@ public:
     bool last_load = true;
     // UTC
     boost::posix_time::ptime last_load_at;
+    // duration in milliseconds of each stage of the last load
+    std::vector<std::pair<std::string, uint64_t>> load_durations;
 
     boost::posix_time::ptime last_rt_data_loaded; //datetime of the last Real Time loaded data
 
@@ -223,7 +255,7 @@ public:
     /** Charge les données et effectue les initialisations nécessaires */
     bool load(const std::string & filename,
             const boost::optional<std::string>& chaos_database = {},
-            const std::vector<std::string>& contributors = {});
+            const LoadOptions& options = LoadOptions());
 
     /** Sauvegarde les données */
     void save(const std::string & filename) const;
@@ -231,8 +263,8 @@ public:
     /** Construit l'indexe ExternelCode */
     void build_uri();
 
-    /** Construit l'indexe Autocomplete */
-    void build_autocomplete();
+    /** Construit l'indexe Autocomplete, les chaînes étant découpées sur nb_threads threads */
+    void build_autocomplete(size_t nb_threads = 1);
 
 
     /** Construit l'indexe ProximityList */
@@ -242,6 +274,27 @@ public:
     /** Construit les données raptor */
     void build_raptor(size_t cache_size = 10);
 
+    /** Build the raptor data from the ones of the Data this one has
+      * been cloned from, only recomputing what has been modified by the
+      * realtime since the clone */
+    void build_raptor(const Data& cloned_from, size_t cache_size = 10);
+
+    /** Build the raptor caches of the day of now and of the next day,
+      * for the base schedule and the realtime, without accessibility
+      * constraints, so that the first requests don't wait for them, on at
+      * most nb_threads threads */
+    void warmup_raptor_cache(const boost::posix_time::ptime& now, size_t nb_threads = 1);
+
+    /** Build an empty cache of the durations from the street network to
+      * the stop points, storing at most max_nb_durations durations (0
+      * means no cache) */
+    void build_stop_point_duration_cache(size_t max_nb_durations);
+
+    /** Fill the stop point duration cache with the walking durations
+      * (at the default speed) from the stop areas and the POIs within the
+      * radius, until the cache is full, on nb_threads threads */
+    void warmup_stop_point_duration_cache(const navitia::time_duration& radius, size_t nb_threads = 1) const;
+
     void build_associated_calendar();
 
     void aggregate_odt();
@@ -249,7 +302,8 @@ public:
 
     void build_grid_validity_pattern();
 
-    void complete();
+    /// the autocomplete indexes are built on nb_autocomplete_threads threads
+    void complete(size_t nb_autocomplete_threads = 1);
 
     /** For some pt object we compute the label */
     void compute_labels();
@@ -268,8 +322,15 @@ public:
     /** Sauvegarde les données en binaire compressé avec LZ4*/
     void save(std::ostream& ifs) const;
 
-    // Deep clone from the given Data.
-    void clone_from(const Data&);
+    /** Clone from the given Data.
+      *
+      * The objects modified by the realtime (PT_Data, meta, the georef
+      * objects linked to it) are deep cloned, the others are either
+      * shared (fare) or directly copied (street network graph and indexes).
+      *
+      * Return the number of bytes that went through the serialization.
+      */
+    size_t clone_from(const Data&);
 private:
     /** Get similar validitypattern **/
     ValidityPattern* get_similar_validity_pattern(ValidityPattern* vp) const;
@@ -64,82 +64,80 @@ void PT_Data::sort(){
 }
 
 
-void PT_Data::build_autocomplete(const navitia::georef::GeoRef & georef){
+void PT_Data::build_autocomplete(const navitia::georef::GeoRef & georef, size_t nb_threads){
+    typedef std::pair<std::string, idx_t> str_position;
+
     this->stop_area_autocomplete.clear();
-    for(const StopArea* sa : this->stop_areas){
+    this->stop_area_autocomplete.add_strings(this->stop_areas.size(), [&](size_t i) -> str_position {
+        const StopArea* sa = this->stop_areas[i];
         // A ne pas ajouter dans le disctionnaire si pas ne nom
-        if ((!sa->name.empty()) && (sa->visible)) {
-            std::string key="";
-            for( navitia::georef::Admin* admin : sa->admin_list){
-                if (admin->level ==8){key +=" " + admin->name;}
-            }
-            this->stop_area_autocomplete.add_string(sa->name + " " + key, sa->idx, georef.ghostwords, georef.synonyms);
+        if (sa->name.empty() || !sa->visible) { return {"", sa->idx}; }
+        std::string key="";
+        for( navitia::georef::Admin* admin : sa->admin_list){
+            if (admin->level ==8){key +=" " + admin->name;}
         }
-    }
+        return {sa->name + " " + key, sa->idx};
+    }, georef.ghostwords, georef.synonyms, nb_threads);
     this->stop_area_autocomplete.build();
 
     this->stop_point_autocomplete.clear();
-    for(const StopPoint* sp : this->stop_points){
+    this->stop_point_autocomplete.add_strings(this->stop_points.size(), [&](size_t i) -> str_position {
+        const StopPoint* sp = this->stop_points[i];
         // A ne pas ajouter dans le disctionnaire si pas ne nom
-        if ((!sp->name.empty()) && ((sp->stop_area == nullptr) || (sp->stop_area->visible))) {
-            std::string key="";
-            for(navitia::georef::Admin* admin : sp->admin_list){
-                if (admin->level == 8){key += key + " " + admin->name;}
-            }
-            this->stop_point_autocomplete.add_string(sp->name + " " + key, sp->idx, georef.ghostwords, georef.synonyms);
+        if (sp->name.empty() || ((sp->stop_area != nullptr) && !sp->stop_area->visible)) { return {"", sp->idx}; }
+        std::string key="";
+        for(navitia::georef::Admin* admin : sp->admin_list){
+            if (admin->level == 8){key += key + " " + admin->name;}
         }
-    }
+        return {sp->name + " " + key, sp->idx};
+    }, georef.ghostwords, georef.synonyms, nb_threads);
     this->stop_point_autocomplete.build();
 
     this->line_autocomplete.clear();
-    for(const Line* line : this->lines){
-        if (!line->name.empty()){
-            std::string key="";
-            if (line->network){key = line->network->name;}
-            if (line->commercial_mode) {key += " " + line->commercial_mode->name;}
-            key += " " + line->code;
-            this->line_autocomplete.add_string(key + " " + line->name, line->idx, georef.ghostwords, georef.synonyms);
-        }
-    }
+    this->line_autocomplete.add_strings(this->lines.size(), [&](size_t i) -> str_position {
+        const Line* line = this->lines[i];
+        if (line->name.empty()) { return {"", line->idx}; }
+        std::string key="";
+        if (line->network){key = line->network->name;}
+        if (line->commercial_mode) {key += " " + line->commercial_mode->name;}
+        key += " " + line->code;
+        return {key + " " + line->name, line->idx};
+    }, georef.ghostwords, georef.synonyms, nb_threads);
     this->line_autocomplete.build();
 
     this->network_autocomplete.clear();
-    for(const Network* network : this->networks){
-        if (!network->name.empty()){
-            this->network_autocomplete.add_string(network->name, network->idx, georef.ghostwords, georef.synonyms);
-        }
-    }
+    this->network_autocomplete.add_strings(this->networks.size(), [&](size_t i) -> str_position {
+        return {this->networks[i]->name, this->networks[i]->idx};
+    }, georef.ghostwords, georef.synonyms, nb_threads);
     this->network_autocomplete.build();
 
     this->mode_autocomplete.clear();
-    for(const CommercialMode* mode : this->commercial_modes){
-        if (!mode->name.empty()){
-            this->mode_autocomplete.add_string(mode->name, mode->idx, georef.ghostwords, georef.synonyms);
-        }
-    }
+    this->mode_autocomplete.add_strings(this->commercial_modes.size(), [&](size_t i) -> str_position {
+        return {this->commercial_modes[i]->name, this->commercial_modes[i]->idx};
+    }, georef.ghostwords, georef.synonyms, nb_threads);
     this->mode_autocomplete.build();
 
     this->route_autocomplete.clear();
-    for(const Route* route : this->routes){
-        if (!route->name.empty()){
-            std::string key="";
-            if (route->line){
-                if (route->line->network){key = route->line->network->name;}
-                if (route->line->commercial_mode) {key += " " + route->line->commercial_mode->name;}
-                key += " " + route->line->code;
-            }
-            this->route_autocomplete.add_string(key + " " + route->name, route->idx, georef.ghostwords, georef.synonyms);
+    this->route_autocomplete.add_strings(this->routes.size(), [&](size_t i) -> str_position {
+        const Route* route = this->routes[i];
+        if (route->name.empty()) { return {"", route->idx}; }
+        std::string key="";
+        if (route->line){
+            if (route->line->network){key = route->line->network->name;}
+            if (route->line->commercial_mode) {key += " " + route->line->commercial_mode->name;}
+            key += " " + route->line->code;
         }
-    }
+        return {key + " " + route->name, route->idx};
+    }, georef.ghostwords, georef.synonyms, nb_threads);
     this->route_autocomplete.build();
 }
 
 void PT_Data::compute_score_autocomplete(navitia::georef::GeoRef& georef){
     //Compute admin score using stop_point count in each admin
-    georef.fl_admin.compute_score((*this), georef, type::Type_e::Admin);
+    navitia::georef::mutable_part(georef.fl_admin).compute_score((*this), georef, type::Type_e::Admin);
     //use the score of each admin for it's objects like "POI", "way" and "stop_point"
-    georef.fl_way.compute_score((*this), georef, type::Type_e::Way);
-    georef.fl_poi.compute_score((*this), georef, type::Type_e::POI);
+    navitia::georef::mutable_part(georef.fl_way).compute_score((*this), georef, type::Type_e::Way);
+    navitia::georef::mutable_part(georef.fl_poi).compute_score((*this), georef, type::Type_e::POI);
     this->stop_point_autocomplete.compute_score((*this), georef, type::Type_e::StopPoint);
     //Compute stop_area score using it's stop_point count
     this->stop_area_autocomplete.compute_score((*this), georef, type::Type_e::StopArea);
@@ -126,8 +126,8 @@ struct PT_Data : boost::noncopyable{
     /** Construit l'indexe ExternelCode */
     void build_uri();
 
-    /** Construit l'indexe Autocomplete */
-    void build_autocomplete(const navitia::georef::GeoRef&);
+    /** Construit l'indexe Autocomplete, les chaînes étant découpées sur nb_threads threads */
+    void build_autocomplete(const navitia::georef::GeoRef&, size_t nb_threads = 1);
 
     /** Calcul le score des objectTC */
     void compute_score_autocomplete(navitia::georef::GeoRef&);
@@ -0,0 +1,75 @@
+/* Copyright © 2001-2016, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE thread_pool_test
+#include <boost/test/unit_test.hpp>
+
+#include "type/thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+using navitia::ThreadPool;
+
+// each job is run once, whatever the number of jobs, on several runs
+BOOST_AUTO_TEST_CASE(each_job_run_once) {
+    ThreadPool pool(4);
+    BOOST_CHECK_EQUAL(pool.nb_threads(), 4);
+    for (size_t nb_jobs = 0; nb_jobs < 20; ++nb_jobs) {
+        std::vector<int> nb_runs(nb_jobs, 0);
+        pool.run(nb_jobs, [&](size_t i) { ++nb_runs[i]; });
+        BOOST_CHECK(std::all_of(nb_runs.begin(), nb_runs.end(), [](int n) { return n == 1; }));
+    }
+}
+
+// a pool of one thread runs the jobs in order on the calling thread
+BOOST_AUTO_TEST_CASE(one_thread_is_sequential) {
+    ThreadPool pool(1);
+    BOOST_CHECK_EQUAL(pool.nb_threads(), 1);
+    const auto caller = std::this_thread::get_id();
+    std::vector<size_t> order;
+    pool.run(5, [&](size_t i) {
+        BOOST_CHECK(std::this_thread::get_id() == caller);
+        order.push_back(i);
+    });
+    const std::vector<size_t> expected = {0, 1, 2, 3, 4};
+    BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected.begin(), expected.end());
+}
+
+// the exception of a job is rethrown by run, and the pool is still usable
+BOOST_AUTO_TEST_CASE(exception_rethrown) {
+    ThreadPool pool(3);
+    BOOST_CHECK_THROW(pool.run(6, [](size_t i) { if (i == 4) { throw std::runtime_error("job 4"); } }),
+                      std::runtime_error);
+    size_t sum = 0;
+    std::mutex mutex;
+    pool.run(6, [&](size_t i) { std::lock_guard<std::mutex> lock(mutex); sum += i; });
+    BOOST_CHECK_EQUAL(sum, 15);
+}
@@ -0,0 +1,154 @@
+/* Copyright © 2001-2016, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace navitia {
+
+/** Threads kept alive to run the parallel parts of the requests.
+ *
+ * A pool is owned by a worker and its threads wait between the
+ * requests: a request hands them jobs with run() instead of starting
+ * threads.  The thread calling run() takes jobs too, thus a pool of
+ * nb_threads has nb_threads - 1 threads of its own, and a pool of 1
+ * runs the jobs sequentially.
+ *
+ * run() must not be called concurrently on the same pool.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(const size_t nb_threads) {
+        for (size_t i = 1; i < nb_threads; ++i) {
+            threads.emplace_back([this]() { this->wait_and_work(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        job_available.notify_all();
+        for (auto& thread: threads) { thread.join(); }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// number of threads running the jobs, the calling one included
+    size_t nb_threads() const { return threads.size() + 1; }
+
+    /// Run job(i) for each i in [0, nb_jobs) on the threads of the pool
+    /// and the calling one, and wait for them.  If jobs throw, the
+    /// exception of the first one is rethrown.
+    void run(const size_t nb_jobs, const std::function<void(size_t)>& job) {
+        if (threads.empty() || nb_jobs <= 1) {
+            for (size_t i = 0; i < nb_jobs; ++i) { job(i); }
+            return;
+        }
+        std::vector<std::exception_ptr> errors(nb_jobs);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current_job = &job;
+            current_errors = &errors;
+            current_nb_jobs = nb_jobs;
+            next_job = 0;
+            nb_working = threads.size();
+            ++generation;
+        }
+        job_available.notify_all();
+        work();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            all_done.wait(lock, [&]() { return nb_working == 0; });
+            current_job = nullptr;
+            current_errors = nullptr;
+        }
+        for (const auto& error: errors) {
+            if (error) { std::rethrow_exception(error); }
+        }
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable job_available;
+    std::condition_variable all_done;
+    bool stopped = false;
+    // the jobs of the current run, protected by the mutex
+    const std::function<void(size_t)>* current_job = nullptr;
+    std::vector<std::exception_ptr>* current_errors = nullptr;
+    size_t current_nb_jobs = 0;
+    size_t next_job = 0;
+    size_t nb_working = 0;
+    size_t generation = 0;
+
+    // take the jobs of the current run until there are none left
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (next_job < current_nb_jobs) {
+            const size_t i = next_job++;
+            lock.unlock();
+            try {
+                (*current_job)(i);
+            } catch (...) {
+                (*current_errors)[i] = std::current_exception();
+            }
+            lock.lock();
+        }
+    }
+
+    void wait_and_work() {
+        size_t seen_generation = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                job_available.wait(lock, [&]() { return stopped || generation != seen_generation; });
+                if (stopped) { return; }
+                seen_generation = generation;
+            }
+            work();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --nb_working;
+            }
+            all_done.notify_one();
+        }
+    }
+};
+
+} // namespace navitia
@@ -32,6 +32,7 @@ www.navitia.io
 #include <iostream>
 #include "utils/idx_map.h"
 #include <boost/container/flat_set.hpp>
+#include <boost/dynamic_bitset.hpp>
 
 namespace navitia {
 namespace type {
@@ -133,6 +134,30 @@ inline Indexes make_indexes(std::initializer_list<idx_t> l) {
     return indexes;
 }
 
+// Dense set of the indexes of one type: the bit i is set when the object
+// i is in the set.  Much cheaper than Indexes to fill from a lot of
+// unsorted indexes, to intersect and to subtract.
+using IndexesBitset = boost::dynamic_bitset<>;
+
+// The indexes not lower than size are ignored
+inline IndexesBitset make_bitset(const Indexes& indexes, size_t size) {
+    IndexesBitset bitset(size);
+    for (const auto& idx: indexes) {
+        if (idx < size) { bitset.set(idx); }
+    }
+    return bitset;
+}
+
+inline Indexes make_indexes(const IndexesBitset& bitset) {
+    Indexes indexes;
+    indexes.reserve(bitset.count());
+    for (auto idx = bitset.find_first(); idx != IndexesBitset::npos; idx = bitset.find_next(idx)) {
+        // the indexes come sorted, the hint makes each insertion constant
+        indexes.insert(indexes.end(), idx);
+    }
+    return indexes;
+}
+
 struct Header {
     idx_t idx = invalid_idx; // Index of the object in the main structure
     std::string uri; // unique indentifier of the object